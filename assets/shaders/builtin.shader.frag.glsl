@@ -1,8 +1,16 @@
 #version 450
 
 layout(location = 0) out vec4 out_color;
-layout(location = 0) in vec3 frag_color;
+layout(location = 0) in vec2 frag_uv;
+layout(location = 1) flat in float frag_min_lod;
+// From the draw constants or, for instanced draws, from the instance.
+layout(location = 2) flat in uint frag_material;
+
+layout(set = 0, binding = 1) uniform sampler2DArray block_textures;
 
 void main() {
-    out_color = vec4(frag_color.r + 0.5, frag_color.g + 0.2, frag_color.b + 0.1, 1.0);
+    // Levels finer than the resident one are still streaming in, never sample them.
+    vec3 coords = vec3(frag_uv, float(frag_material));
+    float lod = max(textureQueryLod(block_textures, frag_uv).x, frag_min_lod);
+    out_color = textureLod(block_textures, coords, lod);
 }
\ No newline at end of file
@@ -1,14 +1,26 @@
 #version 450
 
 layout(location = 0) in vec3 in_pos;
-layout(location = 0) out vec3 frag_color;
+layout(location = 1) in vec2 in_uv;
+layout(location = 0) out vec2 frag_uv;
+layout(location = 1) flat out float frag_min_lod;
+layout(location = 2) flat out uint frag_material;
 
 layout(set = 0, binding = 0) uniform Globals{
     mat4 proj;
     mat4 view;
+    vec4 textures;
 } globals;
 
+layout(push_constant) uniform DrawConstants{
+    vec4 origin;
+    uint lod;
+    uint material;
+} draw;
+
 void main() {
-    gl_Position = globals.proj * globals.view * vec4(in_pos, 1.0);
-    frag_color = vec3(in_pos.x, in_pos.y, 0.9);
+    gl_Position = globals.proj * globals.view * vec4(in_pos + draw.origin.xyz, 1.0);
+    frag_uv = in_uv;
+    frag_min_lod = globals.textures.x;
+    frag_material = draw.material;
 }
\ No newline at end of file
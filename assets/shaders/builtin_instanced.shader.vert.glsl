@@ -0,0 +1,28 @@
+#version 450
+
+layout(location = 0) in vec3 in_pos;
+layout(location = 1) in vec2 in_uv;
+// Per-instance, see InstanceData.
+layout(location = 2) in vec4 in_position_scale;
+layout(location = 3) in float in_yaw;
+layout(location = 4) in uint in_material;
+layout(location = 0) out vec2 frag_uv;
+layout(location = 1) flat out float frag_min_lod;
+layout(location = 2) flat out uint frag_material;
+
+layout(set = 0, binding = 0) uniform Globals{
+    mat4 proj;
+    mat4 view;
+    vec4 textures;
+} globals;
+
+void main() {
+    float c = cos(in_yaw);
+    float s = sin(in_yaw);
+    vec3 local = in_pos * in_position_scale.w;
+    vec3 world = vec3(c * local.x + s * local.z, local.y, -s * local.x + c * local.z);
+    gl_Position = globals.proj * globals.view * vec4(world + in_position_scale.xyz, 1.0);
+    frag_uv = in_uv;
+    frag_min_lod = globals.textures.x;
+    frag_material = in_material;
+}
@@ -0,0 +1,106 @@
+#version 450
+
+// Two-phase occlusion culling of chunk bounding boxes against the Hi-Z pyramid.
+layout(local_size_x = 64) in;
+
+struct ChunkDraw {
+    vec4 bounds_min;
+    vec4 bounds_max;
+    uint index_count;
+    uint first_index;
+    int vertex_offset;
+    uint pad_0;
+};
+
+struct DrawCommand {
+    uint index_count;
+    uint instance_count;
+    uint first_index;
+    int vertex_offset;
+    uint first_instance;
+};
+
+layout(set = 0, binding = 0) uniform sampler2D pyramid;
+layout(set = 0, binding = 1) readonly buffer Chunks{
+    ChunkDraw chunks[];
+};
+layout(set = 0, binding = 2) writeonly buffer Commands{
+    DrawCommand commands[];
+};
+layout(set = 0, binding = 3) buffer Visibility{
+    uint visibility[];
+};
+
+layout(push_constant) uniform CullConstants{
+    mat4 view_proj;
+    vec2 pyramid_size;
+    uint chunk_count;
+    uint phase;
+} cull;
+
+const uint PHASE_EARLY = 0u;
+
+bool is_visible(vec3 bounds_min, vec3 bounds_max) {
+    vec2 uv_min = vec2(1.0);
+    vec2 uv_max = vec2(0.0);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = vec3((i & 1) != 0 ? bounds_max.x : bounds_min.x,
+                           (i & 2) != 0 ? bounds_max.y : bounds_min.y,
+                           (i & 4) != 0 ? bounds_max.z : bounds_min.z);
+        vec4 clip = cull.view_proj * vec4(corner, 1.0);
+        // Crosses the near plane, we can't reason about it in screen space.
+        if (clip.w <= 0.0) {
+            return true;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        // The viewport is flipped, so NDC +y is the top row of the depth buffer.
+        vec2 uv = vec2(ndc.x * 0.5 + 0.5, 0.5 - ndc.y * 0.5);
+        uv_min = min(uv_min, uv);
+        uv_max = max(uv_max, uv);
+        nearest = min(nearest, ndc.z);
+    }
+
+    // Frustum test
+    if (any(lessThan(uv_max, vec2(0.0))) || any(greaterThan(uv_min, vec2(1.0))) || nearest > 1.0) {
+        return false;
+    }
+    uv_min = clamp(uv_min, vec2(0.0), vec2(1.0));
+    uv_max = clamp(uv_max, vec2(0.0), vec2(1.0));
+
+    // Pick the level where the box covers at most 2x2 texels.
+    vec2 extent = (uv_max - uv_min) * cull.pyramid_size;
+    float level = ceil(log2(max(max(extent.x, extent.y), 1.0)));
+
+    float farthest = max(max(textureLod(pyramid, uv_min, level).r,
+                             textureLod(pyramid, vec2(uv_max.x, uv_min.y), level).r),
+                         max(textureLod(pyramid, vec2(uv_min.x, uv_max.y), level).r,
+                             textureLod(pyramid, uv_max, level).r));
+    return nearest <= farthest;
+}
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= cull.chunk_count) {
+        return;
+    }
+    ChunkDraw chunk = chunks[index];
+    bool visible_last_frame = visibility[index] != 0u;
+
+    uint instance_count;
+    if (cull.phase == PHASE_EARLY) {
+        instance_count = visible_last_frame ? 1u : 0u;
+    } else {
+        bool visible = is_visible(chunk.bounds_min.xyz, chunk.bounds_max.xyz);
+        // Whatever was drawn in the early phase is already in the depth buffer.
+        instance_count = (visible && !visible_last_frame) ? 1u : 0u;
+        visibility[index] = visible ? 1u : 0u;
+    }
+
+    commands[index].index_count = chunk.index_count;
+    commands[index].instance_count = instance_count;
+    commands[index].first_index = chunk.first_index;
+    commands[index].vertex_offset = chunk.vertex_offset;
+    // Nonzero values need the drawIndirectFirstInstance feature, and nothing reads the instance.
+    commands[index].first_instance = 0u;
+}
\ No newline at end of file
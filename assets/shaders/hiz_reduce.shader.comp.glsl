@@ -0,0 +1,31 @@
+#version 450
+
+// Builds one level of the Hi-Z pyramid by keeping the farthest depth of each footprint.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 0, binding = 0) uniform sampler2D src_level;
+layout(set = 0, binding = 1, r32f) uniform writeonly image2D dst_level;
+
+layout(push_constant) uniform ReduceConstants{
+    ivec2 src_size;
+    ivec2 dst_size;
+} reduce;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(texel, reduce.dst_size))) {
+        return;
+    }
+    // Footprint of this texel in the source level, rounded outwards so odd sizes and the
+    // non power of two depth buffer never lose their last row or column.
+    ivec2 begin = texel * reduce.src_size / reduce.dst_size;
+    ivec2 end = min(((texel + 1) * reduce.src_size + reduce.dst_size - 1) / reduce.dst_size,
+                    reduce.src_size);
+    float depth = 0.0;
+    for (int y = begin.y; y < end.y; y++) {
+        for (int x = begin.x; x < end.x; x++) {
+            depth = max(depth, texelFetch(src_level, ivec2(x, y), 0).r);
+        }
+    }
+    imageStore(dst_level, texel, vec4(depth));
+}
\ No newline at end of file
@@ -1,12 +1,22 @@
 #include "app.h"
+#include "core/arena.h"
 #include "core/event.h"
+#include "core/frame_limiter.h"
 #include "core/input.h"
+#include "core/job.h"
 #include "core/log.h"
+#include "core/mem.h"
+#include "core/profiler.h"
 #include "renderer/renderer.h"
 #include "window.h"
 
 typedef struct App {
     Window* window;
+    FrameLimiter limiter;
+    bool just_in_time;
+    u32 mem_report_interval;
+    u32 profile_frames;
+    u64 frame;
 } App;
 
 App app = {0};
@@ -17,6 +27,9 @@ static void application_on_resized(EventCode code, EventMessage message);
 
 bool application_initialize(AppConfig* config) {
     logger_create();
+    logger_set_binary(config->binary_log);
+    // Before the job system, so workers register their names.
+    profiler_create();
     INFO("Initializing...");
     Window* window =
         create_window(config->initial_window_width, config->initial_window_height, config->title);
@@ -31,11 +44,25 @@ bool application_initialize(AppConfig* config) {
     event_manager_register(EVENT_CODE_KEY_RELEASE, key_press_callback);
     event_manager_register(EVENT_CODE_WINDOW_RESIZE, application_on_resized);
     input_manager_create();
+    if (!job_system_create(0)) {
+        ERROR("Failed to create the job system.");
+        return false;
+    }
+    if (!frame_memory_create(FRAME_ARENA_DEFAULT_RESERVE)) {
+        ERROR("Failed to create frame memory.");
+        return false;
+    }
 
     if (!renderer_create(config->title, app.window)) {
         ERROR("Failed to create renderer.");
         return false;
     }
+    renderer_set_present_mode(config->present_mode);
+    renderer_set_gpu_budget(config->gpu_budget_ms);
+    frame_limiter_create(config->max_fps, &app.limiter);
+    app.just_in_time = config->just_in_time;
+    app.mem_report_interval = config->mem_report_interval;
+    app.profile_frames = config->profile_frames;
     return true;
 }
 
@@ -43,13 +70,33 @@ bool application_run(void) {
     INFO("Game running...");
     f32 dt = 0.0f;
     while (!window_should_close(app.window)) {
-        window_poll_events();
-        renderer_render(dt);
+        profiler_frame_mark();
+        // Transient allocations of the frame before last are released here.
+        frame_memory_begin();
+        if (app.just_in_time) {
+            // Every wait happens before input is sampled, so the frame is built from the
+            // freshest input and goes straight to the GPU.
+            dt = (f32)frame_limiter_wait(&app.limiter);
+            renderer_wait_for_frame();
+            window_poll_events();
+            renderer_render(dt);
+        } else {
+            window_poll_events();
+            renderer_render(dt);
+            dt = (f32)frame_limiter_wait(&app.limiter);
+        }
+        app.frame++;
+        if (app.mem_report_interval > 0 && app.frame % app.mem_report_interval == 0) {
+            mem_report();
+        }
     }
     event_manager_destroy();
     input_manager_destroy();
     renderer_destroy();
     window_destroy(app.window);
+    frame_memory_destroy();
+    job_system_destroy();
+    profiler_destroy();
     logger_destroy();
     return true;
 }
@@ -68,4 +115,10 @@ static void window_close_callback(EventCode code, EventMessage message) {
 static void key_press_callback(EventCode code, EventMessage message) {
     u32 key = message.data.u32[0];
     DEBUG("[%c] pressed.", key);
+    if (code == EVENT_CODE_KEY_PRESS && key == INPUT_KEY_F1) {
+        mem_report();
+    }
+    if (code == EVENT_CODE_KEY_PRESS && key == INPUT_KEY_F2) {
+        profiler_export("profile.json", app.profile_frames);
+    }
 }
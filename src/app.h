@@ -1,8 +1,22 @@
+#include "renderer/renderer_backend.h"
 #include <types.h>
 typedef struct AppConfig {
     const char* title;
     u32 initial_window_width;
     u32 initial_window_height;
+    PresentMode present_mode;
+    // Frame rate cap, 0 for uncapped.
+    f32 max_fps;
+    // Sleep and wait for the GPU first, then sample input right before rendering.
+    bool just_in_time;
+    // GPU frame time the scene resolution is scaled to hold, 0 for full resolution.
+    f32 gpu_budget_ms;
+    // Frames between memory usage reports, 0 to only report on demand (F1).
+    u32 mem_report_interval;
+    // Writes INFO and below to latest.binlog unformatted; read it with the log_decode tool.
+    bool binary_log;
+    // Frames F2 writes to profile.json, for Perfetto or chrome://tracing.
+    u32 profile_frames;
 } AppConfig;
 
 bool application_initialize(AppConfig* config);
@@ -0,0 +1,301 @@
+#include "hashmap.h"
+#include "core/log.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+#define HASHMAP_MIN_CAPACITY HASHMAP_GROUP_WIDTH
+#define NOT_FOUND ((u64)-1)
+
+// One bit per control byte of a group, lowest bit first.
+typedef u32 GroupMask;
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Largest power of two dividing `size`, capped at 16; the strictest alignment a type of that
+// size can need.
+static u32 size_alignment(u32 size) {
+    u32 alignment = size & (~size + 1);
+    return alignment == 0 || alignment > 16 ? 16 : alignment;
+}
+
+static u64 max_load(u64 capacity) {
+    return capacity / 8 * HASHMAP_MAX_LOAD_EIGHTHS;
+}
+
+static u64 mix(u64 value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+u64 hash_bytes(const void* key, u64 key_size) {
+    const u8* bytes = key;
+    if (key_size == 8) {
+        u64 value;
+        memcpy(&value, bytes, 8);
+        return mix(value);
+    }
+    if (key_size == 4) {
+        u32 value;
+        memcpy(&value, bytes, 4);
+        return mix(value);
+    }
+    u64 hash = key_size * 0x9E3779B97F4A7C15ull;
+    while (key_size >= 8) {
+        u64 value;
+        memcpy(&value, bytes, 8);
+        hash = (hash ^ mix(value)) * 0x9E3779B97F4A7C15ull;
+        bytes += 8;
+        key_size -= 8;
+    }
+    u64 tail = 0;
+    memcpy(&tail, bytes, key_size);
+    return mix(hash ^ tail);
+}
+
+static GroupMask group_match(const u8* group, u8 value) {
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128((const __m128i*)group);
+    return (GroupMask)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)value)));
+#else
+    GroupMask mask = 0;
+    for (u32 i = 0; i < HASHMAP_GROUP_WIDTH; i++) {
+        mask |= (GroupMask)(group[i] == value) << i;
+    }
+    return mask;
+#endif
+}
+
+// Empty and deleted slots, the only control bytes with the top bit set.
+static GroupMask group_match_free(const u8* group) {
+#if defined(__SSE2__)
+    return (GroupMask)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+    GroupMask mask = 0;
+    for (u32 i = 0; i < HASHMAP_GROUP_WIDTH; i++) {
+        mask |= (GroupMask)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static u8* slot_key(const HashMap* map, u64 index) {
+    return map->slots + index * map->slot_size;
+}
+
+static u8* slot_value(const HashMap* map, u64 index) {
+    return map->slots + index * map->slot_size + map->value_offset;
+}
+
+static bool keys_equal(const HashMap* map, const u8* a, const void* b) {
+    // The common integer keys skip the call into memcmp.
+    if (map->key_size == 8) {
+        u64 x, y;
+        memcpy(&x, a, 8);
+        memcpy(&y, b, 8);
+        return x == y;
+    }
+    if (map->key_size == 4) {
+        u32 x, y;
+        memcpy(&x, a, 4);
+        memcpy(&y, b, 4);
+        return x == y;
+    }
+    return memcmp(a, b, map->key_size) == 0;
+}
+
+static void set_ctrl(HashMap* map, u64 index, u8 value) {
+    map->ctrl[index] = value;
+    // The first GROUP_WIDTH - 1 bytes are mirrored after the end of the table.
+    map->ctrl[((index - (HASHMAP_GROUP_WIDTH - 1)) & (map->capacity - 1)) +
+              (HASHMAP_GROUP_WIDTH - 1)] = value;
+}
+
+// Groups are probed triangularly, which visits every group of a power of two table once.
+static u64 find(const HashMap* map, const void* key, u64 hash) {
+    u64 mask = map->capacity - 1;
+    u64 position = (hash >> 7) & mask;
+    u8 tag = hash & 0x7F;
+    for (u64 step = HASHMAP_GROUP_WIDTH;; step += HASHMAP_GROUP_WIDTH) {
+        const u8* group = map->ctrl + position;
+        for (GroupMask match = group_match(group, tag); match; match &= match - 1) {
+            u64 index = (position + (u64)__builtin_ctz(match)) & mask;
+            if (keys_equal(map, slot_key(map, index), key)) {
+                return index;
+            }
+        }
+        // Inserts fill the first free slot of the sequence, so an empty one ends the search.
+        if (group_match(group, CTRL_EMPTY)) {
+            return NOT_FOUND;
+        }
+        position = (position + step) & mask;
+    }
+}
+
+static u64 find_free(const HashMap* map, u64 hash) {
+    u64 mask = map->capacity - 1;
+    u64 position = (hash >> 7) & mask;
+    for (u64 step = HASHMAP_GROUP_WIDTH;; step += HASHMAP_GROUP_WIDTH) {
+        GroupMask free = group_match_free(map->ctrl + position);
+        if (free) {
+            return (position + (u64)__builtin_ctz(free)) & mask;
+        }
+        position = (position + step) & mask;
+    }
+}
+
+static bool allocate(HashMap* map, u64 capacity) {
+    u64 slots_size = align_up(capacity * map->slot_size, 16);
+    u8* block = allocator_alloc(&map->allocator, slots_size + capacity + HASHMAP_GROUP_WIDTH - 1,
+                                MEM_TAG_HASHMAP);
+    if (!block) {
+        ERROR("Failed to allocate a hash map with %llu slots", capacity);
+        return false;
+    }
+    map->slots = block;
+    map->ctrl = block + slots_size;
+    map->capacity = capacity;
+    memset(map->ctrl, CTRL_EMPTY, capacity + HASHMAP_GROUP_WIDTH - 1);
+    return true;
+}
+
+// Moves every entry into a table of `capacity` slots, which also drops the tombstones.
+static bool rebuild(HashMap* map, u64 capacity) {
+    HashMap old = *map;
+    if (!allocate(map, capacity)) {
+        *map = old;
+        return false;
+    }
+    for (u64 i = 0; i < old.capacity; i++) {
+        if (old.ctrl[i] & 0x80) {
+            continue;
+        }
+        u64 hash = map->hash(slot_key(&old, i), map->key_size);
+        u64 index = find_free(map, hash);
+        set_ctrl(map, index, hash & 0x7F);
+        memcpy(slot_key(map, index), slot_key(&old, i), map->slot_size);
+    }
+    map->growth_left = max_load(capacity) - map->length;
+    allocator_free(&map->allocator, old.slots);
+    return true;
+}
+
+bool hashmap_create(u32 key_size, u32 value_size, u64 capacity, HashFn hash,
+                    const Allocator* allocator, HashMap* map) {
+    if (key_size == 0) {
+        ERROR("Hash map keys can't be empty.");
+        return false;
+    }
+    memset(map, 0, sizeof(HashMap));
+    u32 key_alignment = size_alignment(key_size);
+    u32 value_alignment = value_size ? size_alignment(value_size) : 1;
+    u32 slot_alignment = key_alignment > value_alignment ? key_alignment : value_alignment;
+    map->key_size = key_size;
+    map->value_size = value_size;
+    map->value_offset = (u32)align_up(key_size, value_alignment);
+    map->slot_size = (u32)align_up(map->value_offset + value_size, slot_alignment);
+    map->hash = hash ? hash : hash_bytes;
+    if (allocator) {
+        map->allocator = *allocator;
+    }
+
+    u64 slot_count = HASHMAP_MIN_CAPACITY;
+    while (max_load(slot_count) < capacity) {
+        slot_count *= 2;
+    }
+    if (!allocate(map, slot_count)) {
+        return false;
+    }
+    map->growth_left = max_load(slot_count);
+    return true;
+}
+
+void hashmap_destroy(HashMap* map) {
+    if (map->slots) {
+        allocator_free(&map->allocator, map->slots);
+    }
+    memset(map, 0, sizeof(HashMap));
+}
+
+void* hashmap_get(const HashMap* map, const void* key) {
+    u64 index = find(map, key, map->hash(key, map->key_size));
+    return index == NOT_FOUND ? 0 : slot_value(map, index);
+}
+
+void* hashmap_insert(HashMap* map, const void* key, const void* value) {
+    u64 hash = map->hash(key, map->key_size);
+    u64 index = find(map, key, hash);
+    if (index == NOT_FOUND) {
+        index = find_free(map, hash);
+        // Reusing a tombstone doesn't change the load, only filling an empty slot does.
+        if (map->growth_left == 0 && map->ctrl[index] == CTRL_EMPTY) {
+            // A table filled up mostly by tombstones is cleaned at the same size.
+            u64 capacity = map->length < max_load(map->capacity) / 2 ? map->capacity
+                                                                     : map->capacity * 2;
+            if (!rebuild(map, capacity)) {
+                return 0;
+            }
+            index = find_free(map, hash);
+        }
+        if (map->ctrl[index] == CTRL_EMPTY) {
+            map->growth_left--;
+        }
+        set_ctrl(map, index, hash & 0x7F);
+        memcpy(slot_key(map, index), key, map->key_size);
+        if (!value) {
+            memset(slot_value(map, index), 0, map->value_size);
+        }
+        map->length++;
+    }
+    if (value) {
+        memcpy(slot_value(map, index), value, map->value_size);
+    }
+    return slot_value(map, index);
+}
+
+bool hashmap_remove(HashMap* map, const void* key, void* value) {
+    u64 index = find(map, key, map->hash(key, map->key_size));
+    if (index == NOT_FOUND) {
+        return false;
+    }
+    if (value) {
+        memcpy(value, slot_value(map, index), map->value_size);
+    }
+    // Lookups for other keys may have probed past this slot, so it can't become empty.
+    set_ctrl(map, index, CTRL_DELETED);
+    map->length--;
+    return true;
+}
+
+void hashmap_clear(HashMap* map) {
+    memset(map->ctrl, CTRL_EMPTY, map->capacity + HASHMAP_GROUP_WIDTH - 1);
+    map->length = 0;
+    map->growth_left = max_load(map->capacity);
+}
+
+bool hashmap_next(const HashMap* map, u64* cursor, void** key, void** value) {
+    for (u64 i = *cursor; i < map->capacity; i++) {
+        if (!(map->ctrl[i] & 0x80)) {
+            *cursor = i + 1;
+            if (key) {
+                *key = slot_key(map, i);
+            }
+            if (value) {
+                *value = slot_value(map, i);
+            }
+            return true;
+        }
+    }
+    *cursor = map->capacity;
+    return false;
+}
@@ -0,0 +1,79 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include "core/mem.h"
+#include "types.h"
+
+// Control bytes probed at once. Matches the width of an SSE2 register.
+#define HASHMAP_GROUP_WIDTH 16
+// Maximum load before the table grows, as a fraction of 8.
+#define HASHMAP_MAX_LOAD_EIGHTHS 7
+
+typedef u64 (*HashFn)(const void* key, u64 key_size);
+
+/**
+ * Open addressing hash map with SwissTable-style metadata. Every slot has a control byte that
+ * is either empty, deleted, or holds 7 bits of the key's hash. Lookups compare a whole group
+ * of control bytes against those bits with a few SIMD instructions and only touch the slots
+ * that match, so misses rarely read a key at all.
+ *
+ * Keys and values are copied into the table and compared bytewise, so keys must not contain
+ * uninitialized padding. Pointers to values stay valid until the next insert or remove.
+ */
+typedef struct HashMap {
+    // capacity + HASHMAP_GROUP_WIDTH - 1 bytes; the tail mirrors the start so a group can be
+    // loaded at any slot without wrapping.
+    u8* ctrl;
+    u8* slots;
+    u64 capacity;
+    u64 length;
+    // Empty slots that can still be filled before the table has to grow.
+    u64 growth_left;
+    u32 key_size;
+    u32 value_size;
+    u32 value_offset;
+    u32 slot_size;
+    HashFn hash;
+    Allocator allocator;
+} HashMap;
+
+/**
+ * Creates a map with room for `capacity` entries without growing.
+ * @param hash Hash of the keys; 0 selects hash_bytes.
+ * @param allocator Where the table memory comes from; 0 selects the tagged heap.
+ */
+bool hashmap_create(u32 key_size, u32 value_size, u64 capacity, HashFn hash,
+                    const Allocator* allocator, HashMap* map);
+void hashmap_destroy(HashMap* map);
+
+#define hashmap_create_typed(key_type, value_type, capacity, map)                                  \
+    hashmap_create(sizeof(key_type), sizeof(value_type), capacity, 0, 0, map)
+
+// Returns a pointer to the value stored for `key`, or 0 when the key is missing.
+void* hashmap_get(const HashMap* map, const void* key);
+
+/**
+ * Stores a copy of `value` for `key`, replacing the previous value if the key is present.
+ * `value` may be 0 to leave a new value zeroed. Returns a pointer to the stored value, or 0
+ * when the table could not grow.
+ */
+void* hashmap_insert(HashMap* map, const void* key, const void* value);
+
+// Copies the value out into `value` when it is not 0. Returns false if the key was missing.
+bool hashmap_remove(HashMap* map, const void* key, void* value);
+
+// Removes every entry and keeps the memory.
+void hashmap_clear(HashMap* map);
+
+/**
+ * Steps through the entries in table order. Start with `*cursor` at 0; returns false once
+ * every entry was visited. The map must not be modified while iterating.
+ */
+bool hashmap_next(const HashMap* map, u64* cursor, void** key, void** value);
+
+#define hashmap_get_typed(map, type, key) ((type*)hashmap_get(map, key))
+
+// Default hash. Keys of 4 and 8 bytes take a single multiply-xorshift round.
+u64 hash_bytes(const void* key, u64 key_size);
+
+#endif
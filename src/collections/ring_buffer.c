@@ -0,0 +1,152 @@
+#include "ring_buffer.h"
+#include "core/log.h"
+#include "core/mem.h"
+#include <string.h>
+
+static u64 next_power_of_two(u64 value) {
+    u64 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+bool spsc_ring_create(u32 stride, u32 capacity, SpscRing* ring) {
+    if (stride == 0 || capacity == 0) {
+        ERROR("Ring buffers need a non-zero stride and capacity.");
+        return false;
+    }
+    memset(ring, 0, sizeof(SpscRing));
+    u64 slot_count = next_power_of_two(capacity);
+    ring->buffer = mem_alloc_tagged(slot_count * stride, MEM_TAG_RING);
+    if (!ring->buffer) {
+        ERROR("Failed to allocate a ring buffer with %llu slots", slot_count);
+        return false;
+    }
+    ring->mask = slot_count - 1;
+    ring->stride = stride;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return true;
+}
+
+void spsc_ring_destroy(SpscRing* ring) {
+    if (ring->buffer) {
+        mem_free(ring->buffer);
+    }
+    ring->buffer = 0;
+}
+
+bool spsc_ring_push(SpscRing* ring, const void* value) {
+    u64 tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - ring->cached_head > ring->mask) {
+        ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail - ring->cached_head > ring->mask) {
+            return false;
+        }
+    }
+    memcpy(ring->buffer + (tail & ring->mask) * ring->stride, value, ring->stride);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool spsc_ring_pop(SpscRing* ring, void* value) {
+    u64 head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    if (head == ring->cached_tail) {
+        ring->cached_tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == ring->cached_tail) {
+            return false;
+        }
+    }
+    memcpy(value, ring->buffer + (head & ring->mask) * ring->stride, ring->stride);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return true;
+}
+
+static _Atomic(u64)* cell_sequence(MpmcRing* ring, u64 position) {
+    return (_Atomic(u64)*)(ring->cells + (position & ring->mask) * ring->cell_size);
+}
+
+static u8* cell_data(MpmcRing* ring, u64 position) {
+    return ring->cells + (position & ring->mask) * ring->cell_size + sizeof(u64);
+}
+
+bool mpmc_ring_create(u32 stride, u32 capacity, MpmcRing* ring) {
+    if (stride == 0 || capacity == 0) {
+        ERROR("Ring buffers need a non-zero stride and capacity.");
+        return false;
+    }
+    memset(ring, 0, sizeof(MpmcRing));
+    u64 slot_count = next_power_of_two(capacity < 2 ? 2 : capacity);
+    // The sequence number sits in front of the value and keeps every cell 8-byte aligned.
+    ring->cell_size = (u32)((sizeof(u64) + stride + 7) & ~7ull);
+    ring->cells = mem_alloc_tagged(slot_count * ring->cell_size, MEM_TAG_RING);
+    if (!ring->cells) {
+        ERROR("Failed to allocate a ring buffer with %llu slots", slot_count);
+        return false;
+    }
+    ring->mask = slot_count - 1;
+    ring->stride = stride;
+    // A cell is writable for the lap whose position equals its sequence.
+    for (u64 i = 0; i < slot_count; i++) {
+        atomic_init(cell_sequence(ring, i), i);
+    }
+    atomic_init(&ring->enqueue_position, 0);
+    atomic_init(&ring->dequeue_position, 0);
+    return true;
+}
+
+void mpmc_ring_destroy(MpmcRing* ring) {
+    if (ring->cells) {
+        mem_free(ring->cells);
+    }
+    ring->cells = 0;
+}
+
+bool mpmc_ring_push(MpmcRing* ring, const void* value) {
+    u64 position = atomic_load_explicit(&ring->enqueue_position, memory_order_relaxed);
+    for (;;) {
+        u64 sequence = atomic_load_explicit(cell_sequence(ring, position), memory_order_acquire);
+        i64 difference = (i64)(sequence - position);
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_position, &position,
+                                                      position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The cell still holds the value from the previous lap.
+            return false;
+        } else {
+            position = atomic_load_explicit(&ring->enqueue_position, memory_order_relaxed);
+        }
+    }
+    memcpy(cell_data(ring, position), value, ring->stride);
+    atomic_store_explicit(cell_sequence(ring, position), position + 1, memory_order_release);
+    return true;
+}
+
+bool mpmc_ring_pop(MpmcRing* ring, void* value) {
+    u64 position = atomic_load_explicit(&ring->dequeue_position, memory_order_relaxed);
+    for (;;) {
+        u64 sequence = atomic_load_explicit(cell_sequence(ring, position), memory_order_acquire);
+        i64 difference = (i64)(sequence - (position + 1));
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->dequeue_position, &position,
+                                                      position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // Nothing has been written to the cell for this lap yet.
+            return false;
+        } else {
+            position = atomic_load_explicit(&ring->dequeue_position, memory_order_relaxed);
+        }
+    }
+    memcpy(value, cell_data(ring, position), ring->stride);
+    // Frees the cell for the producer of the next lap.
+    atomic_store_explicit(cell_sequence(ring, position), position + ring->mask + 1,
+                          memory_order_release);
+    return true;
+}
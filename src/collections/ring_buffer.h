@@ -0,0 +1,60 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "defines.h"
+#include "types.h"
+#include <stdatomic.h>
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer thread. Each side
+ * keeps a cached copy of the other side's index and only reloads it when the ring looks full
+ * or empty, so in steady state neither side reads the other's cache line.
+ */
+typedef struct SpscRing {
+    // Written by the producer.
+    _Alignas(CACHE_LINE_SIZE) _Atomic(u64) tail;
+    u64 cached_head;
+    // Written by the consumer.
+    _Alignas(CACHE_LINE_SIZE) _Atomic(u64) head;
+    u64 cached_tail;
+    // Read-only after creation.
+    _Alignas(CACHE_LINE_SIZE) u8* buffer;
+    u64 mask;
+    u32 stride;
+} SpscRing;
+
+/**
+ * Bounded lock-free queue for any number of producers and consumers. Every cell carries a
+ * sequence number that tells whether it is ready to be written or read for a given lap of
+ * the ring, so producers and consumers only contend on their own index.
+ */
+typedef struct MpmcRing {
+    _Alignas(CACHE_LINE_SIZE) _Atomic(u64) enqueue_position;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(u64) dequeue_position;
+    _Alignas(CACHE_LINE_SIZE) u8* cells;
+    u64 mask;
+    u32 stride;
+    u32 cell_size;
+} MpmcRing;
+
+// `capacity` is rounded up to a power of two.
+bool spsc_ring_create(u32 stride, u32 capacity, SpscRing* ring);
+void spsc_ring_destroy(SpscRing* ring);
+// Returns false when the ring is full. Producer thread only.
+bool spsc_ring_push(SpscRing* ring, const void* value);
+// Returns false when the ring is empty. Consumer thread only.
+bool spsc_ring_pop(SpscRing* ring, void* value);
+
+#define spsc_ring_create_typed(type, capacity, ring) spsc_ring_create(sizeof(type), capacity, ring)
+
+// `capacity` is rounded up to a power of two, at least 2.
+bool mpmc_ring_create(u32 stride, u32 capacity, MpmcRing* ring);
+void mpmc_ring_destroy(MpmcRing* ring);
+// Returns false when the ring is full.
+bool mpmc_ring_push(MpmcRing* ring, const void* value);
+// Returns false when the ring is empty.
+bool mpmc_ring_pop(MpmcRing* ring, void* value);
+
+#define mpmc_ring_create_typed(type, capacity, ring) mpmc_ring_create(sizeof(type), capacity, ring)
+
+#endif
@@ -0,0 +1,155 @@
+#include "slot_map.h"
+#include "core/log.h"
+#include <string.h>
+
+#define SLOT_MAP_NO_SLOT 0xFFFFFFFFu
+
+bool slot_map_create(u32 stride, u32 capacity, const Allocator* allocator, SlotMap* map) {
+    if (stride == 0) {
+        ERROR("Slot map values can't be empty.");
+        return false;
+    }
+    if (capacity == 0) {
+        capacity = VECTOR_DEFAULT_CAPACITY;
+    }
+    memset(map, 0, sizeof(SlotMap));
+    map->values = _vector_new_with(capacity, stride, allocator);
+    map->dense_slots = _vector_new_with(capacity, sizeof(u32), allocator);
+    map->slots = _vector_new_with(capacity, sizeof(SlotMapSlot), allocator);
+    if (!map->values || !map->dense_slots || !map->slots) {
+        ERROR("Failed to allocate a slot map");
+        slot_map_destroy(map);
+        return false;
+    }
+    map->stride = stride;
+    map->free_head = SLOT_MAP_NO_SLOT;
+    return true;
+}
+
+void slot_map_destroy(SlotMap* map) {
+    if (map->values) {
+        vector_free(map->values);
+    }
+    if (map->dense_slots) {
+        vector_free(map->dense_slots);
+    }
+    if (map->slots) {
+        vector_free(map->slots);
+    }
+    map->free_head = SLOT_MAP_NO_SLOT;
+}
+
+// Grows `array` geometrically until it has room for `count` elements. Check the capacity after.
+static Vector(T) grow(Vector(T) array, u64 count) {
+    u64 capacity = vector_capacity(array);
+    if (count <= capacity) {
+        return array;
+    }
+    capacity *= VECTOR_RESIZE_FACTOR;
+    return _vector_reserve(array, capacity > count ? capacity : count);
+}
+
+Handle slot_map_insert(SlotMap* map, const void* value) {
+    Handle handle = {0};
+    u64 length = vector_length(map->values);
+    u64 slot_count = vector_length(map->slots);
+    // Every array gets its room first, so running out of memory leaves the map as it was.
+    map->values = grow(map->values, length + 1);
+    map->dense_slots = grow(map->dense_slots, length + 1);
+    if (map->free_head == SLOT_MAP_NO_SLOT) {
+        map->slots = grow(map->slots, slot_count + 1);
+    }
+    if (length >= vector_capacity(map->values) || length >= vector_capacity(map->dense_slots) ||
+        (map->free_head == SLOT_MAP_NO_SLOT && slot_count >= vector_capacity(map->slots))) {
+        ERROR("Slot map could not grow past %llu values.", length);
+        return handle;
+    }
+    u8* destination = (u8*)map->values + length * map->stride;
+    if (value) {
+        memcpy(destination, value, map->stride);
+    } else {
+        memset(destination, 0, map->stride);
+    }
+    vector_length_set(map->values, length + 1);
+
+    u32 index = map->free_head;
+    if (index != SLOT_MAP_NO_SLOT) {
+        map->free_head = map->slots[index].dense_index;
+    } else {
+        index = (u32)slot_count;
+        SlotMapSlot slot = {0};
+        vector_push(map->slots, slot);
+    }
+    SlotMapSlot* slot = &map->slots[index];
+    slot->dense_index = (u32)length;
+    slot->generation++;
+    vector_push(map->dense_slots, index);
+
+    handle.index = index;
+    handle.generation = slot->generation;
+    return handle;
+}
+
+bool slot_map_contains(const SlotMap* map, Handle handle) {
+    return handle.index < vector_length(map->slots) && (handle.generation & 1) &&
+           map->slots[handle.index].generation == handle.generation;
+}
+
+void* slot_map_get(const SlotMap* map, Handle handle) {
+    if (!slot_map_contains(map, handle)) {
+        return 0;
+    }
+    return (u8*)map->values + (u64)map->slots[handle.index].dense_index * map->stride;
+}
+
+bool slot_map_remove(SlotMap* map, Handle handle, void* value) {
+    if (!slot_map_contains(map, handle)) {
+        return false;
+    }
+    SlotMapSlot* slot = &map->slots[handle.index];
+    u32 dense_index = slot->dense_index;
+    u32 last = (u32)vector_length(map->values) - 1;
+    u8* removed = (u8*)map->values + (u64)dense_index * map->stride;
+    if (value) {
+        memcpy(value, removed, map->stride);
+    }
+    // The last value fills the hole, which keeps the dense array packed.
+    if (dense_index != last) {
+        memcpy(removed, (u8*)map->values + (u64)last * map->stride, map->stride);
+        u32 moved_slot = map->dense_slots[last];
+        map->dense_slots[dense_index] = moved_slot;
+        map->slots[moved_slot].dense_index = dense_index;
+    }
+    vector_length_set(map->values, last);
+    vector_length_set(map->dense_slots, last);
+
+    slot->generation++;
+    slot->dense_index = map->free_head;
+    map->free_head = handle.index;
+    return true;
+}
+
+void slot_map_clear(SlotMap* map) {
+    u32 length = (u32)vector_length(map->dense_slots);
+    for (u32 i = 0; i < length; i++) {
+        u32 index = map->dense_slots[i];
+        map->slots[index].generation++;
+        map->slots[index].dense_index = map->free_head;
+        map->free_head = index;
+    }
+    vector_clear(map->values);
+    vector_clear(map->dense_slots);
+}
+
+u32 slot_map_length(const SlotMap* map) {
+    return (u32)vector_length(map->values);
+}
+
+Handle slot_map_handle_at(const SlotMap* map, u32 dense_index) {
+    Handle handle = {0};
+    if (dense_index < vector_length(map->dense_slots)) {
+        handle.index = map->dense_slots[dense_index];
+        handle.generation = map->slots[handle.index].generation;
+    }
+    return handle;
+}
@@ -0,0 +1,70 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include "collections/vector.h"
+#include "core/mem.h"
+#include "types.h"
+
+/**
+ * Reference to a slot map entry. The generation of a slot changes every time its entry is
+ * removed, so a handle to a removed entry stops resolving instead of aliasing whatever
+ * reuses the slot. A zeroed handle never resolves.
+ */
+typedef struct Handle {
+    u32 index;
+    u32 generation;
+} Handle;
+
+typedef struct SlotMapSlot {
+    // Position of the value in the dense array, or the next free slot while unused.
+    u32 dense_index;
+    // Odd while the slot holds a value.
+    u32 generation;
+} SlotMapSlot;
+
+/**
+ * Values packed in a dense array with a level of indirection through slots, so hot loops
+ * walk contiguous memory while other code holds handles that survive the values moving.
+ * Removing moves the last value into the hole, so the order of `values` is not stable.
+ * Insert, remove and lookup are O(1).
+ */
+typedef struct SlotMap {
+    // `length` values of `stride` bytes, iterate these directly.
+    Vector(T) values;
+    // Slot of every dense value, to fix up its slot when it moves.
+    Vector(u32) dense_slots;
+    Vector(SlotMapSlot) slots;
+    u32 free_head;
+    u32 stride;
+} SlotMap;
+
+/**
+ * @param allocator Where the arrays come from; 0 selects the heap.
+ */
+bool slot_map_create(u32 stride, u32 capacity, const Allocator* allocator, SlotMap* map);
+void slot_map_destroy(SlotMap* map);
+
+#define slot_map_create_typed(type, capacity, map) slot_map_create(sizeof(type), capacity, 0, map)
+
+// Copies `value` into the map, or zeroes the new value when it is 0.
+Handle slot_map_insert(SlotMap* map, const void* value);
+
+// Returns the value of a live handle, valid until the next insert or remove, or 0.
+void* slot_map_get(const SlotMap* map, Handle handle);
+
+#define slot_map_get_typed(map, type, handle) ((type*)slot_map_get(map, handle))
+
+bool slot_map_contains(const SlotMap* map, Handle handle);
+
+// Copies the value out into `value` when it is not 0. Returns false for stale handles.
+bool slot_map_remove(SlotMap* map, Handle handle, void* value);
+
+// Removes every value. Handles issued before stop resolving.
+void slot_map_clear(SlotMap* map);
+
+u32 slot_map_length(const SlotMap* map);
+
+// Handle of the value at `dense_index` of `values`, for iteration.
+Handle slot_map_handle_at(const SlotMap* map, u32 dense_index);
+
+#endif
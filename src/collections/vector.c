@@ -1,6 +1,7 @@
 #include "vector.h"
 #include "core/log.h"
 #include "core/mem.h"
+#include "platform/platform.h"
 #include <core/log.h>
 #include <string.h>
 
@@ -8,54 +9,170 @@ typedef struct VectorHeader {
     u64 capacity;
     u64 length;
     u64 stride;
+    // Size of the reserved address range, 0 for vectors that allocate their storage.
+    u64 reserved;
+    // Zeroed for vectors on the tagged heap.
+    Allocator allocator;
+    u64 pad_0;
 } VectorHeader;
 
-Vector(T) _vector_new(u64 length, u64 stride) {
+_Static_assert(sizeof(VectorHeader) % 16 == 0, "Vector elements must stay 16-byte aligned");
+
+static VectorHeader* header_of(Vector(T) array) {
+    return (VectorHeader*)((u8*)array - sizeof(VectorHeader));
+}
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Commits the reserved range from its start up to room for `capacity` elements, clamped to
+// the reservation. Pages that are already committed are left as they are.
+static bool reserved_commit(VectorHeader* header, u64 capacity) {
+    u64 bytes = align_up(sizeof(VectorHeader) + capacity * header->stride, platform_page_size());
+    if (bytes > header->reserved) {
+        bytes = header->reserved;
+    }
+    if (!platform_memory_commit(header, bytes)) {
+        return false;
+    }
+    header->capacity = (bytes - sizeof(VectorHeader)) / header->stride;
+    return true;
+}
+
+// Moves the elements into a block with room for `capacity` of them. Reserved vectors commit
+// more pages instead. On failure the vector is returned unchanged.
+static Vector(T) reallocate(Vector(T) array, u64 capacity) {
+    VectorHeader* header = header_of(array);
+    if (header->reserved) {
+        if (!reserved_commit(header, capacity)) {
+            ERROR("Failed to commit memory for a vector");
+        }
+        return array;
+    }
+    Vector(T) vector = _vector_new_with(capacity, header->stride, &header->allocator);
+    if (!vector) {
+        return array;
+    }
+    u64 length = header->length < capacity ? header->length : capacity;
+    memcpy(vector, array, length * header->stride);
+    vector_length_set(vector, length);
+    allocator_free(&header->allocator, header);
+    return vector;
+}
+
+Vector(T) _vector_new(u64 length, u64 stride) { return _vector_new_with(length, stride, 0); }
+
+Vector(T) _vector_new_with(u64 length, u64 stride, const Allocator* allocator) {
     if (length == 0) {
         WARN("Attempted to allocate a vector with 0 length. This will do nothing.");
         return 0;
     }
+    Allocator heap = {0};
+    if (!allocator) {
+        allocator = &heap;
+    }
     u64 header_size = sizeof(VectorHeader);
     u64 array_size = length * stride;
-    VectorHeader* header = mem_alloc(header_size + array_size);
+    VectorHeader* header = allocator_alloc(allocator, header_size + array_size, MEM_TAG_VECTOR);
+    if (!header) {
+        ERROR("Failed to allocate %llu bytes for a vector", header_size + array_size);
+        return 0;
+    }
     header->length = 0;
     header->capacity = length;
     header->stride = stride;
+    header->reserved = 0;
+    header->allocator = *allocator;
     return (void*)((u8*)header + header_size);
 }
 
+Vector(T) _vector_new_reserved(u64 max_length, u64 stride) {
+    if (max_length == 0 || stride == 0) {
+        WARN("Attempted to reserve a vector with 0 length. This will do nothing.");
+        return 0;
+    }
+    u64 reserved = align_up(sizeof(VectorHeader) + max_length * stride, platform_page_size());
+    VectorHeader* header = platform_memory_reserve(reserved);
+    if (!header) {
+        ERROR("Failed to reserve %llu bytes for a vector", reserved);
+        return 0;
+    }
+    // The header lives in the first page, which has to be committed before it is written.
+    if (!platform_memory_commit(header, platform_page_size())) {
+        ERROR("Failed to commit memory for a vector");
+        platform_memory_release(header, reserved);
+        return 0;
+    }
+    header->reserved = reserved;
+    header->stride = stride;
+    header->length = 0;
+    header->allocator = (Allocator){0};
+    reserved_commit(header, 1);
+    return (void*)((u8*)header + sizeof(VectorHeader));
+}
+
 void _vector_free(Vector(T) array) {
     if (array) {
-        u64 header_size = sizeof(VectorHeader);
-        VectorHeader* header = (VectorHeader*)((u8*)array - header_size);
-        mem_free(header);
+        VectorHeader* header = header_of(array);
+        if (header->reserved) {
+            platform_memory_release(header, header->reserved);
+        } else {
+            allocator_free(&header->allocator, header);
+        }
     }
 }
 
 Vector(T) _vector_resize(Vector(T) array) {
-    u64 header_size = sizeof(VectorHeader);
-    VectorHeader* header = (VectorHeader*)((u8*)array - header_size);
+    VectorHeader* header = header_of(array);
     if (header->capacity == 0) {
         WARN("Attempted to resize vector with 0 capacity. This will do nothing.");
         return 0;
     }
-    Vector(T) vector = _vector_new((VECTOR_RESIZE_FACTOR * header->capacity), header->stride);
+    return reallocate(array, VECTOR_RESIZE_FACTOR * header->capacity);
+}
 
-    header = (VectorHeader*)((u8*)array - header_size);
-    memcpy(vector, array, header->length * header->stride);
+Vector(T) _vector_reserve(Vector(T) array, u64 capacity) {
+    if (capacity <= vector_capacity(array)) {
+        return array;
+    }
+    return reallocate(array, capacity);
+}
 
-    vector_length_set(vector, header->length);
-    vector_free(array);
-    return vector;
+Vector(T) _vector_shrink_to_fit(Vector(T) array) {
+    VectorHeader* header = header_of(array);
+    u64 capacity = header->length > 0 ? header->length : 1;
+    if (capacity >= header->capacity) {
+        return array;
+    }
+    if (header->reserved) {
+        // Hands the pages past the last element back to the system; the range stays reserved.
+        u64 page_size = platform_page_size();
+        u64 committed = align_up(sizeof(VectorHeader) + header->capacity * header->stride,
+                                 page_size);
+        u64 kept = align_up(sizeof(VectorHeader) + capacity * header->stride, page_size);
+        if (committed > header->reserved) {
+            committed = header->reserved;
+        }
+        if (committed > kept) {
+            platform_memory_decommit((u8*)header + kept, committed - kept);
+        }
+        header->capacity = (kept - sizeof(VectorHeader)) / header->stride;
+        return array;
+    }
+    return reallocate(array, capacity);
 }
 
 void* _vector_push(void* array, const void* value_ptr) {
-    u64 header_size = sizeof(VectorHeader);
-    VectorHeader* header = (VectorHeader*)((u8*)array - header_size);
+    VectorHeader* header = header_of(array);
     if (header->length >= header->capacity) {
         array = _vector_resize(array);
     }
-    header = (VectorHeader*)((u8*)array - header_size);
+    header = header_of(array);
+    if (header->length >= header->capacity) {
+        ERROR("Vector could not grow past %llu elements.", header->capacity);
+        return array;
+    }
 
     u64 addr = (u64)array;
     addr += (header->length * header->stride);
@@ -64,6 +181,23 @@ void* _vector_push(void* array, const void* value_ptr) {
     return array;
 }
 
+Vector(T) _vector_append_n(Vector(T) array, const T* values, u64 count) {
+    VectorHeader* header = header_of(array);
+    u64 length = header->length + count;
+    if (length > header->capacity) {
+        u64 grown = VECTOR_RESIZE_FACTOR * header->capacity;
+        array = reallocate(array, grown > length ? grown : length);
+        header = header_of(array);
+    }
+    if (length > header->capacity) {
+        ERROR("Vector could not grow past %llu elements.", header->capacity);
+        return array;
+    }
+    memcpy((u8*)array + header->length * header->stride, values, count * header->stride);
+    header->length = length;
+    return array;
+}
+
 void vector_pop(Vector(T) array, T* dest) {
     u64 length = vector_length(array);
     u64 stride = vector_stride(array);
@@ -81,16 +215,36 @@ Vector(T) vector_remove(Vector(T) array, u64 index, T* dest) {
     u64 length = vector_length(array);
     u64 stride = vector_stride(array);
     if (index >= length) {
-        ERROR("Index out of bounds. Length: %d, index: %d", length, index);
+        ERROR("Index out of bounds. Length: %llu, index: %llu", length, index);
         return array;
     }
     u64 addr = (u64)array;
-    memcpy(dest, (void*)(addr + (index * stride)), stride);
+    if (dest) {
+        memcpy(dest, (void*)(addr + (index * stride)), stride);
+    }
 
-    // If not on the last element, snip out the entry and copy the rest inward.
+    // If not on the last element, snip out the entry and move the rest inward.
     if (index != length - 1) {
-        memcpy((void*)(addr + (index * stride)), (void*)(addr + ((index + 1) * stride)),
-               stride * (length - (index - 1)));
+        memmove((void*)(addr + (index * stride)), (void*)(addr + ((index + 1) * stride)),
+                stride * (length - index - 1));
+    }
+    vector_length_set(array, length - 1);
+    return array;
+}
+
+Vector(T) vector_swap_remove(Vector(T) array, u64 index, T* dest) {
+    u64 length = vector_length(array);
+    u64 stride = vector_stride(array);
+    if (index >= length) {
+        ERROR("Index out of bounds. Length: %llu, index: %llu", length, index);
+        return array;
+    }
+    u64 addr = (u64)array;
+    if (dest) {
+        memcpy(dest, (void*)(addr + (index * stride)), stride);
+    }
+    if (index != length - 1) {
+        memcpy((void*)(addr + (index * stride)), (void*)(addr + ((length - 1) * stride)), stride);
     }
     vector_length_set(array, length - 1);
     return array;
@@ -123,9 +277,10 @@ Vector(T) vector_remove(Vector(T) array, u64 index, T* dest) {
 void vector_clear(void* array) { vector_length_set(array, 0); }
 
 u64 vector_capacity(void* array) {
-    u64 header_size = sizeof(VectorHeader);
-    VectorHeader* header = (VectorHeader*)((u8*)array - header_size);
-    return header->capacity;
+    if (array) {
+        return header_of(array)->capacity;
+    }
+    return 0;
 }
 
 u64 vector_length(void* array) {
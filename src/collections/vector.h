@@ -1,9 +1,12 @@
 #ifndef VECTOR_H
 #define VECTOR_H
 
+#include "core/mem.h"
 #include "types.h"
 
 #define VECTOR_RESIZE_FACTOR 2
+// Capacity of vector_new, enough that small vectors don't reallocate on every early push.
+#define VECTOR_DEFAULT_CAPACITY 8
 #define Vector(type) type*
 #define T void
 
@@ -16,8 +19,13 @@
  * @returns A pointer representing the block of memory containing the array.
  */
 Vector(T) _vector_new(u64 length, u64 stride);
+Vector(T) _vector_new_with(u64 length, u64 stride, const Allocator* allocator);
+Vector(T) _vector_new_reserved(u64 max_length, u64 stride);
 Vector(T) _vector_resize(Vector(T) array);
+Vector(T) _vector_reserve(Vector(T) array, u64 capacity);
+Vector(T) _vector_shrink_to_fit(Vector(T) array);
 Vector(T) _vector_push(Vector(T) array, const T* value_ptr);
+Vector(T) _vector_append_n(Vector(T) array, const T* values, u64 count);
 
 /* void* _vector_insert_at(void* array, u64 index, void* value_ptr);
  */
@@ -36,7 +44,31 @@ Vector(T) _vector_push(Vector(T) array, const T* value_ptr);
  * @param type The type to be used to create the vector.
  * @returns A pointer to the array's memory block.
  */
-#define vector_new(type) vector_with_capacity(type, 1)
+#define vector_new(type) vector_with_capacity(type, VECTOR_DEFAULT_CAPACITY)
+
+/**
+ * @brief Creates a new vector whose storage comes from `allocator` instead of the heap, such
+ * as an arena or a pool. The allocator is copied into the vector, but whatever its context
+ * points to must outlive the vector. Growing moves the elements into a new block and hands
+ * the old one to the allocator's free function, if it has one.
+ * @param type The type to be used to create the vector.
+ * @param capacity The number of elements the vector can initially hold (can be resized).
+ * @param allocator The allocator to take memory from; 0 selects the heap.
+ * @returns A pointer to the array's memory block, or 0 if the allocator is out of memory.
+ */
+#define vector_with_allocator(type, capacity, allocator)                                           \
+    _vector_new_with(capacity, sizeof(type), allocator)
+
+/**
+ * @brief Creates a vector that reserves address space for `max_capacity` elements up front and
+ * commits pages as it grows. Growing never copies, so element addresses stay valid for the
+ * lifetime of the vector. Pushing past `max_capacity` fails with an error.
+ * Only address space is taken until elements are pushed, so the maximum can be generous.
+ * @param type The type to be used to create the vector.
+ * @param max_capacity The number of elements the vector can ever hold.
+ * @returns A pointer to the array's memory block.
+ */
+#define vector_reserved(type, max_capacity) _vector_new_reserved(max_capacity, sizeof(type))
 
 /**
  * @brief Destroys the provided array, freeing any memory allocated by it.
@@ -56,6 +88,32 @@ void _vector_free(void* array);
         array = _vector_push(array, &temp);                                                        \
     }
 
+/**
+ * @brief Makes room for at least `capacity` elements with a single reallocation, so that many
+ * pushes that follow don't reallocate. Never shrinks the vector.
+ * @param array The array to grow. Reassigned to the new block.
+ * @param capacity The number of elements the array should be able to hold.
+ */
+#define vector_reserve(array, capacity)                                                            \
+    { array = _vector_reserve(array, capacity); }
+
+/**
+ * @brief Releases the capacity past the last element. Reserved vectors decommit their unused
+ * pages in place.
+ * @param array The array to shrink. Reassigned to the new block.
+ */
+#define vector_shrink_to_fit(array)                                                                \
+    { array = _vector_shrink_to_fit(array); }
+
+/**
+ * @brief Copies `count` elements to the end of the array, growing it at most once.
+ * @param array The array to append to. Reassigned if it has to grow.
+ * @param values Pointer to the first of the elements to copy.
+ * @param count The number of elements to copy.
+ */
+#define vector_append_n(array, values, count)                                                      \
+    { array = _vector_append_n(array, values, count); }
+
 void vector_pop(Vector(T) array, T* value_ptr);
 
 #define vector_insert_at(array, index, value)                                                      \
@@ -64,8 +122,19 @@ void vector_pop(Vector(T) array, T* value_ptr);
         array = _vector_insert_at(array, index, &temp);                                            \
     }
 
+/**
+ * @brief Removes the element at `index` and shifts the ones after it down, keeping their
+ * order. O(n); prefer vector_swap_remove when the order doesn't matter.
+ * @param value_ptr Receives the removed element. May be 0.
+ */
 Vector(T) vector_remove(Vector(T) array, u64 index, T* value_ptr);
 
+/**
+ * @brief Removes the element at `index` in O(1) by moving the last element into its place.
+ * @param value_ptr Receives the removed element. May be 0.
+ */
+Vector(T) vector_swap_remove(Vector(T) array, u64 index, T* value_ptr);
+
 /**
  * @brief Clears all entries from the array. Does not release any internally-allocated memory.
  * @param array The array to be cleared.
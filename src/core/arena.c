@@ -0,0 +1,130 @@
+#include "arena.h"
+#include "core/log.h"
+#include "platform/platform.h"
+
+static FrameArena frame_memory = {0};
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool arena_create(u64 reserve_bytes, Arena* arena) {
+    u64 granularity = align_up(ARENA_COMMIT_GRANULARITY, platform_page_size());
+    arena->reserved = align_up(reserve_bytes, granularity);
+    arena->base = platform_memory_reserve(arena->reserved);
+    arena->committed = 0;
+    arena->offset = 0;
+    arena->peak = 0;
+    if (!arena->base) {
+        ERROR("Failed to reserve %llu bytes for an arena", arena->reserved);
+        arena->reserved = 0;
+        return false;
+    }
+    return true;
+}
+
+void arena_destroy(Arena* arena) {
+    platform_memory_release(arena->base, arena->reserved);
+    arena->base = 0;
+    arena->reserved = 0;
+    arena->committed = 0;
+    arena->offset = 0;
+}
+
+void* arena_alloc(Arena* arena, u64 bytes, u64 alignment) {
+    u64 start = align_up(arena->offset, alignment);
+    u64 end = start + bytes;
+    if (end > arena->reserved || end < start) {
+        return 0;
+    }
+    if (end > arena->committed) {
+        u64 granularity = align_up(ARENA_COMMIT_GRANULARITY, platform_page_size());
+        u64 committed = align_up(end, granularity);
+        if (committed > arena->reserved) {
+            committed = arena->reserved;
+        }
+        if (!platform_memory_commit(arena->base + arena->committed,
+                                    committed - arena->committed)) {
+            return 0;
+        }
+        arena->committed = committed;
+    }
+    arena->offset = end;
+    if (end > arena->peak) {
+        arena->peak = end;
+    }
+    return arena->base + start;
+}
+
+u64 arena_mark(const Arena* arena) {
+    return arena->offset;
+}
+
+void arena_rewind(Arena* arena, u64 mark) {
+    if (mark < arena->offset) {
+        arena->offset = mark;
+    }
+}
+
+void arena_reset(Arena* arena) {
+    arena->offset = 0;
+}
+
+static void* arena_allocator_alloc(void* context, u64 bytes) {
+    return arena_alloc(context, bytes, 16);
+}
+
+Allocator arena_allocator(Arena* arena) {
+    Allocator allocator = {0};
+    allocator.alloc = arena_allocator_alloc;
+    allocator.context = arena;
+    return allocator;
+}
+
+bool frame_arena_create(u64 reserve_bytes, FrameArena* frame) {
+    frame->current = 0;
+    for (u32 i = 0; i < FRAME_ARENA_COUNT; i++) {
+        if (!arena_create(reserve_bytes, &frame->arenas[i])) {
+            for (u32 j = 0; j < i; j++) {
+                arena_destroy(&frame->arenas[j]);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void frame_arena_begin(FrameArena* frame) {
+    frame->current = (frame->current + 1) % FRAME_ARENA_COUNT;
+    arena_reset(&frame->arenas[frame->current]);
+}
+
+Arena* frame_arena_current(FrameArena* frame) {
+    return &frame->arenas[frame->current];
+}
+
+void frame_arena_destroy(FrameArena* frame) {
+    for (u32 i = 0; i < FRAME_ARENA_COUNT; i++) {
+        arena_destroy(&frame->arenas[i]);
+    }
+}
+
+bool frame_memory_create(u64 reserve_bytes) {
+    return frame_arena_create(reserve_bytes, &frame_memory);
+}
+
+void frame_memory_begin(void) {
+    frame_arena_begin(&frame_memory);
+}
+
+void* frame_alloc(u64 bytes, u64 alignment) {
+    void* block = arena_alloc(frame_arena_current(&frame_memory), bytes, alignment);
+    if (!block) {
+        ERROR("Frame arena exhausted allocating %llu bytes", bytes);
+    }
+    return block;
+}
+
+void frame_memory_destroy(void) {
+    frame_arena_destroy(&frame_memory);
+}
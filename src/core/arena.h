@@ -0,0 +1,74 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "core/mem.h"
+#include "types.h"
+
+// Pages are committed in steps of this size as the arena grows.
+#define ARENA_COMMIT_GRANULARITY (64 * 1024)
+// A frame's data stays valid through the following frame.
+#define FRAME_ARENA_COUNT 2
+#define FRAME_ARENA_DEFAULT_RESERVE (64ull * 1024 * 1024)
+
+/**
+ * Bump allocator over a reserved virtual range. Allocation is a pointer increment and all of
+ * it is released at once by resetting. The range never moves, so pointers stay valid until
+ * the next reset.
+ */
+typedef struct Arena {
+    u8* base;
+    u64 reserved;
+    u64 committed;
+    u64 offset;
+    // Highest offset ever reached, to size the reservation.
+    u64 peak;
+} Arena;
+
+bool arena_create(u64 reserve_bytes, Arena* arena);
+void arena_destroy(Arena* arena);
+
+/**
+ * Returns `bytes` of uninitialized memory aligned to `alignment`, a power of two, or 0 once
+ * the reservation is exhausted.
+ */
+void* arena_alloc(Arena* arena, u64 bytes, u64 alignment);
+
+#define arena_push(arena, type, count)                                                             \
+    ((type*)arena_alloc(arena, sizeof(type) * (count), _Alignof(type)))
+
+// Frees everything allocated after `mark`, which comes from `arena_mark`.
+u64 arena_mark(const Arena* arena);
+void arena_rewind(Arena* arena, u64 mark);
+
+// O(1); committed pages are kept for the next use.
+void arena_reset(Arena* arena);
+
+// Allocates 16-byte aligned blocks from the arena. Freeing is a no-op until the arena resets.
+Allocator arena_allocator(Arena* arena);
+
+/**
+ * A ring of arenas, one per frame. Beginning a frame switches to the next arena and resets
+ * it, so memory handed out during one frame remains valid through the next one. That is
+ * enough for data built during update and consumed while the following frame records.
+ */
+typedef struct FrameArena {
+    Arena arenas[FRAME_ARENA_COUNT];
+    u32 current;
+} FrameArena;
+
+bool frame_arena_create(u64 reserve_bytes, FrameArena* frame);
+void frame_arena_begin(FrameArena* frame);
+Arena* frame_arena_current(FrameArena* frame);
+void frame_arena_destroy(FrameArena* frame);
+
+/**
+ * Frame arena of the main thread, created by the application. Not thread safe.
+ */
+bool frame_memory_create(u64 reserve_bytes);
+void frame_memory_begin(void);
+void* frame_alloc(u64 bytes, u64 alignment);
+void frame_memory_destroy(void);
+
+#define frame_push(type, count) ((type*)frame_alloc(sizeof(type) * (count), _Alignof(type)))
+
+#endif
@@ -0,0 +1,298 @@
+// The ucontext routines are only declared for XSI builds on macOS.
+#define _XOPEN_SOURCE 600
+
+#include "fiber.h"
+#include "core/log.h"
+#include "core/mem.h"
+#include "defines.h"
+#include "platform/platform.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(FIBER_USE_UCONTEXT) &&                                                               \
+    !(defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)))
+#define FIBER_USE_UCONTEXT
+#endif
+
+#ifdef FIBER_USE_UCONTEXT
+#include <ucontext.h>
+#endif
+
+#if defined(__SANITIZE_ADDRESS__)
+#define FIBER_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define FIBER_ASAN
+#endif
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define FIBER_TSAN
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define FIBER_TSAN
+#endif
+#endif
+
+#ifdef FIBER_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+#ifdef FIBER_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+#ifndef FIBER_USE_UCONTEXT
+// Saves the callee-saved registers on the current stack, stores the stack pointer in `*from`
+// and pops the same registers off `to`. A new stack is prepared so that the pops land in
+// fiber_start, which calls the entry point held in one of the restored registers.
+void fiber_switch_context(void** from, void* to);
+void fiber_start(void);
+
+#if defined(__x86_64__)
+// Registers popped off a new stack: MXCSR and x87 control word, r15, r14, r13 (entry point),
+// r12 (fiber), rbx, rbp, return address.
+#define FIBER_FRAME_WORDS 8
+#define FIBER_FRAME_ENTRY 3
+#define FIBER_FRAME_FIBER 4
+#define FIBER_FRAME_RETURN 7
+// The frame sits below 16 spare bytes, so the stack is aligned when fiber_start calls.
+#define FIBER_FRAME_OFFSET 10
+__asm__(".text\n"
+        ".globl fiber_switch_context\n"
+        ".hidden fiber_switch_context\n"
+        ".type fiber_switch_context, @function\n"
+        "fiber_switch_context:\n"
+        "    pushq %rbp\n"
+        "    pushq %rbx\n"
+        "    pushq %r12\n"
+        "    pushq %r13\n"
+        "    pushq %r14\n"
+        "    pushq %r15\n"
+        "    subq $8, %rsp\n"
+        "    stmxcsr (%rsp)\n"
+        "    fnstcw 4(%rsp)\n"
+        "    movq %rsp, (%rdi)\n"
+        "    movq %rsi, %rsp\n"
+        "    ldmxcsr (%rsp)\n"
+        "    fldcw 4(%rsp)\n"
+        "    addq $8, %rsp\n"
+        "    popq %r15\n"
+        "    popq %r14\n"
+        "    popq %r13\n"
+        "    popq %r12\n"
+        "    popq %rbx\n"
+        "    popq %rbp\n"
+        "    ret\n"
+        ".size fiber_switch_context, .-fiber_switch_context\n"
+        ".globl fiber_start\n"
+        ".hidden fiber_start\n"
+        ".type fiber_start, @function\n"
+        "fiber_start:\n"
+        "    movq %r12, %rdi\n"
+        "    callq *%r13\n"
+        "    ud2\n"
+        ".size fiber_start, .-fiber_start\n");
+#elif defined(__aarch64__)
+// Registers popped off a new stack: x19 (fiber), x20 (entry point), x21-x28, x29, x30 (return
+// address) and d8-d15, 176 bytes to keep the stack pointer 16-byte aligned.
+#define FIBER_FRAME_WORDS 22
+#define FIBER_FRAME_ENTRY 1
+#define FIBER_FRAME_FIBER 0
+#define FIBER_FRAME_RETURN 11
+#define FIBER_FRAME_OFFSET 22
+__asm__(".text\n"
+        ".globl fiber_switch_context\n"
+        ".hidden fiber_switch_context\n"
+        ".type fiber_switch_context, %function\n"
+        "fiber_switch_context:\n"
+        "    sub sp, sp, #176\n"
+        "    stp x19, x20, [sp, #0]\n"
+        "    stp x21, x22, [sp, #16]\n"
+        "    stp x23, x24, [sp, #32]\n"
+        "    stp x25, x26, [sp, #48]\n"
+        "    stp x27, x28, [sp, #64]\n"
+        "    stp x29, x30, [sp, #80]\n"
+        "    stp d8, d9, [sp, #96]\n"
+        "    stp d10, d11, [sp, #112]\n"
+        "    stp d12, d13, [sp, #128]\n"
+        "    stp d14, d15, [sp, #144]\n"
+        "    mov x2, sp\n"
+        "    str x2, [x0]\n"
+        "    mov sp, x1\n"
+        "    ldp x19, x20, [sp, #0]\n"
+        "    ldp x21, x22, [sp, #16]\n"
+        "    ldp x23, x24, [sp, #32]\n"
+        "    ldp x25, x26, [sp, #48]\n"
+        "    ldp x27, x28, [sp, #64]\n"
+        "    ldp x29, x30, [sp, #80]\n"
+        "    ldp d8, d9, [sp, #96]\n"
+        "    ldp d10, d11, [sp, #112]\n"
+        "    ldp d12, d13, [sp, #128]\n"
+        "    ldp d14, d15, [sp, #144]\n"
+        "    add sp, sp, #176\n"
+        "    ret\n"
+        ".size fiber_switch_context, .-fiber_switch_context\n"
+        ".globl fiber_start\n"
+        ".hidden fiber_start\n"
+        ".type fiber_start, %function\n"
+        "fiber_start:\n"
+        "    mov x0, x19\n"
+        "    blr x20\n"
+        "    brk #0\n"
+        ".size fiber_start, .-fiber_start\n");
+#endif
+#endif
+
+#ifdef FIBER_ASAN
+// The fiber that is being switched away from, so the one arriving can record its stack bounds.
+static _Thread_local Fiber* switching_from = 0;
+
+static NOINLINE Fiber* switching_from_get(void) {
+    return switching_from;
+}
+#endif
+
+static void sanitizer_start_switch(Fiber* from, Fiber* to) {
+#ifdef FIBER_ASAN
+    switching_from = from;
+    __sanitizer_start_switch_fiber(&from->fake_stack, to->stack_bottom, to->stack_bottom_size);
+#endif
+#ifdef FIBER_TSAN
+    __tsan_switch_to_fiber(to->sanitizer_fiber, 0);
+#endif
+    UNUSED(from);
+    UNUSED(to);
+}
+
+static void sanitizer_finish_switch(Fiber* to) {
+#ifdef FIBER_ASAN
+    const void* bottom = 0;
+    size_t size = 0;
+    __sanitizer_finish_switch_fiber(to->fake_stack, &bottom, &size);
+    // A thread's stack bounds are only known once it has switched away for the first time.
+    Fiber* from = switching_from_get();
+    if (!from->stack_bottom) {
+        from->stack_bottom = bottom;
+        from->stack_bottom_size = size;
+    }
+#endif
+    UNUSED(to);
+}
+
+static void fiber_entry(Fiber* fiber) {
+    sanitizer_finish_switch(fiber);
+    fiber->fn(fiber->arg);
+    ERROR("A fiber returned from its function instead of switching away.");
+    logger_flush();
+    abort();
+}
+
+#ifdef FIBER_USE_UCONTEXT
+// makecontext only passes ints, so the fiber pointer arrives in two halves.
+static void ucontext_entry(int high, int low) {
+    fiber_entry((Fiber*)(((u64)(u32)high << 32) | (u32)low));
+}
+
+// Kept apart from fiber_create, since getcontext may clobber the locals of its caller.
+static ucontext_t* ucontext_create(Fiber* fiber) {
+    ucontext_t* context = mem_alloc_tagged(sizeof(ucontext_t), MEM_TAG_JOB);
+    if (!context || getcontext(context) != 0) {
+        if (context) {
+            mem_free(context);
+        }
+        return 0;
+    }
+    context->uc_stack.ss_sp = (void*)fiber->stack_bottom;
+    context->uc_stack.ss_size = fiber->stack_bottom_size;
+    context->uc_link = 0;
+    u64 address = (u64)fiber;
+    makecontext(context, (void (*)(void))ucontext_entry, 2, (int)(u32)(address >> 32),
+                (int)(u32)address);
+    return context;
+}
+#endif
+
+bool fiber_create(FiberFn fn, void* arg, u64 stack_size, Fiber* fiber) {
+    memset(fiber, 0, sizeof(Fiber));
+    u64 page = platform_page_size();
+    stack_size = (stack_size + page - 1) & ~(page - 1);
+    // The page below the stack stays reserved but inaccessible.
+    u8* base = platform_memory_reserve(stack_size + page);
+    if (!base || !platform_memory_commit(base + page, stack_size)) {
+        ERROR("Failed to allocate a %llu byte fiber stack", stack_size);
+        if (base) {
+            platform_memory_release(base, stack_size + page);
+        }
+        return false;
+    }
+    fiber->stack = base;
+    fiber->stack_size = stack_size;
+    fiber->fn = fn;
+    fiber->arg = arg;
+    fiber->stack_bottom = base + page;
+    fiber->stack_bottom_size = stack_size;
+#ifdef FIBER_USE_UCONTEXT
+    fiber->context = ucontext_create(fiber);
+    if (!fiber->context) {
+        ERROR("Failed to create a fiber context");
+        platform_memory_release(base, stack_size + page);
+        return false;
+    }
+#else
+    u64* frame = (u64*)(base + page + stack_size) - FIBER_FRAME_OFFSET;
+    memset(frame, 0, FIBER_FRAME_WORDS * sizeof(u64));
+#if defined(__x86_64__)
+    // Default MXCSR (all exceptions masked, round to nearest) and x87 control word.
+    frame[0] = 0x1F80 | (0x037Full << 32);
+#endif
+    frame[FIBER_FRAME_ENTRY] = (u64)fiber_entry;
+    frame[FIBER_FRAME_FIBER] = (u64)fiber;
+    frame[FIBER_FRAME_RETURN] = (u64)fiber_start;
+    fiber->context = frame;
+#endif
+#ifdef FIBER_TSAN
+    fiber->sanitizer_fiber = __tsan_create_fiber(0);
+#endif
+    return true;
+}
+
+void fiber_destroy(Fiber* fiber) {
+#ifdef FIBER_USE_UCONTEXT
+    if (fiber->context) {
+        mem_free(fiber->context);
+    }
+#endif
+    if (fiber->stack) {
+#ifdef FIBER_TSAN
+        __tsan_destroy_fiber(fiber->sanitizer_fiber);
+#endif
+        platform_memory_release(fiber->stack, fiber->stack_size + platform_page_size());
+    }
+    memset(fiber, 0, sizeof(Fiber));
+}
+
+bool fiber_from_thread(Fiber* fiber) {
+    memset(fiber, 0, sizeof(Fiber));
+#ifdef FIBER_USE_UCONTEXT
+    // Filled in by the first switch away from the thread.
+    fiber->context = mem_alloc_tagged(sizeof(ucontext_t), MEM_TAG_JOB);
+    if (!fiber->context) {
+        ERROR("Failed to create a fiber context");
+        return false;
+    }
+#endif
+#ifdef FIBER_TSAN
+    fiber->sanitizer_fiber = __tsan_get_current_fiber();
+#endif
+    return true;
+}
+
+void fiber_switch(Fiber* from, Fiber* to) {
+    sanitizer_start_switch(from, to);
+#ifdef FIBER_USE_UCONTEXT
+    swapcontext(from->context, to->context);
+#else
+    fiber_switch_context(&from->context, to->context);
+#endif
+    sanitizer_finish_switch(from);
+}
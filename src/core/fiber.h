@@ -0,0 +1,43 @@
+#ifndef FIBER_H
+#define FIBER_H
+
+#include "types.h"
+
+typedef void (*FiberFn)(void* arg);
+
+/**
+ * A stack plus the registers needed to resume it. Switching between fibers is a plain function
+ * call that saves the callee-saved registers and swaps the stack pointer; the kernel is not
+ * involved. Linux on x86-64 and AArch64 uses hand-written switches, everything else (or a build
+ * with FIBER_USE_UCONTEXT) goes through ucontext.
+ */
+typedef struct Fiber {
+    // Saved stack pointer, or the ucontext_t of the fallback.
+    void* context;
+    // 0 for fibers created from a thread, whose stack belongs to the thread.
+    u8* stack;
+    u64 stack_size;
+    FiberFn fn;
+    void* arg;
+    // Bookkeeping for the sanitizers, which have to be told about stack switches.
+    void* sanitizer_fiber;
+    void* fake_stack;
+    const void* stack_bottom;
+    u64 stack_bottom_size;
+} Fiber;
+
+/**
+ * Creates a fiber that runs `fn(arg)` on its own stack the first time it is switched to.
+ * The lowest page of the stack is left unmapped so an overflow faults instead of silently
+ * corrupting memory. `fn` must never return; it switches to another fiber instead.
+ */
+bool fiber_create(FiberFn fn, void* arg, u64 stack_size, Fiber* fiber);
+void fiber_destroy(Fiber* fiber);
+
+// Wraps the calling thread so other fibers can switch back to it.
+bool fiber_from_thread(Fiber* fiber);
+
+// Saves the calling context in `from` and resumes `to`. Returns once something switches to `from`.
+void fiber_switch(Fiber* from, Fiber* to);
+
+#endif
@@ -0,0 +1,65 @@
+#include "frame_limiter.h"
+#include "core/profiler.h"
+#include "platform/platform.h"
+
+#define SPIN_MARGIN_MIN 0.0002
+#define SPIN_MARGIN_INITIAL 0.002
+// One bad oversleep must not turn every later frame into a spin.
+#define SPIN_MARGIN_MAX 0.004
+#define SPIN_MARGIN_MAX_FRACTION 0.25
+
+void frame_limiter_create(f32 max_fps, FrameLimiter* limiter) {
+    limiter->spin_margin = SPIN_MARGIN_INITIAL;
+    instant_now(&limiter->last_frame);
+    frame_limiter_set_max_fps(limiter, max_fps);
+}
+
+void frame_limiter_set_max_fps(FrameLimiter* limiter, f32 max_fps) {
+    limiter->frame_time = max_fps > 0.0f ? 1.0 / max_fps : 0.0;
+    limiter->deadline = platform_system_time() + limiter->frame_time;
+}
+
+f64 frame_limiter_wait(FrameLimiter* limiter) {
+    PROFILE_SCOPE("frame_limiter_wait");
+    if (limiter->frame_time > 0.0) {
+        f64 now = platform_system_time();
+        f64 remaining = limiter->deadline - now;
+        if (remaining > limiter->spin_margin) {
+            f64 requested = remaining - limiter->spin_margin;
+            platform_sleep(requested);
+            f64 overshoot = platform_system_time() - now - requested;
+            // Grow at once when the OS oversleeps, shrink slowly when it behaves.
+            if (overshoot > limiter->spin_margin) {
+                limiter->spin_margin = overshoot;
+            } else {
+                limiter->spin_margin = limiter->spin_margin * 0.95 + overshoot * 0.05;
+            }
+        } else {
+            // Frames too late to sleep say nothing about the OS; let the margin recover.
+            limiter->spin_margin *= 0.95;
+        }
+        f64 margin_max = limiter->frame_time * SPIN_MARGIN_MAX_FRACTION;
+        if (margin_max > SPIN_MARGIN_MAX) {
+            margin_max = SPIN_MARGIN_MAX;
+        }
+        if (limiter->spin_margin > margin_max) {
+            limiter->spin_margin = margin_max;
+        }
+        if (limiter->spin_margin < SPIN_MARGIN_MIN) {
+            limiter->spin_margin = SPIN_MARGIN_MIN;
+        }
+        while (platform_system_time() < limiter->deadline) {
+            platform_cpu_relax();
+        }
+
+        // Keep a steady cadence, but do not try to catch up after a long stall.
+        now = platform_system_time();
+        limiter->deadline += limiter->frame_time;
+        if (limiter->deadline < now) {
+            limiter->deadline = now + limiter->frame_time;
+        }
+    }
+    f64 elapsed = instant_elapsed(&limiter->last_frame);
+    instant_now(&limiter->last_frame);
+    return elapsed;
+}
@@ -0,0 +1,34 @@
+#ifndef FRAME_LIMITER_H
+#define FRAME_LIMITER_H
+
+#include "instant.h"
+#include "types.h"
+
+/**
+ * Caps the frame rate without burning a core. The thread sleeps until shortly before the
+ * next frame deadline and spins for the rest, since OS sleeps routinely overshoot by a
+ * fraction of a millisecond.
+ */
+typedef struct FrameLimiter {
+    // Seconds per frame, 0 when uncapped.
+    f64 frame_time;
+    // How long before the deadline sleeping stops. Adapts to the measured oversleep, up to a
+    // quarter of the frame time or 4 ms.
+    f64 spin_margin;
+    f64 deadline;
+    Instant last_frame;
+} FrameLimiter;
+
+/**
+ * A `max_fps` of 0 disables the limiter.
+ */
+void frame_limiter_create(f32 max_fps, FrameLimiter* limiter);
+void frame_limiter_set_max_fps(FrameLimiter* limiter, f32 max_fps);
+
+/**
+ * Blocks until the next frame may start and returns the seconds elapsed since the
+ * previous call.
+ */
+f64 frame_limiter_wait(FrameLimiter* limiter);
+
+#endif
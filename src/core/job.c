@@ -0,0 +1,465 @@
+#include "job.h"
+#include "collections/ring_buffer.h"
+#include "core/fiber.h"
+#include "core/log.h"
+#include "core/pool.h"
+#include "core/profiler.h"
+#include "defines.h"
+#include "platform/platform.h"
+#include <stdio.h>
+#include <string.h>
+
+// Failed steal rounds before an idle worker starts yielding, and then sleeping.
+#define JOB_IDLE_SPINS 64
+#define JOB_IDLE_YIELDS 256
+// New jobs wake sleeping workers. The timeout only matters for counters released from outside
+// the job system, which nothing is woken for.
+#define JOB_IDLE_SLEEP_SECONDS 0.001
+#define JOB_CHUNKS_PER_THREAD 8
+
+typedef struct ParallelFor {
+    ParallelForFn fn;
+    void* arg;
+    u32 grain;
+} ParallelFor;
+
+typedef struct Job {
+    JobFn fn;
+    void* arg;
+    JobCounter* counter;
+    // Set for the ranges of a parallel_for, which run `range->fn` over [start, end).
+    ParallelFor* range;
+    u32 start;
+    u32 end;
+} Job;
+
+/**
+ * Chase-Lev work-stealing deque. The owner pushes and takes at the bottom without contention;
+ * other threads steal from the top, and only the last job is contended between both ends.
+ */
+typedef struct JobDeque {
+    _Alignas(CACHE_LINE_SIZE) _Atomic(i64) top;
+    _Alignas(CACHE_LINE_SIZE) _Atomic(i64) bottom;
+    _Atomic(Job*) jobs[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+typedef struct JobFiber {
+    Fiber fiber;
+    // The job to start when the fiber is taken from the free list.
+    Job* job;
+    // Set while the job is suspended in job_wait.
+    JobCounter* waiting_on;
+} JobFiber;
+
+typedef struct JobSystem {
+    JobDeque deques[JOB_MAX_THREADS];
+    PoolCache caches[JOB_MAX_THREADS];
+    Thread threads[JOB_MAX_THREADS];
+    // What each thread switches back to when its fiber finishes or waits.
+    Fiber schedulers[JOB_MAX_THREADS];
+    JobFiber* current_fibers[JOB_MAX_THREADS];
+    JobFiber* fibers;
+    u32 fiber_count;
+    MpmcRing free_fibers;
+    MpmcRing waiting_fibers;
+    Pool pool;
+    u32 thread_count;
+    _Atomic(bool) running;
+    // Bumped to wake sleeping workers, who wait for it to change.
+    _Alignas(CACHE_LINE_SIZE) _Atomic(u32) wake_epoch;
+    _Atomic(u32) sleepers;
+} JobSystem;
+
+static JobSystem jobs = {0};
+static _Thread_local u32 thread_index = 0;
+
+// A job can be suspended on one thread and resumed on another. Code that may run after a fiber
+// switch reads the index through this call, so the compiler can't reuse an earlier read.
+static NOINLINE u32 current_thread(void) {
+    return thread_index;
+}
+
+static bool deque_push(JobDeque* deque, Job* job) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) {
+        return false;
+    }
+    atomic_store_explicit(&deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)], job,
+                          memory_order_relaxed);
+    // A release store rather than a release fence, which thread sanitizer doesn't understand.
+    atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+    return true;
+}
+
+static Job* deque_take(JobDeque* deque) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    if (top > bottom) {
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+        return 0;
+    }
+    Job* job =
+        atomic_load_explicit(&deque->jobs[bottom & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (top == bottom) {
+        // The last job: whoever moves the top first gets it.
+        if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            job = 0;
+        }
+        atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+static Job* deque_steal(JobDeque* deque) {
+    i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (top >= bottom) {
+        return 0;
+    }
+    Job* job =
+        atomic_load_explicit(&deque->jobs[top & (JOB_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top, &top, top + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return 0;
+    }
+    return job;
+}
+
+static i64 deque_size(JobDeque* deque) {
+    i64 bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    return bottom > top ? bottom - top : 0;
+}
+
+static void counter_done(JobCounter* counter) {
+    if (counter) {
+        atomic_fetch_sub_explicit(&counter->value, 1, memory_order_release);
+    }
+}
+
+static void run_range(ParallelFor* range, u32 start, u32 end, JobCounter* counter);
+
+static void execute(Job* job) {
+    if (job->range) {
+        run_range(job->range, job->start, job->end, job->counter);
+    } else {
+        PROFILE_SCOPE("job");
+        job->fn(job->arg);
+    }
+    counter_done(job->counter);
+    pool_cache_free(&jobs.caches[current_thread()], job);
+}
+
+static void fiber_main(void* arg) {
+    JobFiber* self = arg;
+    for (;;) {
+        execute(self->job);
+        self->job = 0;
+        fiber_switch(&self->fiber, &jobs.schedulers[current_thread()]);
+    }
+}
+
+// Runs `fiber` until its job finishes or waits. Only called on a thread's own stack, which
+// never moves to another thread, so the index stays valid across the switch.
+static void resume(JobFiber* fiber) {
+    u32 index = current_thread();
+    jobs.current_fibers[index] = fiber;
+    fiber_switch(&jobs.schedulers[index], &fiber->fiber);
+    jobs.current_fibers[index] = 0;
+    // Only now that its stack has been left can another thread pick the fiber up. Both rings
+    // hold every fiber, so they never fill up.
+    mpmc_ring_push(fiber->waiting_on ? &jobs.waiting_fibers : &jobs.free_fibers, &fiber);
+}
+
+/**
+ * Resumes a suspended job whose counter has reached zero, or else starts one from the own
+ * deque or one stolen from another thread. Suspended jobs go first so dependency chains finish
+ * before new work piles up.
+ */
+static bool run_one(void) {
+    JobFiber* fiber = 0;
+    if (mpmc_ring_pop(&jobs.waiting_fibers, &fiber)) {
+        if (atomic_load_explicit(&fiber->waiting_on->value, memory_order_acquire) == 0) {
+            resume(fiber);
+            return true;
+        }
+        mpmc_ring_push(&jobs.waiting_fibers, &fiber);
+    }
+    u32 index = current_thread();
+    Job* job = deque_take(&jobs.deques[index]);
+    for (u32 i = 1; !job && i < jobs.thread_count; i++) {
+        job = deque_steal(&jobs.deques[(index + i) % jobs.thread_count]);
+    }
+    if (!job) {
+        return false;
+    }
+    if (!mpmc_ring_pop(&jobs.free_fibers, &fiber)) {
+        // Every fiber is taken, so the job runs here and blocks this thread if it waits.
+        execute(job);
+        return true;
+    }
+    fiber->job = job;
+    resume(fiber);
+    return true;
+}
+
+static void wake_worker(void) {
+    // Pairs with the fence in worker_sleep: either the sleeper finds the new job, or this
+    // finds the sleeper.
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&jobs.sleepers, memory_order_relaxed) > 0) {
+        atomic_fetch_add_explicit(&jobs.wake_epoch, 1, memory_order_release);
+        platform_wake_address(&jobs.wake_epoch, 1);
+    }
+}
+
+static void submit(Job* job) {
+    if (!deque_push(&jobs.deques[current_thread()], job)) {
+        execute(job);
+        return;
+    }
+    wake_worker();
+}
+
+static void worker_sleep(void) {
+    u32 epoch = atomic_load_explicit(&jobs.wake_epoch, memory_order_acquire);
+    atomic_fetch_add_explicit(&jobs.sleepers, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    // Jobs pushed before the fence are found here; later ones bump the epoch.
+    if (!run_one()) {
+        platform_wait_on_address(&jobs.wake_epoch, epoch, JOB_IDLE_SLEEP_SECONDS);
+    }
+    atomic_fetch_sub_explicit(&jobs.sleepers, 1, memory_order_relaxed);
+}
+
+static void worker_main(void* arg) {
+    thread_index = (u32)(u64)arg;
+    char name[16];
+    snprintf(name, sizeof(name), "job worker %u", thread_index);
+    platform_thread_set_name(name);
+    profiler_set_thread_name(name);
+    pool_cache_create(&jobs.pool, &jobs.caches[thread_index]);
+    if (!fiber_from_thread(&jobs.schedulers[thread_index])) {
+        WARN("Job worker %d has no scheduler fiber and won't run jobs.", thread_index);
+        pool_cache_flush(&jobs.caches[thread_index]);
+        return;
+    }
+    u32 idle = 0;
+    while (atomic_load_explicit(&jobs.running, memory_order_acquire)) {
+        if (run_one()) {
+            idle = 0;
+        } else if (++idle > JOB_IDLE_SPINS + JOB_IDLE_YIELDS) {
+            worker_sleep();
+            idle = 0;
+        } else if (idle > JOB_IDLE_SPINS) {
+            platform_thread_yield();
+        } else {
+            platform_cpu_relax();
+        }
+    }
+    pool_cache_flush(&jobs.caches[thread_index]);
+    fiber_destroy(&jobs.schedulers[thread_index]);
+}
+
+static bool fibers_create(void) {
+    if (!mpmc_ring_create_typed(JobFiber*, JOB_FIBER_COUNT, &jobs.free_fibers) ||
+        !mpmc_ring_create_typed(JobFiber*, JOB_FIBER_COUNT, &jobs.waiting_fibers)) {
+        return false;
+    }
+    jobs.fibers = mem_alloc_tagged(sizeof(JobFiber) * JOB_FIBER_COUNT, MEM_TAG_JOB);
+    if (!jobs.fibers) {
+        return false;
+    }
+    memset(jobs.fibers, 0, sizeof(JobFiber) * JOB_FIBER_COUNT);
+    // Fewer fibers only means more jobs run without one, so a failure here isn't fatal.
+    for (jobs.fiber_count = 0; jobs.fiber_count < JOB_FIBER_COUNT; jobs.fiber_count++) {
+        JobFiber* fiber = &jobs.fibers[jobs.fiber_count];
+        if (!fiber_create(fiber_main, fiber, JOB_FIBER_STACK_SIZE, &fiber->fiber)) {
+            WARN("Only %d of %d job fibers could be created.", jobs.fiber_count, JOB_FIBER_COUNT);
+            break;
+        }
+        mpmc_ring_push(&jobs.free_fibers, &fiber);
+    }
+    return true;
+}
+
+static void fibers_destroy(void) {
+    for (u32 i = 0; i < jobs.fiber_count; i++) {
+        fiber_destroy(&jobs.fibers[i].fiber);
+    }
+    if (jobs.fibers) {
+        mem_free(jobs.fibers);
+    }
+    jobs.fibers = 0;
+    jobs.fiber_count = 0;
+    mpmc_ring_destroy(&jobs.free_fibers);
+    mpmc_ring_destroy(&jobs.waiting_fibers);
+}
+
+bool job_system_create(u32 worker_count) {
+    if (worker_count == 0) {
+        u32 processors = platform_processor_count();
+        worker_count = processors > 1 ? processors - 1 : 0;
+    }
+    if (worker_count > JOB_MAX_THREADS - 1) {
+        worker_count = JOB_MAX_THREADS - 1;
+    }
+    if (!pool_create_typed(Job, JOB_POOL_SLAB, MEM_TAG_JOB, POOL_FLAG_NONE, &jobs.pool)) {
+        ERROR("Failed to create the job pool.");
+        return false;
+    }
+    if (!fibers_create() || !fiber_from_thread(&jobs.schedulers[0])) {
+        ERROR("Failed to create the job fibers.");
+        fibers_destroy();
+        pool_destroy(&jobs.pool);
+        return false;
+    }
+    for (u32 i = 0; i <= worker_count; i++) {
+        atomic_init(&jobs.deques[i].top, 0);
+        atomic_init(&jobs.deques[i].bottom, 0);
+    }
+    thread_index = 0;
+    pool_cache_create(&jobs.pool, &jobs.caches[0]);
+    atomic_store(&jobs.running, true);
+    // Set before the workers start, since they read it. A worker that fails to start leaves
+    // an empty deque behind, which is harmless to steal from.
+    jobs.thread_count = worker_count + 1;
+    for (u32 i = 1; i <= worker_count; i++) {
+        if (!platform_thread_create(worker_main, (void*)(u64)i, &jobs.threads[i])) {
+            WARN("Failed to start job worker %d.", i);
+        }
+    }
+    INFO("Job system running on %d threads.", jobs.thread_count);
+    return true;
+}
+
+void job_system_destroy(void) {
+    if (jobs.thread_count == 0) {
+        return;
+    }
+    while (run_one()) {
+    }
+    atomic_store(&jobs.running, false);
+    atomic_fetch_add(&jobs.wake_epoch, 1);
+    platform_wake_address(&jobs.wake_epoch, PLATFORM_WAKE_ALL);
+    for (u32 i = 1; i < jobs.thread_count; i++) {
+        platform_thread_join(&jobs.threads[i]);
+    }
+    pool_cache_flush(&jobs.caches[0]);
+    fiber_destroy(&jobs.schedulers[0]);
+    fibers_destroy();
+    pool_destroy(&jobs.pool);
+    jobs.thread_count = 0;
+}
+
+u32 job_system_thread_count(void) {
+    return jobs.thread_count > 0 ? jobs.thread_count : 1;
+}
+
+u32 job_thread_index(void) {
+    return current_thread();
+}
+
+void job_run(JobFn fn, void* arg, JobCounter* counter) {
+    if (jobs.thread_count == 0) {
+        fn(arg);
+        return;
+    }
+    if (counter) {
+        atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
+    }
+    Job* job = pool_cache_alloc(&jobs.caches[current_thread()]);
+    if (!job) {
+        // Out of memory for jobs: still honour the contract by running it here.
+        fn(arg);
+        counter_done(counter);
+        return;
+    }
+    memset(job, 0, sizeof(Job));
+    job->fn = fn;
+    job->arg = arg;
+    job->counter = counter;
+    submit(job);
+}
+
+void job_run_batch(const JobDecl* decls, u32 count, JobCounter* counter) {
+    for (u32 i = 0; i < count; i++) {
+        job_run(decls[i].fn, decls[i].arg, counter);
+    }
+}
+
+void job_wait(JobCounter* counter) {
+    if (atomic_load_explicit(&counter->value, memory_order_acquire) == 0) {
+        return;
+    }
+    JobFiber* fiber = jobs.thread_count > 0 ? jobs.current_fibers[current_thread()] : 0;
+    if (fiber) {
+        // The thread goes back to its scheduler and the job waits in the suspended list.
+        fiber->waiting_on = counter;
+        while (atomic_load_explicit(&counter->value, memory_order_acquire) > 0) {
+            fiber_switch(&fiber->fiber, &jobs.schedulers[current_thread()]);
+        }
+        fiber->waiting_on = 0;
+        return;
+    }
+    u32 idle = 0;
+    while (atomic_load_explicit(&counter->value, memory_order_acquire) > 0) {
+        if (jobs.thread_count > 0 && run_one()) {
+            idle = 0;
+        } else if (++idle > JOB_IDLE_SPINS) {
+            platform_thread_yield();
+        } else {
+            platform_cpu_relax();
+        }
+    }
+}
+
+// Lazy binary splitting: the range is worked through a grain at a time, and half of what is
+// left is handed out whenever this thread's deque runs dry, which means its earlier jobs were
+// stolen by threads that are out of work.
+static void run_range(ParallelFor* range, u32 start, u32 end, JobCounter* counter) {
+    PROFILE_SCOPE("parallel_for");
+    while (start < end) {
+        // Re-read every round, since `fn` may have waited and moved the job to another thread.
+        u32 index = current_thread();
+        if (end - start > range->grain * 2 && deque_size(&jobs.deques[index]) == 0) {
+            Job* job = pool_cache_alloc(&jobs.caches[index]);
+            if (job) {
+                u32 middle = start + (end - start) / 2;
+                memset(job, 0, sizeof(Job));
+                job->range = range;
+                job->start = middle;
+                job->end = end;
+                job->counter = counter;
+                atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
+                submit(job);
+                end = middle;
+            }
+        }
+        u32 chunk_end = end - start > range->grain ? start + range->grain : end;
+        range->fn(start, chunk_end, range->arg);
+        start = chunk_end;
+    }
+}
+
+void parallel_for(u32 count, u32 min_grain, ParallelForFn fn, void* arg) {
+    if (count == 0) {
+        return;
+    }
+    if (jobs.thread_count <= 1) {
+        fn(0, count, arg);
+        return;
+    }
+    // Large loops take bigger steps, which keeps the per-chunk overhead negligible while
+    // leaving several chunks per thread to balance with.
+    u32 grain = count / (jobs.thread_count * JOB_CHUNKS_PER_THREAD);
+    ParallelFor range = {fn, arg, grain > min_grain ? grain : (min_grain > 0 ? min_grain : 1)};
+    JobCounter counter = {0};
+    run_range(&range, 0, count, &counter);
+    job_wait(&counter);
+}
@@ -0,0 +1,77 @@
+#ifndef JOB_H
+#define JOB_H
+
+#include "types.h"
+#include <stdatomic.h>
+
+// Threads including the main thread.
+#define JOB_MAX_THREADS 32
+// Jobs one thread can have queued. Pushing to a full deque runs the job immediately.
+#define JOB_DEQUE_CAPACITY 1024
+#define JOB_POOL_SLAB 256
+// Jobs that can be started or suspended at once. Beyond that, jobs run on the stack of the
+// thread that picked them up and block it while they wait.
+#define JOB_FIBER_COUNT 64
+// Jobs call into drivers and decoders written with thread-sized stacks in mind.
+#define JOB_FIBER_STACK_SIZE (512 * 1024)
+
+typedef void (*JobFn)(void* arg);
+// Processes the indices [start, end).
+typedef void (*ParallelForFn)(u32 start, u32 end, void* arg);
+
+/**
+ * Counts the unfinished jobs it was passed to. Zero it before the first use; a counter can be
+ * shared by any number of jobs and reused once it drops back to zero. Waiting on a counter is
+ * how dependencies are expressed: a job that needs other results waits on their counter.
+ */
+typedef struct JobCounter {
+    _Atomic(u32) value;
+} JobCounter;
+
+typedef struct JobDecl {
+    JobFn fn;
+    void* arg;
+} JobDecl;
+
+/**
+ * Starts `worker_count` worker threads, or one per logical processor besides the calling
+ * thread when it is 0. The calling thread becomes thread 0 of the system and runs jobs
+ * whenever it waits. Until the system is created, and after it is destroyed, jobs run
+ * immediately on the thread that submits them.
+ *
+ * Jobs run on fibers. A job that waits on a counter is suspended and its thread moves on to
+ * other work; whichever thread finds the counter at zero later resumes it, so a job may finish
+ * on a different thread than it started on.
+ */
+bool job_system_create(u32 worker_count);
+// Stops the workers. Every job must have been waited for.
+void job_system_destroy(void);
+
+// Workers plus the main thread, or 1 when the system isn't running.
+u32 job_system_thread_count(void);
+// 0 on the main thread, 1..n on workers.
+u32 job_thread_index(void);
+
+/**
+ * Queues `fn(arg)` on the calling thread's deque, where idle threads can steal it.
+ * `counter`, if not 0, is incremented now and decremented once the job has run.
+ * Must be called from the main thread or from a job.
+ */
+void job_run(JobFn fn, void* arg, JobCounter* counter);
+void job_run_batch(const JobDecl* jobs, u32 count, JobCounter* counter);
+
+/**
+ * Returns once the counter reaches zero. Inside a job this suspends the job; elsewhere the
+ * calling thread runs queued jobs until then.
+ */
+void job_wait(JobCounter* counter);
+
+/**
+ * Splits [0, count) into ranges and runs `fn` over them on every thread, returning once all
+ * of them are done. Ranges are only split while other threads are around to steal the other
+ * half, so small loops stay on one thread and uneven work still balances. The grain grows
+ * with `count` and never drops below `min_grain` indices.
+ */
+void parallel_for(u32 count, u32 min_grain, ParallelForFn fn, void* arg);
+
+#endif
@@ -1,54 +1,664 @@
 #include "log.h"
+#include "collections/ring_buffer.h"
+#include "core/mem.h"
 #include "platform/fs.h"
 #include "platform/platform.h"
-#include "str.h"
+#include "platform/sync.h"
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+
+// Records queued before callers have to wait for the writer.
+#define LOG_QUEUE_CAPACITY 2048
+// Message bytes stored in the record itself; longer messages are copied to the heap.
+#define LOG_RECORD_TEXT 480
+// Upper bound on how long a record waits before it is written. Warnings and errors are
+// written right away.
+#define LOG_FLUSH_INTERVAL 0.02
+#define LOG_BATCH_SIZE (64 * 1024)
+#define LOG_LINE_SIZE 4096
+// Log statements that can be deferred; later ones are formatted on the calling thread.
+#define LOG_MAX_SITES 4096
+// Threads with their own capture buffer; later ones share the text queue.
+#define LOG_MAX_THREADS 64
+#define LOG_THREAD_CAPACITY 1024
+#define LOG_CAPTURE_ARGS 240
+// Longest format string a site can have.
+#define LOG_MAX_FORMAT 1024
+// Id of sites that always take the text path.
+#define LOG_SITE_TEXT UINT32_MAX
+// Site of captures holding a message formatted on the calling thread; real ids start at 1.
+#define LOG_CAPTURE_TEXT 0
+// Module of sites not reached yet.
+#define LOG_MODULE_PENDING 0
+// Shared by the modules that didn't fit in the table; they follow the default level.
+#define LOG_MODULE_OTHER 1
+#define LOG_MAX_LEVEL_RULES 32
+#define LOG_RULE_PREFIX 128
+
+typedef struct LogRecord {
+    const char* file;
+    // Set when the message didn't fit in `text`.
+    char* overflow;
+    u32 line;
+    u8 level;
+    char text[LOG_RECORD_TEXT];
+} LogRecord;
+
+// A deferred message, as it waits in the buffer of the thread that logged it.
+typedef struct LogCapture {
+    u32 site;
+    u16 size;
+    f64 time;
+    u8 args[LOG_CAPTURE_ARGS];
+} LogCapture;
+
+// Starts the args of a LOG_CAPTURE_TEXT capture; the message follows unless it is in `overflow`.
+typedef struct LogCapturedText {
+    const char* file;
+    char* overflow;
+    u32 line;
+    u8 level;
+} LogCapturedText;
+
+typedef struct LogLevelRule {
+    char prefix[LOG_RULE_PREFIX];
+    u8 level;
+} LogLevelRule;
+
+typedef struct LogBatch {
+    char console[LOG_BATCH_SIZE];
+    u64 console_length;
+    // Level of the lines in `console`; one console call prints them all in its color.
+    LogLevel console_level;
+    char file[LOG_BATCH_SIZE];
+    u64 file_length;
+    char binary[LOG_BATCH_SIZE];
+    u64 binary_length;
+} LogBatch;
 
 typedef struct Logger {
     File handle;
+    MpmcRing queue;
+    Thread writer;
+    _Atomic(bool) running;
+    Event wake;
+    // Held while draining, so logger_flush and the writer never interleave their output.
+    Mutex write_lock;
+    LogBatch batch;
+    // One producer each: the thread that registered the slot.
+    SpscRing rings[LOG_MAX_THREADS];
+    _Atomic(bool) ring_ready[LOG_MAX_THREADS];
+    _Atomic(u32) ring_count;
+    // Changes with every logger_create, so threads register again with a new logger.
+    _Atomic(u32) generation;
+    _Atomic(bool) binary;
+    File binlog;
+    // Sites whose definition has been written to `binlog`.
+    u32 binlog_sites;
 } Logger;
 
 static Logger logger;
 
+// Sites outlive the logger, since their ids are stored in the sites themselves.
+static LogSite* sites[LOG_MAX_SITES];
+static _Atomic(u32) site_count;
+static Mutex site_lock;
+
+_Atomic(u8) log_module_limits[LOG_MAX_MODULES] = {UINT8_MAX, LOG_LEVEL_TRACE + 1};
+// Everything below is guarded by site_lock.
+static const char* module_names[LOG_MAX_MODULES];
+static u32 module_count = LOG_MODULE_OTHER + 1;
+static LogLevelRule level_rules[LOG_MAX_LEVEL_RULES];
+static u32 level_rule_count;
+static u8 default_level = LOG_LEVEL_TRACE;
+
+static _Thread_local SpscRing* thread_ring;
+static _Thread_local u32 thread_generation;
+
+static const char* LOG_LEVELS[5] = {"ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+
+static u64 format_line(char* buf, u64 size, LogLevel level, const char* file, u32 number,
+                       const char* message) {
+    // format: [LOG_LEVEL]: file:line: message
+    int length =
+        snprintf(buf, size, "[%s %s:%d]: %s\n", LOG_LEVELS[level], file, number, message);
+    return length < 0 ? 0 : ((u64)length < size ? (u64)length : size - 1);
+}
+
+static void print_console(const char* buf, LogLevel level) {
+    if (level <= LOG_LEVEL_ERROR) {
+        platform_eprintln(buf, (WriteColor)level);
+    } else {
+        platform_println(buf, (WriteColor)level);
+    }
+}
+
+static void write_file(File* file, const void* buf, u64 length) {
+    if (file->handle && length > 0) {
+        u64 bytes_written = 0;
+        if (!fs_write(file, length, buf, &bytes_written)) {
+            // Not logged, since that could wait on the writer that is reporting this.
+            platform_eprintln("Failed to write to log file\n", PRINT_COLOR_RED);
+        }
+    }
+}
+
+static void flush_console(LogBatch* batch) {
+    if (batch->console_length > 0) {
+        batch->console[batch->console_length] = 0;
+        print_console(batch->console, batch->console_level);
+        batch->console_length = 0;
+    }
+}
+
+static void flush_batch(LogBatch* batch) {
+    flush_console(batch);
+    write_file(&logger.handle, batch->file, batch->file_length);
+    batch->file_length = 0;
+}
+
+static void batch_record(LogBatch* batch, const LogRecord* record) {
+    char line[LOG_LINE_SIZE];
+    const char* message = record->overflow ? record->overflow : record->text;
+    u64 length = format_line(line, sizeof(line), record->level, record->file, record->line,
+                             message);
+    if (batch->console_level != record->level ||
+        batch->console_length + length >= LOG_BATCH_SIZE) {
+        flush_console(batch);
+        batch->console_level = record->level;
+    }
+    if (batch->file_length + length > LOG_BATCH_SIZE) {
+        write_file(&logger.handle, batch->file, batch->file_length);
+        batch->file_length = 0;
+    }
+    memcpy(batch->console + batch->console_length, line, length);
+    batch->console_length += length;
+    memcpy(batch->file + batch->file_length, line, length);
+    batch->file_length += length;
+    if (record->overflow) {
+        mem_free(record->overflow);
+    }
+}
+
+static void batch_binary(LogBatch* batch, const void* data, u64 size) {
+    if (batch->binary_length + size > LOG_BATCH_SIZE) {
+        write_file(&logger.binlog, batch->binary, batch->binary_length);
+        batch->binary_length = 0;
+    }
+    if (size > LOG_BATCH_SIZE) {
+        write_file(&logger.binlog, data, size);
+        return;
+    }
+    memcpy(batch->binary + batch->binary_length, data, size);
+    batch->binary_length += size;
+}
+
+static void batch_binary_string(LogBatch* batch, const char* text) {
+    u16 length = (u16)strlen(text);
+    batch_binary(batch, &length, sizeof(length));
+    batch_binary(batch, text, length);
+}
+
+// Writes the definitions of sites registered since the last call.
+static void batch_sites(LogBatch* batch) {
+    u32 count = atomic_load_explicit(&site_count, memory_order_acquire);
+    for (; logger.binlog_sites < count; logger.binlog_sites++) {
+        const LogSite* site = sites[logger.binlog_sites];
+        u8 kind = LOG_BINARY_SITE;
+        u32 id = logger.binlog_sites + 1;
+        batch_binary(batch, &kind, sizeof(kind));
+        batch_binary(batch, &id, sizeof(id));
+        batch_binary(batch, &site->level, sizeof(site->level));
+        batch_binary(batch, &site->line, sizeof(site->line));
+        batch_binary_string(batch, site->file);
+        batch_binary_string(batch, site->format);
+    }
+}
+
+static bool open_binlog(void) {
+    if (logger.binlog.handle) {
+        return true;
+    }
+    if (!fs_open("latest.binlog", OPEN_FILE_MODE_WRITE_BINARY, &logger.binlog)) {
+        // Not logged, for the same reason as in write_file.
+        platform_eprintln("Failed to open latest.binlog; logging as text\n", PRINT_COLOR_RED);
+        atomic_store(&logger.binary, false);
+        return false;
+    }
+    logger.binlog_sites = 0;
+    write_file(&logger.binlog, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_SIZE);
+    return true;
+}
+
+static void batch_capture(LogBatch* batch, const LogCapture* capture) {
+    if (capture->site == LOG_CAPTURE_TEXT) {
+        LogCapturedText text;
+        memcpy(&text, capture->args, sizeof(text));
+        LogRecord record;
+        record.file = text.file;
+        record.line = text.line;
+        record.level = text.level;
+        record.overflow = text.overflow;
+        snprintf(record.text, LOG_RECORD_TEXT, "%s", (const char*)capture->args + sizeof(text));
+        batch_record(batch, &record);
+        return;
+    }
+    const LogSite* site = sites[capture->site - 1];
+    if (site->level > LOG_LEVEL_WARN &&
+        atomic_load_explicit(&logger.binary, memory_order_relaxed) && open_binlog()) {
+        batch_sites(batch);
+        u8 kind = LOG_BINARY_EVENT;
+        batch_binary(batch, &kind, sizeof(kind));
+        batch_binary(batch, &capture->site, sizeof(capture->site));
+        batch_binary(batch, &capture->time, sizeof(capture->time));
+        batch_binary(batch, &capture->size, sizeof(capture->size));
+        batch_binary(batch, capture->args, capture->size);
+        return;
+    }
+    LogRecord record;
+    record.file = site->file;
+    record.line = site->line;
+    record.level = site->level;
+    record.overflow = 0;
+    u64 length = log_format_captured(record.text, LOG_RECORD_TEXT, site->format, capture->args,
+                                     capture->size);
+    if (length == LOG_RECORD_TEXT - 1) {
+        // Possibly truncated; strings alone can be up to LOG_CAPTURE_ARGS long.
+        u64 size = LOG_RECORD_TEXT + LOG_MAX_FORMAT + LOG_CAPTURE_ARGS * 4;
+        record.overflow = mem_alloc_tagged(size, MEM_TAG_LOG);
+        if (record.overflow) {
+            log_format_captured(record.overflow, size, site->format, capture->args, capture->size);
+        }
+    }
+    batch_record(batch, &record);
+}
+
+void logger_flush(void) {
+    if (!logger.queue.cells) {
+        return;
+    }
+    mutex_lock(&logger.write_lock);
+    LogRecord record;
+    while (mpmc_ring_pop(&logger.queue, &record)) {
+        batch_record(&logger.batch, &record);
+    }
+    LogCapture capture;
+    for (u32 i = 0; i < LOG_MAX_THREADS; i++) {
+        if (!atomic_load_explicit(&logger.ring_ready[i], memory_order_acquire)) {
+            continue;
+        }
+        while (spsc_ring_pop(&logger.rings[i], &capture)) {
+            batch_capture(&logger.batch, &capture);
+        }
+    }
+    flush_batch(&logger.batch);
+    write_file(&logger.binlog, logger.batch.binary, logger.batch.binary_length);
+    logger.batch.binary_length = 0;
+    mutex_unlock(&logger.write_lock);
+}
+
+void logger_set_binary(bool enabled) {
+    atomic_store(&logger.binary, enabled);
+}
+
+static void writer_main(void* arg) {
+    UNUSED(arg);
+    platform_thread_set_name("log writer");
+    while (atomic_load_explicit(&logger.running, memory_order_acquire)) {
+        event_wait_timeout(&logger.wake, LOG_FLUSH_INTERVAL);
+        event_reset(&logger.wake);
+        logger_flush();
+    }
+}
+
 bool logger_create(void) {
     if (!fs_open("latest.log", OPEN_FILE_MODE_WRITE, &logger.handle)) {
         ERROR("Failed to create/open log file: latest.log");
         return false;
     }
+    if (!mpmc_ring_create_typed(LogRecord, LOG_QUEUE_CAPACITY, &logger.queue)) {
+        ERROR("Failed to create the log queue; logging synchronously.");
+        return true;
+    }
+    atomic_fetch_add(&logger.generation, 1);
+    atomic_store(&logger.running, true);
+    if (!platform_thread_create(writer_main, 0, &logger.writer)) {
+        atomic_store(&logger.running, false);
+        mpmc_ring_destroy(&logger.queue);
+        ERROR("Failed to start the log writer; logging synchronously.");
+        return true;
+    }
     INFO("Logger initialized");
     return true;
 }
 
-void logger_log_file(const char* message) {
-    if (logger.handle.handle) {
-        u64 len = str_length(message);
-        u64 bytes_written = 0;
-        if (!fs_write(&logger.handle, len, message, &bytes_written)) {
-            ERROR("Failed to write to log file");
+void logger_destroy(void) {
+    if (atomic_load(&logger.running)) {
+        atomic_store(&logger.running, false);
+        event_set(&logger.wake);
+        platform_thread_join(&logger.writer);
+        logger_flush();
+        mpmc_ring_destroy(&logger.queue);
+        for (u32 i = 0; i < LOG_MAX_THREADS; i++) {
+            if (atomic_load(&logger.ring_ready[i])) {
+                atomic_store(&logger.ring_ready[i], false);
+                spsc_ring_destroy(&logger.rings[i]);
+            }
         }
+        atomic_store(&logger.ring_count, 0);
+    }
+    if (logger.binlog.handle) {
+        fs_close(&logger.binlog);
     }
+    fs_close(&logger.handle);
 }
 
-void logger_destroy(void) {}
+// Used before the writer runs and after it stopped.
+static void log_sync(LogLevel level, const char* file, u32 number, const char* message) {
+    char buf[LOG_LINE_SIZE];
+    u64 length = format_line(buf, sizeof(buf), level, file, number, message);
+    print_console(buf, level);
+    write_file(&logger.handle, buf, length);
+}
+
+// Returns the capture buffer of the calling thread, registering it on first use.
+static SpscRing* current_ring(void) {
+    u32 generation = atomic_load_explicit(&logger.generation, memory_order_relaxed);
+    if (thread_generation == generation) {
+        return thread_ring;
+    }
+    thread_generation = generation;
+    thread_ring = 0;
+    u32 slot = atomic_fetch_add(&logger.ring_count, 1);
+    if (slot < LOG_MAX_THREADS &&
+        spsc_ring_create_typed(LogCapture, LOG_THREAD_CAPACITY, &logger.rings[slot])) {
+        atomic_store_explicit(&logger.ring_ready[slot], true, memory_order_release);
+        thread_ring = &logger.rings[slot];
+    }
+    return thread_ring;
+}
+
+static void push_capture(SpscRing* ring, LogCapture* capture, LogLevel level) {
+    capture->time = platform_system_time();
+    while (!spsc_ring_push(ring, capture)) {
+        event_set(&logger.wake);
+        platform_thread_yield();
+    }
+    if (level <= LOG_LEVEL_WARN) {
+        event_set(&logger.wake);
+    }
+}
+
+// Formats the message into a capture, so that it keeps its place among the thread's others.
+static void capture_text(LogCapture* capture, LogLevel level, const char* file, u32 number,
+                         const char* message, va_list args) {
+    LogCapturedText text = {file, 0, number, (u8)level};
+    char* inline_text = (char*)capture->args + sizeof(text);
+    u64 room = LOG_CAPTURE_ARGS - sizeof(text);
+    va_list retry;
+    va_copy(retry, args);
+    int length = vsnprintf(inline_text, room, message, args);
+    if (length < 0) {
+        inline_text[0] = 0;
+        length = 0;
+    } else if ((u64)length >= room) {
+        text.overflow = mem_alloc_tagged((u64)length + 1, MEM_TAG_LOG);
+        if (text.overflow) {
+            vsnprintf(text.overflow, (u64)length + 1, message, retry);
+            inline_text[0] = 0;
+        }
+        length = text.overflow ? 0 : (int)room - 1;
+    }
+    va_end(retry);
+    memcpy(capture->args, &text, sizeof(text));
+    capture->site = LOG_CAPTURE_TEXT;
+    capture->size = (u16)(sizeof(text) + (u64)length + 1);
+}
+
+static void log_text(LogLevel level, const char* file, u32 number, const char* message,
+                     va_list args) {
+    LogRecord record;
+    if (!atomic_load_explicit(&logger.running, memory_order_acquire)) {
+        char fmt[LOG_LINE_SIZE];
+        vsnprintf(fmt, sizeof(fmt), message, args);
+        log_sync(level, file, number, fmt);
+        return;
+    }
+    SpscRing* ring = current_ring();
+    if (ring) {
+        LogCapture capture;
+        capture_text(&capture, level, file, number, message, args);
+        push_capture(ring, &capture, level);
+        return;
+    }
+    // Only threads without a capture buffer get here.
+    va_list retry;
+    va_copy(retry, args);
+    int length = vsnprintf(record.text, LOG_RECORD_TEXT, message, args);
+    record.overflow = 0;
+    if (length >= LOG_RECORD_TEXT) {
+        record.overflow = mem_alloc_tagged((u64)length + 1, MEM_TAG_LOG);
+        if (record.overflow) {
+            vsnprintf(record.overflow, (u64)length + 1, message, retry);
+        }
+    }
+    va_end(retry);
+    record.file = file;
+    record.line = number;
+    record.level = (u8)level;
+
+    while (!mpmc_ring_push(&logger.queue, &record)) {
+        // The writer is behind; waiting for it keeps every record, errors included.
+        event_set(&logger.wake);
+        platform_thread_yield();
+    }
+    if (level <= LOG_LEVEL_WARN) {
+        event_set(&logger.wake);
+    }
+}
 
 void logger_log(LogLevel level, const char* file, u32 number, const char* message, ...) {
-    const char* LOG_LEVELS[5] = {"ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
-    char fmt[4096];
     va_list args;
     va_start(args, message);
-    vsnprintf(fmt, 4096, message, args);
+    log_text(level, file, number, message, args);
     va_end(args);
+}
 
-    bool err = level <= LOG_LEVEL_ERROR;
-    char buf[4096];
-    // format: [LOG_LEVEL]: file:line: message
-    snprintf(buf, 4096, "[%s %s:%d]: %s\n", LOG_LEVELS[level], file, number, fmt);
-    if (err) {
-        platform_eprintln(buf, (WriteColor)level);
+// The level of the longest rule that is a prefix of `module`.
+static u8 module_level(const char* module) {
+    u8 level = default_level;
+    u64 longest = 0;
+    for (u32 i = 0; module && i < level_rule_count; i++) {
+        u64 length = strlen(level_rules[i].prefix);
+        if (length > longest && strncmp(module, level_rules[i].prefix, length) == 0) {
+            level = level_rules[i].level;
+            longest = length;
+        }
+    }
+    return level;
+}
+
+static u8 find_module(const char* module) {
+    for (u32 i = LOG_MODULE_OTHER + 1; i < module_count; i++) {
+        if (module_names[i] == module || strcmp(module_names[i], module) == 0) {
+            return (u8)i;
+        }
+    }
+    if (module_count == LOG_MAX_MODULES) {
+        return LOG_MODULE_OTHER;
+    }
+    module_names[module_count] = module;
+    atomic_store_explicit(&log_module_limits[module_count], module_level(module) + 1,
+                          memory_order_relaxed);
+    return (u8)module_count++;
+}
+
+void logger_set_level(const char* prefix, LogLevel level) {
+    mutex_lock(&site_lock);
+    bool stored = true;
+    if (prefix[0] == 0) {
+        default_level = (u8)level;
     } else {
-        platform_println(buf, (WriteColor)level);
+        u32 i = 0;
+        while (i < level_rule_count && strcmp(level_rules[i].prefix, prefix) != 0) {
+            i++;
+        }
+        stored = i < LOG_MAX_LEVEL_RULES && strlen(prefix) < LOG_RULE_PREFIX;
+        if (stored) {
+            strcpy(level_rules[i].prefix, prefix);
+            level_rules[i].level = (u8)level;
+            level_rule_count = i == level_rule_count ? i + 1 : level_rule_count;
+        }
+    }
+    for (u32 i = LOG_MODULE_OTHER; i < module_count; i++) {
+        atomic_store_explicit(&log_module_limits[i], module_level(module_names[i]) + 1,
+                              memory_order_relaxed);
+    }
+    mutex_unlock(&site_lock);
+    // Logged after unlocking, since registering this site takes the lock.
+    if (!stored) {
+        WARN("Can't set the log level of %s: too many rules or too long", prefix);
+    }
+}
+
+bool logger_register_module(LogSite* site, LogLevel level, const char* module) {
+    mutex_lock(&site_lock);
+    if (atomic_load_explicit(&site->module, memory_order_relaxed) == LOG_MODULE_PENDING) {
+        // Released so the macros see the module's limit with it.
+        atomic_store_explicit(&site->module, find_module(module), memory_order_release);
+    }
+    mutex_unlock(&site_lock);
+    return level < atomic_load_explicit(LOG_SITE_LIMIT(*site), memory_order_relaxed);
+}
+
+// Parses the format of a site the first time it logs. Returns its id.
+static u32 register_site(LogSite* site, LogLevel level, const char* file, u32 number,
+                         const char* message) {
+    mutex_lock(&site_lock);
+    u32 id = atomic_load_explicit(&site->id, memory_order_relaxed);
+    if (id == 0) {
+        u32 count = atomic_load_explicit(&site_count, memory_order_relaxed);
+        u32 arg_count = 0;
+        id = LOG_SITE_TEXT;
+        if (count < LOG_MAX_SITES && strlen(message) < LOG_MAX_FORMAT &&
+            log_format_signature(message, site->types, &arg_count)) {
+            site->format = message;
+            site->file = file;
+            site->line = number;
+            site->level = (u8)level;
+            site->arg_count = (u8)arg_count;
+            sites[count] = site;
+            id = count + 1;
+            atomic_store_explicit(&site_count, count + 1, memory_order_release);
+        }
+        atomic_store_explicit(&site->id, id, memory_order_release);
+    }
+    mutex_unlock(&site_lock);
+    return id;
+}
+
+static bool capture_bytes(LogCapture* capture, const void* value, u64 size) {
+    if (capture->size + size > LOG_CAPTURE_ARGS) {
+        return false;
     }
+    memcpy(capture->args + capture->size, value, size);
+    capture->size += (u16)size;
+    return true;
+}
+
+// Copies the arguments as log_format_captured reads them. Fails if they don't fit.
+static bool capture_args(const LogSite* site, va_list args, LogCapture* capture) {
+    capture->size = 0;
+    for (u32 i = 0; i < site->arg_count; i++) {
+        i32 int_value;
+        i64 long_value;
+        f64 double_value;
+        const char* string;
+        u16 length;
+        bool captured;
+        switch (site->types[i]) {
+        case LOG_ARG_INT:
+            int_value = va_arg(args, int);
+            captured = capture_bytes(capture, &int_value, sizeof(int_value));
+            break;
+        case LOG_ARG_DOUBLE:
+            double_value = va_arg(args, double);
+            captured = capture_bytes(capture, &double_value, sizeof(double_value));
+            break;
+        case LOG_ARG_LDOUBLE:
+            double_value = (f64)va_arg(args, long double);
+            captured = capture_bytes(capture, &double_value, sizeof(double_value));
+            break;
+        case LOG_ARG_STRING:
+            string = va_arg(args, const char*);
+            string = string ? string : "(null)";
+            for (length = 0; length < LOG_CAPTURE_ARGS && string[length]; length++) {
+            }
+            captured = capture_bytes(capture, &length, sizeof(length)) &&
+                       capture_bytes(capture, string, length);
+            break;
+        default:
+            switch (site->types[i]) {
+            case LOG_ARG_LONG:
+                long_value = va_arg(args, long);
+                break;
+            case LOG_ARG_LLONG:
+                long_value = va_arg(args, long long);
+                break;
+            case LOG_ARG_SIZE:
+                long_value = (i64)va_arg(args, size_t);
+                break;
+            case LOG_ARG_INTMAX:
+                long_value = va_arg(args, intmax_t);
+                break;
+            case LOG_ARG_PTRDIFF:
+                long_value = va_arg(args, ptrdiff_t);
+                break;
+            default:
+                long_value = (i64)(uintptr_t)va_arg(args, void*);
+                break;
+            }
+            captured = capture_bytes(capture, &long_value, sizeof(long_value));
+            break;
+        }
+        if (!captured) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    logger_log_file(buf);
+void logger_log_deferred(LogSite* site, LogLevel level, const char* file, u32 number,
+                         const char* message, ...) {
+    u32 id = atomic_load_explicit(&site->id, memory_order_acquire);
+    if (id == 0) {
+        id = register_site(site, level, file, number, message);
+    }
+    va_list args;
+    va_start(args, message);
+    SpscRing* ring = 0;
+    if (atomic_load_explicit(&logger.running, memory_order_acquire)) {
+        ring = current_ring();
+    }
+    if (!ring) {
+        log_text(level, file, number, message, args);
+        va_end(args);
+        return;
+    }
+    LogCapture capture;
+    va_list captured;
+    va_copy(captured, args);
+    // A site can only defer the format it was registered with.
+    if (id != LOG_SITE_TEXT && site->format == message &&
+        capture_args(site, captured, &capture)) {
+        capture.site = id;
+    } else {
+        capture_text(&capture, level, file, number, message, args);
+    }
+    va_end(captured);
+    va_end(args);
+    push_capture(ring, &capture, level);
 }
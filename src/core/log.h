@@ -1,7 +1,9 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include "core/log_format.h"
 #include "types.h"
+#include <stdatomic.h>
 
 typedef enum LogLevel {
     LOG_LEVEL_ERROR,
@@ -11,14 +13,115 @@ typedef enum LogLevel {
     LOG_LEVEL_TRACE,
 } LogLevel;
 
+/**
+ * Statements less severe than this compile to nothing, arguments included. Defaults to every
+ * level in debug builds and to INFO otherwise.
+ */
+#ifndef LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_TRACE
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+
+/**
+ * The module the statements of a file belong to, for logger_set_level. Defaults to the file's
+ * path; a file can `#define LOG_MODULE "tag"` before its includes to group itself instead.
+ */
+#ifndef LOG_MODULE
+#define LOG_MODULE __FILE__
+#endif
+
+#define LOG_MAX_MODULES 128
+
+/**
+ * Starts the writer thread. From then on logger_log only formats the message and queues it;
+ * the writer prints and writes queued records in batches, right away for warnings and errors
+ * and within a few milliseconds for the rest. Before creation and after destruction messages
+ * are written synchronously. Messages from one thread are written in the order it logged them,
+ * whichever path they took.
+ */
 bool logger_create(void);
+// Writes what is still queued and stops the writer. Other threads must have stopped logging.
 void logger_destroy(void);
-void logger_log(LogLevel level, const char* file, u32 number, const char* message, ...);
+// Formats on the calling thread. The macros below use logger_log_deferred instead.
+void logger_log(LogLevel level, const char* file, u32 number, const char* message, ...)
+    __attribute__((format(printf, 4, 5)));
+// Writes every queued record before returning, e.g. before the process aborts.
+void logger_flush(void);
+
+/**
+ * Instead of formatting INFO, DEBUG and TRACE messages, the writer appends them to
+ * latest.binlog in their captured form, which `make log_decode` builds a decoder for.
+ * Warnings and errors are still written as text.
+ */
+void logger_set_binary(bool enabled);
+
+/**
+ * Sets the most verbose level logged by modules starting with `prefix`, such as
+ * "src/renderer/" or a LOG_MODULE tag. The longest matching prefix wins and "" sets the level
+ * of everything else. Levels beyond LOG_MIN_LEVEL stay compiled out.
+ */
+void logger_set_level(const char* prefix, LogLevel level);
+
+// One past the most verbose level of each module, indexed by LogSite::module.
+extern _Atomic(u8) log_module_limits[LOG_MAX_MODULES];
+
+/**
+ * One per logging statement. The first message through a site parses its format string once
+ * and assigns the site an id; after that, messages only copy their raw arguments and the
+ * writer thread formats them.
+ */
+typedef struct LogSite {
+    // 0 until the site is registered.
+    _Atomic(u32) id;
+    // 0, whose limit lets everything through, until the site is first reached.
+    _Atomic(u8) module;
+    const char* format;
+    const char* file;
+    u32 line;
+    u8 level;
+    u8 arg_count;
+    u8 types[LOG_FORMAT_MAX_ARGS];
+} LogSite;
+
+/**
+ * Captures a timestamp and the raw arguments into the calling thread's log buffer. Messages
+ * that can't be captured, such as ones with long strings, are formatted as logger_log does
+ * and queued in the same buffer. `message` must be the same string for every call through a
+ * site.
+ */
+void logger_log_deferred(LogSite* site, LogLevel level, const char* file, u32 number,
+                         const char* message, ...) __attribute__((format(printf, 5, 6)));
+
+// Assigns a site its module the first time it is reached. Returns whether `level` is enabled.
+bool logger_register_module(LogSite* site, LogLevel level, const char* module);
+
+/**
+ * Filtered statements cost one branch on their module's level and evaluate no arguments. A
+ * site without a module yet passes the branch and is filtered by logger_register_module.
+ */
+#define LOG_ENABLED(site, level)                                                               \
+    ((level) <= LOG_MIN_LEVEL &&                                                               \
+     (level) < atomic_load_explicit(LOG_SITE_LIMIT(site), memory_order_relaxed))
+#define LOG_SITE_LIMIT(site)                                                                   \
+    &log_module_limits[atomic_load_explicit(&(site).module, memory_order_acquire)]
+
+#define LOG_DEFERRED(level, ...)                                                               \
+    do {                                                                                       \
+        static LogSite log_site_;                                                              \
+        if (LOG_ENABLED(log_site_, level) &&                                                   \
+            (atomic_load_explicit(&log_site_.module, memory_order_relaxed) != 0 ||             \
+             logger_register_module(&log_site_, level, LOG_MODULE))) {                         \
+            logger_log_deferred(&log_site_, level, __FILE__, __LINE__, __VA_ARGS__);           \
+        }                                                                                      \
+    } while (0)
 
-#define ERROR(...) logger_log(LOG_LEVEL_ERROR, __FILE__, __LINE__, __VA_ARGS__);
-#define WARN(...) logger_log(LOG_LEVEL_WARN, __FILE__, __LINE__, __VA_ARGS__)
-#define INFO(...) logger_log(LOG_LEVEL_INFO, __FILE__, __LINE__, __VA_ARGS__);
-#define DEBUG(...) logger_log(LOG_LEVEL_DEBUG, __FILE__, __LINE__, __VA_ARGS__);
-#define TRACE(...) logger_log(LOG_LEVEL_TRACE, __FILE__, __LINE__, __VA_ARGS__);
+#define ERROR(...) LOG_DEFERRED(LOG_LEVEL_ERROR, __VA_ARGS__);
+#define WARN(...) LOG_DEFERRED(LOG_LEVEL_WARN, __VA_ARGS__)
+#define INFO(...) LOG_DEFERRED(LOG_LEVEL_INFO, __VA_ARGS__);
+#define DEBUG(...) LOG_DEFERRED(LOG_LEVEL_DEBUG, __VA_ARGS__);
+#define TRACE(...) LOG_DEFERRED(LOG_LEVEL_TRACE, __VA_ARGS__);
 
 #endif
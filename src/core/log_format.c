@@ -0,0 +1,280 @@
+#include "log_format.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Longest conversion specification that is formatted, e.g. "%-#012.6llx".
+#define LOG_SPEC_SIZE 32
+
+typedef struct LogSpec {
+    // Offset of the '%' and length through the conversion character.
+    u64 start;
+    u64 length;
+    u8 type;
+    // `*` widths and precisions, each taking an int argument before the value.
+    u8 stars;
+} LogSpec;
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Finds the next conversion at or after `*offset`. Returns false at the end of the format.
+static bool next_spec(const char* format, u64* offset, LogSpec* spec) {
+    const char* percent = strchr(format + *offset, '%');
+    if (!percent) {
+        return false;
+    }
+    const char* c = percent + 1;
+    spec->start = (u64)(percent - format);
+    spec->stars = 0;
+    spec->type = LOG_ARG_NONE;
+    if (*c == '%') {
+        spec->length = 2;
+        *offset = spec->start + 2;
+        return true;
+    }
+    while (*c && strchr("-+ #0'", *c)) {
+        c++;
+    }
+    if (*c == '*') {
+        spec->stars++;
+        c++;
+    }
+    while (is_digit(*c)) {
+        c++;
+    }
+    bool precision = *c == '.';
+    if (precision) {
+        c++;
+        if (*c == '*') {
+            spec->stars++;
+            c++;
+        }
+        while (is_digit(*c)) {
+            c++;
+        }
+    }
+    u32 longs = 0;
+    char modifier = 0;
+    if (*c == 'h') {
+        c += c[1] == 'h' ? 2 : 1;
+    } else if (*c == 'l') {
+        longs = c[1] == 'l' ? 2 : 1;
+        c += longs;
+    } else if (*c && strchr("zjtL", *c)) {
+        modifier = *c++;
+    }
+    switch (*c) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+        if (longs == 1) {
+            spec->type = LOG_ARG_LONG;
+        } else if (longs == 2) {
+            spec->type = LOG_ARG_LLONG;
+        } else if (modifier == 'z') {
+            spec->type = LOG_ARG_SIZE;
+        } else if (modifier == 'j') {
+            spec->type = LOG_ARG_INTMAX;
+        } else if (modifier == 't') {
+            spec->type = LOG_ARG_PTRDIFF;
+        } else {
+            spec->type = LOG_ARG_INT;
+        }
+        break;
+    case 'c':
+        spec->type = longs ? LOG_ARG_INVALID : LOG_ARG_INT;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->type = modifier == 'L' ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+        break;
+    case 's':
+        // With a precision the string needn't be terminated, so its length isn't known here.
+        spec->type = longs || precision ? LOG_ARG_INVALID : LOG_ARG_STRING;
+        break;
+    case 'p':
+        spec->type = LOG_ARG_POINTER;
+        break;
+    default:
+        spec->type = LOG_ARG_INVALID;
+        break;
+    }
+    spec->length = *c ? (u64)(c + 1 - percent) : (u64)(c - percent);
+    *offset = spec->start + spec->length;
+    return true;
+}
+
+bool log_format_signature(const char* format, u8* types, u32* count) {
+    u64 offset = 0;
+    LogSpec spec;
+    *count = 0;
+    while (next_spec(format, &offset, &spec)) {
+        if (spec.type == LOG_ARG_INVALID || *count + spec.stars + 1 > LOG_FORMAT_MAX_ARGS) {
+            return false;
+        }
+        for (u32 i = 0; i < spec.stars; i++) {
+            types[(*count)++] = LOG_ARG_INT;
+        }
+        if (spec.type != LOG_ARG_NONE) {
+            types[(*count)++] = spec.type;
+        }
+    }
+    return true;
+}
+
+typedef struct ArgReader {
+    const u8* data;
+    u64 size;
+    u64 offset;
+} ArgReader;
+
+static bool read_bytes(ArgReader* reader, void* value, u64 bytes) {
+    if (reader->offset + bytes > reader->size) {
+        return false;
+    }
+    memcpy(value, reader->data + reader->offset, bytes);
+    reader->offset += bytes;
+    return true;
+}
+
+static void append(char* out, u64 size, u64* length, const char* text, u64 text_length) {
+    u64 room = size - 1 - *length;
+    u64 copied = text_length < room ? text_length : room;
+    memcpy(out + *length, text, copied);
+    *length += copied;
+}
+
+/**
+ * Rewrites the specification with its `*` fields replaced by the captured ints, so it can be
+ * passed to snprintf with the value alone. A negative `*` precision means none was given.
+ */
+static bool expand_spec(const char* format, const LogSpec* spec, ArgReader* args,
+                        char* expanded) {
+    u64 length = 0;
+    bool precision = false;
+    for (u64 i = 0; i < spec->length; i++) {
+        char c = format[spec->start + i];
+        if (c == '.') {
+            precision = true;
+        }
+        if (c != '*') {
+            if (length + 1 >= LOG_SPEC_SIZE) {
+                return false;
+            }
+            expanded[length++] = c;
+            continue;
+        }
+        i32 value;
+        if (!read_bytes(args, &value, sizeof(value))) {
+            return false;
+        }
+        if (precision && value < 0) {
+            // Drops the '.' written just before.
+            length--;
+            continue;
+        }
+        int written = snprintf(expanded + length, LOG_SPEC_SIZE - length, "%d", value);
+        if (written < 0 || length + (u64)written >= LOG_SPEC_SIZE) {
+            return false;
+        }
+        length += (u64)written;
+    }
+    expanded[length] = 0;
+    return true;
+}
+
+static int format_value(char* out, u64 size, const char* spec, u8 type, ArgReader* args) {
+    i32 int_value;
+    i64 long_value;
+    f64 double_value;
+    u16 string_length;
+    // Strings are bounded by the record they were captured into.
+    char string[1024];
+    switch (type) {
+    case LOG_ARG_INT:
+        return read_bytes(args, &int_value, sizeof(int_value))
+                   ? snprintf(out, size, spec, (int)int_value)
+                   : -1;
+    case LOG_ARG_DOUBLE:
+    case LOG_ARG_LDOUBLE:
+        if (!read_bytes(args, &double_value, sizeof(double_value))) {
+            return -1;
+        }
+        return type == LOG_ARG_DOUBLE ? snprintf(out, size, spec, double_value)
+                                      : snprintf(out, size, spec, (long double)double_value);
+    case LOG_ARG_STRING:
+        if (!read_bytes(args, &string_length, sizeof(string_length)) ||
+            string_length >= sizeof(string) || !read_bytes(args, string, string_length)) {
+            return -1;
+        }
+        string[string_length] = 0;
+        return snprintf(out, size, spec, string);
+    default:
+        break;
+    }
+    if (!read_bytes(args, &long_value, sizeof(long_value))) {
+        return -1;
+    }
+    switch (type) {
+    case LOG_ARG_LONG:
+        return snprintf(out, size, spec, (long)long_value);
+    case LOG_ARG_LLONG:
+        return snprintf(out, size, spec, (long long)long_value);
+    case LOG_ARG_SIZE:
+        return snprintf(out, size, spec, (size_t)long_value);
+    case LOG_ARG_INTMAX:
+        return snprintf(out, size, spec, (intmax_t)long_value);
+    case LOG_ARG_PTRDIFF:
+        return snprintf(out, size, spec, (ptrdiff_t)long_value);
+    case LOG_ARG_POINTER:
+        return snprintf(out, size, spec, (void*)(uintptr_t)long_value);
+    default:
+        return -1;
+    }
+}
+
+u64 log_format_captured(char* out, u64 size, const char* format, const u8* args,
+                        u64 args_size) {
+    if (size == 0) {
+        return 0;
+    }
+    ArgReader reader = {args, args_size, 0};
+    u64 length = 0;
+    u64 offset = 0;
+    u64 literal = 0;
+    LogSpec spec;
+    while (next_spec(format, &offset, &spec)) {
+        append(out, size, &length, format + literal, spec.start - literal);
+        literal = offset;
+        if (spec.type == LOG_ARG_NONE) {
+            append(out, size, &length, "%", 1);
+            continue;
+        }
+        char expanded[LOG_SPEC_SIZE];
+        if (spec.type == LOG_ARG_INVALID || !expand_spec(format, &spec, &reader, expanded)) {
+            out[0] = 0;
+            return 0;
+        }
+        int written = format_value(out + length, size - length, expanded, spec.type, &reader);
+        if (written < 0) {
+            out[0] = 0;
+            return 0;
+        }
+        length += (u64)written < size - length ? (u64)written : size - 1 - length;
+    }
+    append(out, size, &length, format + literal, strlen(format + literal));
+    out[length] = 0;
+    return length;
+}
@@ -0,0 +1,58 @@
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include "types.h"
+
+/**
+ * printf-style formatting split in two halves: the logging thread only copies the raw
+ * arguments of a message, and the writer thread or the offline decoder turns them into text
+ * later. This file has no dependencies on the rest of the engine so the decoder can build it.
+ */
+
+#define LOG_FORMAT_MAX_ARGS 16
+
+// How an argument is read from a va_list and stored in a captured record.
+typedef enum LogArgType {
+    LOG_ARG_NONE = 0,
+    // Stored in 4 bytes: everything that promotes to int.
+    LOG_ARG_INT,
+    // Stored in 8 bytes.
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_INTMAX,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_POINTER,
+    LOG_ARG_DOUBLE,
+    // Captured as a double.
+    LOG_ARG_LDOUBLE,
+    // A u16 length followed by the characters, without terminator.
+    LOG_ARG_STRING,
+    // Conversions that can't be deferred, such as %n, wide strings or strings with a precision.
+    LOG_ARG_INVALID,
+} LogArgType;
+
+/**
+ * latest.binlog layout, in native byte order: the magic, then records that each start with a
+ * u8 kind. A site record (u32 id, u8 level, u32 line, u16 length + file, u16 length + format)
+ * precedes the first event of its site. An event record is a u32 site id, f64 timestamp in
+ * seconds and u16 length + captured arguments.
+ */
+#define LOG_BINARY_MAGIC "VKLOG001"
+#define LOG_BINARY_MAGIC_SIZE 8
+#define LOG_BINARY_SITE 1
+#define LOG_BINARY_EVENT 2
+
+/**
+ * Argument types `format` consumes, in order, including the ints of `*` widths and precisions.
+ * Returns false if the format has a conversion that can't be deferred or too many arguments.
+ */
+bool log_format_signature(const char* format, u8* types, u32* count);
+
+/**
+ * Formats `format` with captured arguments into `out`, always null terminated. Returns the
+ * length written, or 0 if the arguments don't match the format.
+ */
+u64 log_format_captured(char* out, u64 size, const char* format, const u8* args, u64 args_size);
+
+#endif
@@ -1,18 +1,143 @@
 #include "mem.h"
+#include "core/log.h"
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 
+// Stored in front of every block. 16 bytes keep the block as aligned as malloc returned it.
+typedef struct MemHeader {
+    u64 size;
+    u32 tag;
+    u32 pad_0;
+} MemHeader;
+
+typedef struct MemCounters {
+    _Atomic(u64) live_bytes;
+    _Atomic(u64) peak_bytes;
+    _Atomic(u64) allocations;
+    _Atomic(u64) frees;
+    _Atomic(u64) pooled_bytes;
+} MemCounters;
+
+// One slot per tag plus the total in the last slot.
+static MemCounters counters[MEM_TAG_COUNT + 1];
+
+static const char* tag_names[MEM_TAG_COUNT] = {
+    "unknown",  "vector",   "hashmap",  "ring",    "job",   "log",
+    "profiler", "file",     "platform", "renderer", "texture", "chunk",
+};
+
+static void counters_add(MemCounters* counters, u64 bytes) {
+    u64 live = atomic_fetch_add_explicit(&counters->live_bytes, bytes, memory_order_relaxed);
+    live += bytes;
+    atomic_fetch_add_explicit(&counters->allocations, 1, memory_order_relaxed);
+    u64 peak = atomic_load_explicit(&counters->peak_bytes, memory_order_relaxed);
+    while (live > peak && !atomic_compare_exchange_weak_explicit(&counters->peak_bytes, &peak,
+                                                                  live, memory_order_relaxed,
+                                                                  memory_order_relaxed)) {
+    }
+}
+
+static void counters_remove(MemCounters* counters, u64 bytes) {
+    atomic_fetch_sub_explicit(&counters->live_bytes, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->frees, 1, memory_order_relaxed);
+}
+
+static void counters_read(MemCounters* counters, MemStats* out) {
+    out->live_bytes = atomic_load_explicit(&counters->live_bytes, memory_order_relaxed);
+    out->peak_bytes = atomic_load_explicit(&counters->peak_bytes, memory_order_relaxed);
+    out->allocations = atomic_load_explicit(&counters->allocations, memory_order_relaxed);
+    out->frees = atomic_load_explicit(&counters->frees, memory_order_relaxed);
+    out->pooled_bytes = atomic_load_explicit(&counters->pooled_bytes, memory_order_relaxed);
+}
+
 void* mem_alloc(u64 bytes) {
-    return malloc(bytes);
-    //
+    return mem_alloc_tagged(bytes, MEM_TAG_UNKNOWN);
+}
+
+void* mem_alloc_tagged(u64 bytes, MemTag tag) {
+    if (tag >= MEM_TAG_COUNT) {
+        tag = MEM_TAG_UNKNOWN;
+    }
+    MemHeader* header = malloc(sizeof(MemHeader) + bytes);
+    if (!header) {
+        return 0;
+    }
+    header->size = bytes;
+    header->tag = tag;
+    counters_add(&counters[tag], bytes);
+    counters_add(&counters[MEM_TAG_COUNT], bytes);
+    return header + 1;
 }
 
 void mem_free(void* block) {
-    free(block);
-    //
+    if (!block) {
+        return;
+    }
+    MemHeader* header = (MemHeader*)block - 1;
+    counters_remove(&counters[header->tag], header->size);
+    counters_remove(&counters[MEM_TAG_COUNT], header->size);
+    free(header);
+}
+
+void* allocator_alloc(const Allocator* allocator, u64 bytes, MemTag tag) {
+    if (allocator && allocator->alloc) {
+        return allocator->alloc(allocator->context, bytes);
+    }
+    return mem_alloc_tagged(bytes, tag);
+}
+
+void allocator_free(const Allocator* allocator, void* block) {
+    if (!allocator || !allocator->alloc) {
+        mem_free(block);
+    } else if (allocator->free) {
+        allocator->free(allocator->context, block);
+    }
 }
 
-void mem_copy(void* dest, void* src, u64 bytes) {
+void mem_copy(void* dest, const void* src, u64 bytes) {
     memcpy(dest, src, bytes);
     //
 }
+
+void mem_pool_track(MemTag tag, i64 bytes) {
+    if (tag >= MEM_TAG_COUNT) {
+        tag = MEM_TAG_UNKNOWN;
+    }
+    // Wraps around for negative deltas, which subtracts.
+    atomic_fetch_add_explicit(&counters[tag].pooled_bytes, (u64)bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters[MEM_TAG_COUNT].pooled_bytes, (u64)bytes,
+                              memory_order_relaxed);
+}
+
+const char* mem_tag_name(MemTag tag) {
+    return tag < MEM_TAG_COUNT ? tag_names[tag] : "invalid";
+}
+
+void mem_stats(MemTag tag, MemStats* out) {
+    counters_read(&counters[tag < MEM_TAG_COUNT ? tag : MEM_TAG_UNKNOWN], out);
+}
+
+void mem_stats_total(MemStats* out) {
+    counters_read(&counters[MEM_TAG_COUNT], out);
+}
+
+static void report_line(const char* name, const MemStats* stats) {
+    INFO("%-10s %12.1f KiB live %12.1f KiB peak %10llu allocs %10llu live blocks %12.1f KiB "
+         "pooled",
+         name, stats->live_bytes / 1024.0, stats->peak_bytes / 1024.0, stats->allocations,
+         stats->allocations - stats->frees, stats->pooled_bytes / 1024.0);
+}
+
+void mem_report(void) {
+    INFO("Memory usage by tag:");
+    MemStats stats;
+    for (u32 tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        mem_stats(tag, &stats);
+        if (stats.allocations > 0) {
+            report_line(tag_names[tag], &stats);
+        }
+    }
+    mem_stats_total(&stats);
+    report_line("total", &stats);
+}
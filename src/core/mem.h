@@ -3,7 +3,74 @@
 
 #include "types.h"
 
+/**
+ * Subsystem an allocation is accounted to. Every allocation carries exactly one tag.
+ */
+typedef enum MemTag {
+    MEM_TAG_UNKNOWN,
+    MEM_TAG_VECTOR,
+    MEM_TAG_HASHMAP,
+    MEM_TAG_RING,
+    MEM_TAG_JOB,
+    MEM_TAG_LOG,
+    MEM_TAG_PROFILER,
+    MEM_TAG_FILE,
+    MEM_TAG_PLATFORM,
+    MEM_TAG_RENDERER,
+    MEM_TAG_TEXTURE,
+    MEM_TAG_CHUNK,
+    MEM_TAG_COUNT,
+} MemTag;
+
+typedef struct MemStats {
+    u64 live_bytes;
+    u64 peak_bytes;
+    // Totals since startup; their difference is the number of live blocks.
+    u64 allocations;
+    u64 frees;
+    // Bytes of objects handed out by pools, out of the live bytes of their slabs.
+    u64 pooled_bytes;
+} MemStats;
+
+/**
+ * Source of memory for containers that can live outside the heap, like arenas and pools. A
+ * zeroed allocator stands for the tagged heap. `free` may be left 0 by allocators that
+ * release everything at once.
+ */
+typedef struct Allocator {
+    void* (*alloc)(void* context, u64 bytes);
+    void (*free)(void* context, void* block);
+    void* context;
+} Allocator;
+
+// Untagged allocations are accounted to MEM_TAG_UNKNOWN.
 void* mem_alloc(u64 bytes);
+void* mem_alloc_tagged(u64 bytes, MemTag tag);
+// Accepts any block returned by the functions above; the tag is stored with the block.
 void mem_free(void* block);
-void mem_copy(void* dest, void* src, u64 bytes);
+// Allocates from `allocator`, or from the heap under `tag` when it is 0 or zeroed.
+void* allocator_alloc(const Allocator* allocator, u64 bytes, MemTag tag);
+void allocator_free(const Allocator* allocator, void* block);
+
+void mem_copy(void* dest, const void* src, u64 bytes);
+
+// Adjusts the pooled bytes of a tag; used by allocators that sub-allocate tagged blocks.
+void mem_pool_track(MemTag tag, i64 bytes);
+
+const char* mem_tag_name(MemTag tag);
+
+/**
+ * Reads the counters of one tag. They are updated without locks, so the fields of a snapshot
+ * taken while other threads allocate may be slightly out of step with each other.
+ */
+void mem_stats(MemTag tag, MemStats* out);
+
+// Counters across every tag. The peak is the peak of the total, not the sum of tag peaks.
+void mem_stats_total(MemStats* out);
+
+/**
+ * Logs live bytes, peak bytes and allocation counts for every tag that has been used.
+ */
+void mem_report(void);
+
 #endif
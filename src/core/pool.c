@@ -0,0 +1,263 @@
+#include "pool.h"
+#include "core/log.h"
+#include "platform/platform.h"
+#include <string.h>
+
+#define POOL_POISON_BYTE 0xDD
+// Fresh objects get a different pattern, so freeing one is never mistaken for a double free.
+#define POOL_ALLOCATED_BYTE 0xCD
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void lock(Pool* pool) {
+    while (atomic_flag_test_and_set_explicit(&pool->lock, memory_order_acquire)) {
+        platform_cpu_relax();
+    }
+}
+
+static void unlock(Pool* pool) {
+    atomic_flag_clear_explicit(&pool->lock, memory_order_release);
+}
+
+// The first pointer of a free object links to the next one; the poison covers the rest.
+static void poison(const Pool* pool, void* object) {
+    memset((u8*)object + sizeof(void*), POOL_POISON_BYTE, pool->object_size - sizeof(void*));
+}
+
+static bool poison_intact(const Pool* pool, const void* object) {
+    const u8* bytes = object;
+    for (u64 i = sizeof(void*); i < pool->object_size; i++) {
+        if (bytes[i] != POOL_POISON_BYTE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks that a free object is still poisoned before it is handed out.
+static void hand_out(const Pool* pool, void* object) {
+    if (pool->flags & POOL_FLAG_POISON) {
+        if (!poison_intact(pool, object)) {
+            ERROR("Pool object %p was written after being freed", object);
+        }
+        memset(object, POOL_ALLOCATED_BYTE, pool->object_size);
+    }
+}
+
+// Poisons an object being freed. Returns false, leaving it alone, if it was already free.
+static bool take_back(const Pool* pool, void* object) {
+    if (pool->flags & POOL_FLAG_POISON) {
+        // A live object could hold the whole pattern by chance, but not unless it was written
+        // that way.
+        if (poison_intact(pool, object)) {
+            ERROR("Pool object %p was freed twice", object);
+            return false;
+        }
+        poison(pool, object);
+    }
+    return true;
+}
+
+bool pool_create(u64 object_size, u64 alignment, u32 objects_per_slab, MemTag tag, u32 flags,
+                 Pool* pool) {
+    if (objects_per_slab == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        ERROR("Pools need at least one object per slab and a power of two alignment.");
+        return false;
+    }
+    if (alignment < _Alignof(void*)) {
+        alignment = _Alignof(void*);
+    }
+    // Free objects must hold the list link.
+    pool->object_size = align_up(object_size < sizeof(void*) ? sizeof(void*) : object_size,
+                                 alignment);
+    pool->alignment = alignment;
+    pool->objects_per_slab = objects_per_slab;
+    pool->tag = tag;
+    // An object no larger than the link has no room left for the pattern.
+    pool->flags = pool->object_size > sizeof(void*) ? flags : flags & ~POOL_FLAG_POISON;
+    atomic_flag_clear(&pool->lock);
+    pool->free_list = 0;
+    pool->slabs = 0;
+    pool->slab_count = 0;
+    pool->live_count = 0;
+    return true;
+}
+
+void pool_destroy(Pool* pool) {
+    if (pool->live_count > 0) {
+        WARN("Destroying a pool with %llu live objects", pool->live_count);
+        mem_pool_track(pool->tag, -(i64)(pool->live_count * pool->object_size));
+    }
+    PoolSlab* slab = pool->slabs;
+    while (slab) {
+        PoolSlab* next = slab->next;
+        mem_free(slab->block);
+        slab = next;
+    }
+    pool->slabs = 0;
+    pool->free_list = 0;
+    pool->slab_count = 0;
+    pool->live_count = 0;
+}
+
+static bool grow(Pool* pool) {
+    u64 header = align_up(sizeof(PoolSlab), pool->alignment);
+    // mem_alloc only guarantees 16 bytes, anything stricter is aligned by hand.
+    u64 slack = pool->alignment > 16 ? pool->alignment : 0;
+    u64 bytes = slack + header + pool->object_size * pool->objects_per_slab;
+    u8* block = mem_alloc_tagged(bytes, pool->tag);
+    if (!block) {
+        return false;
+    }
+    PoolSlab* slab = (PoolSlab*)align_up((u64)block, pool->alignment);
+    slab->block = block;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->slab_count++;
+
+    // Pushed in reverse so objects are handed out in address order.
+    u8* objects = (u8*)slab + header;
+    for (u32 i = pool->objects_per_slab; i-- > 0;) {
+        void* object = objects + pool->object_size * i;
+        if (pool->flags & POOL_FLAG_POISON) {
+            poison(pool, object);
+        }
+        *(void**)object = pool->free_list;
+        pool->free_list = object;
+    }
+    return true;
+}
+
+// Pops up to `count` objects with the lock held. They are still poisoned.
+static u32 take(Pool* pool, void** objects, u32 count) {
+    u32 taken = 0;
+    while (taken < count) {
+        if (!pool->free_list && !grow(pool)) {
+            break;
+        }
+        void* object = pool->free_list;
+        pool->free_list = *(void**)object;
+        objects[taken++] = object;
+    }
+    pool->live_count += taken;
+    return taken;
+}
+
+/**
+ * Pushes objects back with the lock held. Objects from a cache were taken back when they were
+ * cached; others are taken back here. Returns how many objects were accepted.
+ */
+static u32 give(Pool* pool, void** objects, u32 count, bool cached) {
+    u32 given = 0;
+    for (u32 i = 0; i < count; i++) {
+        void* object = objects[i];
+        if (!cached && !take_back(pool, object)) {
+            continue;
+        }
+        *(void**)object = pool->free_list;
+        pool->free_list = object;
+        given++;
+    }
+    pool->live_count -= given;
+    return given;
+}
+
+void* pool_alloc(Pool* pool) {
+    void* object = 0;
+    lock(pool);
+    u32 taken = take(pool, &object, 1);
+    unlock(pool);
+    if (taken > 0) {
+        hand_out(pool, object);
+        mem_pool_track(pool->tag, (i64)pool->object_size);
+    }
+    return object;
+}
+
+void pool_free(Pool* pool, void* object) {
+    if (!object) {
+        return;
+    }
+    lock(pool);
+    u32 given = give(pool, &object, 1, false);
+    unlock(pool);
+    if (given > 0) {
+        mem_pool_track(pool->tag, -(i64)pool->object_size);
+    }
+}
+
+u64 pool_capacity(const Pool* pool) {
+    return (u64)pool->slab_count * pool->objects_per_slab;
+}
+
+static void* pool_allocator_alloc(void* context, u64 bytes) {
+    Pool* pool = context;
+    if (bytes > pool->object_size) {
+        ERROR("Pool objects are %llu bytes, %llu were requested", pool->object_size, bytes);
+        return 0;
+    }
+    return pool_alloc(pool);
+}
+
+static void pool_allocator_free(void* context, void* block) {
+    pool_free(context, block);
+}
+
+Allocator pool_allocator(Pool* pool) {
+    Allocator allocator = {0};
+    allocator.alloc = pool_allocator_alloc;
+    allocator.free = pool_allocator_free;
+    allocator.context = pool;
+    return allocator;
+}
+
+void pool_cache_create(Pool* pool, PoolCache* cache) {
+    cache->pool = pool;
+    cache->count = 0;
+}
+
+/**
+ * Cached objects count as live for the pool, but only handed out ones as pooled bytes. They
+ * are kept poisoned, so the cache catches double frees too.
+ */
+void* pool_cache_alloc(PoolCache* cache) {
+    if (cache->count == 0) {
+        lock(cache->pool);
+        cache->count = take(cache->pool, cache->objects, POOL_CACHE_SIZE / 2);
+        unlock(cache->pool);
+        if (cache->count == 0) {
+            return 0;
+        }
+    }
+    void* object = cache->objects[--cache->count];
+    hand_out(cache->pool, object);
+    mem_pool_track(cache->pool->tag, (i64)cache->pool->object_size);
+    return object;
+}
+
+void pool_cache_free(PoolCache* cache, void* object) {
+    if (!object || !take_back(cache->pool, object)) {
+        return;
+    }
+    mem_pool_track(cache->pool->tag, -(i64)cache->pool->object_size);
+    if (cache->count == POOL_CACHE_SIZE) {
+        u32 keep = POOL_CACHE_SIZE / 2;
+        lock(cache->pool);
+        give(cache->pool, &cache->objects[keep], POOL_CACHE_SIZE - keep, true);
+        unlock(cache->pool);
+        cache->count = keep;
+    }
+    cache->objects[cache->count++] = object;
+}
+
+void pool_cache_flush(PoolCache* cache) {
+    if (cache->count == 0) {
+        return;
+    }
+    lock(cache->pool);
+    give(cache->pool, cache->objects, cache->count, true);
+    unlock(cache->pool);
+    cache->count = 0;
+}
@@ -0,0 +1,84 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "core/mem.h"
+#include "types.h"
+#include <stdatomic.h>
+
+// Objects a cache holds before it returns half of them to the pool.
+#define POOL_CACHE_SIZE 32
+
+typedef enum PoolFlags {
+    POOL_FLAG_NONE = 0,
+    // Fills free objects with a pattern and checks it on allocation, which catches writes
+    // after free and double frees at the cost of touching every byte.
+    POOL_FLAG_POISON = 1 << 0,
+} PoolFlags;
+
+typedef struct PoolSlab {
+    struct PoolSlab* next;
+    // Start of the allocation, which may precede the slab when objects need more alignment.
+    void* block;
+} PoolSlab;
+
+/**
+ * Fixed-size object allocator. Free objects form an intrusive list threaded through their
+ * own storage, so alloc and free are O(1) and never touch the general heap once enough slabs
+ * exist. Slabs are only returned when the pool is destroyed.
+ *
+ * The pool is guarded by a spinlock. Threads that allocate at high rates should go through
+ * their own PoolCache, which takes the lock once per batch.
+ */
+typedef struct Pool {
+    u64 object_size;
+    u64 alignment;
+    u32 objects_per_slab;
+    MemTag tag;
+    u32 flags;
+    atomic_flag lock;
+    void* free_list;
+    PoolSlab* slabs;
+    u32 slab_count;
+    u64 live_count;
+} Pool;
+
+/**
+ * A per-thread stash of free objects taken from one pool.
+ */
+typedef struct PoolCache {
+    Pool* pool;
+    u32 count;
+    void* objects[POOL_CACHE_SIZE];
+} PoolCache;
+
+/**
+ * Slabs are allocated under `tag`, and the bytes of live objects are reported as pooled bytes
+ * of that tag, so mem_report shows how full the pools are.
+ */
+bool pool_create(u64 object_size, u64 alignment, u32 objects_per_slab, MemTag tag, u32 flags,
+                 Pool* pool);
+// Every cache of the pool must be flushed first.
+void pool_destroy(Pool* pool);
+
+#define pool_create_typed(type, objects_per_slab, tag, flags, pool)                                \
+    pool_create(sizeof(type), _Alignof(type), objects_per_slab, tag, flags, pool)
+
+// Returns uninitialized storage, or 0 when a new slab can't be allocated.
+void* pool_alloc(Pool* pool);
+void pool_free(Pool* pool, void* object);
+
+#define pool_new(pool, type) ((type*)pool_alloc(pool))
+
+// Objects that fit in the current slabs without growing.
+u64 pool_capacity(const Pool* pool);
+
+// Hands out whole objects; requests larger than the object size fail.
+Allocator pool_allocator(Pool* pool);
+
+void pool_cache_create(Pool* pool, PoolCache* cache);
+void* pool_cache_alloc(PoolCache* cache);
+void pool_cache_free(PoolCache* cache, void* object);
+// Returns every cached object to the pool. Must be called before the owning thread exits.
+void pool_cache_flush(PoolCache* cache);
+
+#endif
@@ -0,0 +1,273 @@
+#include "profiler.h"
+#include "core/log.h"
+#include "core/mem.h"
+#include "platform/fs.h"
+#include "platform/platform.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROFILE_THREAD_NAME 32
+#define PROFILE_EXPORT_BUFFER (64 * 1024)
+// Room for one event in the export buffer.
+#define PROFILE_EXPORT_LINE 512
+
+typedef struct ProfileThread {
+    ProfileEvent* events;
+    // Events ever recorded; the ring holds the last PROFILE_THREAD_EVENTS of them.
+    _Atomic(u64) count;
+    u64 id;
+    char name[PROFILE_THREAD_NAME];
+} ProfileThread;
+
+typedef struct Profiler {
+    ProfileThread threads[PROFILE_MAX_THREADS];
+    _Atomic(bool) thread_ready[PROFILE_MAX_THREADS];
+    _Atomic(u32) thread_count;
+    // Changes on creation and destruction, so threads drop their ring and register again.
+    _Atomic(u32) generation;
+    _Atomic(bool) running;
+    // Exported timestamps are relative to this.
+    f64 epoch;
+    // Start of each frame, indexed by frame number modulo PROFILE_MAX_FRAMES.
+    f64 frame_starts[PROFILE_MAX_FRAMES];
+    u64 frame;
+} Profiler;
+
+static Profiler profiler;
+
+static _Thread_local ProfileThread* current_thread;
+static _Thread_local u32 current_generation;
+
+bool profiler_create(void) {
+    profiler.epoch = platform_system_time();
+    profiler.frame = 0;
+    profiler.frame_starts[0] = profiler.epoch;
+    atomic_fetch_add(&profiler.generation, 1);
+    atomic_store(&profiler.running, true);
+    profiler_set_thread_name("main");
+    return true;
+}
+
+void profiler_destroy(void) {
+    atomic_store(&profiler.running, false);
+    atomic_fetch_add(&profiler.generation, 1);
+    for (u32 i = 0; i < PROFILE_MAX_THREADS; i++) {
+        if (atomic_load(&profiler.thread_ready[i])) {
+            atomic_store(&profiler.thread_ready[i], false);
+            mem_free(profiler.threads[i].events);
+            profiler.threads[i].events = 0;
+        }
+    }
+    atomic_store(&profiler.thread_count, 0);
+}
+
+// Returns the ring of the calling thread, registering it on first use, or 0 if there is none.
+static ProfileThread* thread_ring(void) {
+    u32 generation = atomic_load_explicit(&profiler.generation, memory_order_relaxed);
+    if (current_generation == generation) {
+        return current_thread;
+    }
+    current_generation = generation;
+    current_thread = 0;
+    if (!atomic_load_explicit(&profiler.running, memory_order_relaxed)) {
+        return 0;
+    }
+    u32 slot = atomic_fetch_add(&profiler.thread_count, 1);
+    if (slot >= PROFILE_MAX_THREADS) {
+        WARN("More than %d threads are profiled; the rest aren't recorded.", PROFILE_MAX_THREADS);
+        return 0;
+    }
+    ProfileThread* thread = &profiler.threads[slot];
+    thread->events =
+        mem_alloc_tagged(PROFILE_THREAD_EVENTS * sizeof(ProfileEvent), MEM_TAG_PROFILER);
+    if (!thread->events) {
+        return 0;
+    }
+    atomic_init(&thread->count, 0);
+    thread->id = platform_thread_id();
+    snprintf(thread->name, sizeof(thread->name), "thread %llu", (unsigned long long)thread->id);
+    atomic_store_explicit(&profiler.thread_ready[slot], true, memory_order_release);
+    current_thread = thread;
+    return thread;
+}
+
+static void record(const char* name, f64 start, f64 end) {
+    ProfileThread* thread = thread_ring();
+    if (!thread) {
+        return;
+    }
+    u64 count = atomic_load_explicit(&thread->count, memory_order_relaxed);
+    ProfileEvent* event = &thread->events[count % PROFILE_THREAD_EVENTS];
+    // Keeps the stores below after the count that tells profiler_export this slot is reused.
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&event->name, name, memory_order_relaxed);
+    atomic_store_explicit(&event->start, start, memory_order_relaxed);
+    atomic_store_explicit(&event->end, end, memory_order_relaxed);
+    atomic_store_explicit(&thread->count, count + 1, memory_order_release);
+}
+
+ProfileScope profile_scope_begin(const char* name) {
+    ProfileScope scope = {name, platform_system_time()};
+    return scope;
+}
+
+void profile_scope_end(ProfileScope* scope) {
+    // The thread is looked up at the end: a job may have moved to another thread meanwhile.
+    record(scope->name, scope->start, platform_system_time());
+}
+
+void profiler_frame_mark(void) {
+    if (!atomic_load_explicit(&profiler.running, memory_order_relaxed)) {
+        return;
+    }
+    f64 now = platform_system_time();
+    record("Frame", profiler.frame_starts[profiler.frame % PROFILE_MAX_FRAMES], now);
+    profiler.frame++;
+    profiler.frame_starts[profiler.frame % PROFILE_MAX_FRAMES] = now;
+}
+
+void profiler_set_thread_name(const char* name) {
+    ProfileThread* thread = thread_ring();
+    if (thread) {
+        snprintf(thread->name, sizeof(thread->name), "%s", name);
+    }
+}
+
+typedef struct TraceWriter {
+    File file;
+    char buffer[PROFILE_EXPORT_BUFFER];
+    u64 length;
+    bool first;
+    bool ok;
+} TraceWriter;
+
+static void trace_flush(TraceWriter* writer) {
+    u64 written = 0;
+    if (writer->length > 0 && !fs_write(&writer->file, writer->length, writer->buffer, &written)) {
+        writer->ok = false;
+    }
+    writer->length = 0;
+}
+
+// Appends one event object; `format` is everything between its braces.
+static void trace_event(TraceWriter* writer, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void trace_event(TraceWriter* writer, const char* format, ...) {
+    if (writer->length + PROFILE_EXPORT_LINE > PROFILE_EXPORT_BUFFER) {
+        trace_flush(writer);
+    }
+    char* out = writer->buffer + writer->length;
+    u64 room = PROFILE_EXPORT_LINE;
+    int length = snprintf(out, room, "%s\n{", writer->first ? "" : ",");
+    va_list args;
+    va_start(args, format);
+    length += vsnprintf(out + length, room - (u64)length, format, args);
+    va_end(args);
+    if (length + 2 >= (int)room) {
+        // Only names that are far too long get here; the event is dropped.
+        return;
+    }
+    out[length++] = '}';
+    writer->length += (u64)length;
+    writer->first = false;
+}
+
+// Copies `name` with the characters JSON strings can't hold as they are escaped.
+static const char* json_escape(const char* name, char* out, u64 size) {
+    u64 length = 0;
+    for (const char* c = name; *c && length + 7 < size; c++) {
+        if (*c == '"' || *c == '\\') {
+            out[length++] = '\\';
+            out[length++] = *c;
+        } else if ((u8)*c < 0x20) {
+            length += (u64)snprintf(out + length, size - length, "\\u%04x", (u32)(u8)*c);
+        } else {
+            out[length++] = *c;
+        }
+    }
+    out[length] = 0;
+    return out;
+}
+
+// Writes the events of `thread` that ended after `window_start`.
+static void export_thread(TraceWriter* writer, ProfileThread* thread, f64 window_start) {
+    u64 end = atomic_load_explicit(&thread->count, memory_order_acquire);
+    u64 begin = end > PROFILE_THREAD_EVENTS ? end - PROFILE_THREAD_EVENTS : 0;
+    char name[PROFILE_EXPORT_LINE / 2];
+    trace_event(writer, "\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%llu,"
+                        "\"args\":{\"name\":\"%s\"}",
+                (unsigned long long)thread->id,
+                json_escape(thread->name, name, sizeof(name)));
+    for (u64 i = begin; i < end; i++) {
+        const ProfileEvent* event = &thread->events[i % PROFILE_THREAD_EVENTS];
+        const char* event_name = atomic_load_explicit(&event->name, memory_order_relaxed);
+        f64 start = atomic_load_explicit(&event->start, memory_order_relaxed);
+        f64 stop = atomic_load_explicit(&event->end, memory_order_relaxed);
+        // The thread keeps recording. If it has reached this slot again, including the write
+        // in progress at position `count`, what was read may be torn.
+        atomic_thread_fence(memory_order_acquire);
+        u64 count = atomic_load_explicit(&thread->count, memory_order_relaxed);
+        if (i + PROFILE_THREAD_EVENTS <= count) {
+            continue;
+        }
+        if (stop < window_start) {
+            continue;
+        }
+        trace_event(writer,
+                    "\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%.3f,"
+                    "\"dur\":%.3f",
+                    json_escape(event_name, name, sizeof(name)), (unsigned long long)thread->id,
+                    (start - profiler.epoch) * 1000000.0, (stop - start) * 1000000.0);
+    }
+}
+
+bool profiler_export(const char* path, u32 frame_count) {
+    if (!atomic_load(&profiler.running)) {
+        WARN("Profiler isn't running; nothing to export to %s.", path);
+        return false;
+    }
+    TraceWriter* writer = mem_alloc_tagged(sizeof(TraceWriter), MEM_TAG_PROFILER);
+    if (!writer) {
+        return false;
+    }
+    if (!fs_open(path, OPEN_FILE_MODE_WRITE, &writer->file)) {
+        ERROR("Failed to open %s for the profile.", path);
+        mem_free(writer);
+        return false;
+    }
+    writer->length = 0;
+    writer->first = true;
+    writer->ok = true;
+    // The frame in progress counts as one.
+    u64 frames = frame_count > PROFILE_MAX_FRAMES ? PROFILE_MAX_FRAMES : frame_count;
+    u64 first_frame = profiler.frame + 1 > frames ? profiler.frame + 1 - frames : 0;
+    f64 window_start = profiler.frame_starts[first_frame % PROFILE_MAX_FRAMES];
+
+    const char* header = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    memcpy(writer->buffer, header, strlen(header));
+    writer->length = strlen(header);
+    u32 threads = atomic_load(&profiler.thread_count);
+    for (u32 i = 0; i < threads && i < PROFILE_MAX_THREADS; i++) {
+        if (atomic_load_explicit(&profiler.thread_ready[i], memory_order_acquire)) {
+            export_thread(writer, &profiler.threads[i], window_start);
+        }
+    }
+    const char* footer = "\n]}\n";
+    if (writer->length + strlen(footer) > PROFILE_EXPORT_BUFFER) {
+        trace_flush(writer);
+    }
+    memcpy(writer->buffer + writer->length, footer, strlen(footer));
+    writer->length += strlen(footer);
+    trace_flush(writer);
+    fs_close(&writer->file);
+    bool ok = writer->ok;
+    mem_free(writer);
+    if (ok) {
+        INFO("Wrote %llu frames of profile to %s", profiler.frame + 1 - first_frame, path);
+    } else {
+        ERROR("Failed to write the profile to %s.", path);
+    }
+    return ok;
+}
@@ -0,0 +1,79 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "types.h"
+#include <stdatomic.h>
+
+/**
+ * Scoped CPU profiler. Each thread records the scopes it closes into its own ring, which keeps
+ * the last PROFILE_THREAD_EVENTS of them; recording costs two clock reads and a few stores.
+ * profiler_export writes the last frames as Chrome Trace Event JSON, which Perfetto and
+ * chrome://tracing open.
+ *
+ * Building with PROFILE_ENABLED set to 0 compiles every PROFILE_SCOPE out.
+ */
+
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED 1
+#endif
+
+#define PROFILE_MAX_THREADS 64
+#define PROFILE_THREAD_EVENTS (32 * 1024)
+// Frames whose boundaries are remembered, and so the longest window that can be exported.
+#define PROFILE_MAX_FRAMES 1024
+
+// Written by one thread and read by profiler_export, hence the atomics.
+typedef struct ProfileEvent {
+    _Atomic(const char*) name;
+    _Atomic(f64) start;
+    _Atomic(f64) end;
+} ProfileEvent;
+
+typedef struct ProfileScope {
+    const char* name;
+    f64 start;
+} ProfileScope;
+
+// Until creation, and after destruction, scopes aren't recorded.
+bool profiler_create(void);
+// Every other thread must have stopped recording.
+void profiler_destroy(void);
+
+/**
+ * Ends the current frame and starts the next, recording the one that ended as a "Frame"
+ * scope. Called once per frame by the thread that exports.
+ */
+void profiler_frame_mark(void);
+
+/**
+ * Names the calling thread in exported traces; `name` is copied. Threads that don't set a
+ * name are shown by their id.
+ */
+void profiler_set_thread_name(const char* name);
+
+/**
+ * Writes the scopes of the last `frame_count` frames, including the one in progress, to
+ * `path`. Scopes still open aren't included, nor ones their thread has since overwritten.
+ * Must be called by the thread that marks frames.
+ */
+bool profiler_export(const char* path, u32 frame_count);
+
+ProfileScope profile_scope_begin(const char* name);
+void profile_scope_end(ProfileScope* scope);
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if PROFILE_ENABLED
+/**
+ * Records the time from here to the end of the enclosing block under `name`, which must be a
+ * string that outlives the profiler, such as a literal.
+ */
+#define PROFILE_SCOPE(name)                                                                    \
+    ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)                                      \
+        __attribute__((cleanup(profile_scope_end))) = profile_scope_begin(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
+
+#endif
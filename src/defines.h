@@ -1,4 +1,7 @@
 
 #define UNUSED(x) (void)(x)
 #define INLINE static inline
+#define NOINLINE __attribute__((noinline))
 #define CLAMP(x, min, max) (x < min ? min : (x > max ? max : x))
+// Fields written by different threads are kept this far apart to avoid false sharing.
+#define CACHE_LINE_SIZE 64
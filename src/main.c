@@ -7,6 +7,13 @@ int main(void) {
     config.initial_window_width = 1280;
     config.initial_window_height = 720;
     config.title = "VoxelGame";
+    config.present_mode = PRESENT_MODE_MAILBOX;
+    config.max_fps = 0.0f;
+    config.just_in_time = false;
+    config.gpu_budget_ms = 12.0f;
+    config.mem_report_interval = 0;
+    config.binary_log = false;
+    config.profile_frames = 300;
 
     if (!application_initialize(&config)) {
         ERROR("Failed to initialize application.");
@@ -34,7 +34,7 @@ u8* fs_read_all(File* file, u64* bytes_read) {
         fseek(file->handle, 0, SEEK_END);
         *bytes_read = ftell(file->handle);
         fseek(file->handle, 0, SEEK_SET);
-        u8* buf = mem_alloc(sizeof(u8) * (*bytes_read));
+        u8* buf = mem_alloc_tagged(sizeof(u8) * (*bytes_read), MEM_TAG_FILE);
         fread(buf, 1, *bytes_read, file->handle);
         return buf;
     }
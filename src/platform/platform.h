@@ -1,7 +1,9 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include "defines.h"
 #include "types.h"
+#include <stdatomic.h>
 
 #ifndef PLATFORM_DEFINES_H
 #define PLATFORM_DEFINES_H
@@ -31,5 +33,92 @@ typedef enum WriteColor {
 void platform_println(const char* buf, WriteColor color);
 void platform_eprintln(const char* buf, WriteColor color);
 f64 platform_system_time(void);
+// Suspends the calling thread for at least the given number of seconds.
+void platform_sleep(f64 seconds);
+
+typedef struct Thread {
+    // Handle to a platform-specific thread object.
+    void* handle;
+} Thread;
+
+typedef void (*ThreadFn)(void* arg);
+
+bool platform_thread_create(ThreadFn fn, void* arg, Thread* thread);
+void platform_thread_join(Thread* thread);
+// Gives up the rest of the time slice, for loops that wait on another thread.
+void platform_thread_yield(void);
+// Number of logical processors available to the process.
+u32 platform_processor_count(void);
+
+typedef enum ThreadPriority {
+    THREAD_PRIORITY_LOW = 0,
+    THREAD_PRIORITY_NORMAL = 1,
+    THREAD_PRIORITY_HIGH = 2,
+} ThreadPriority;
+
+// Names the calling thread for debuggers and profilers. Linux keeps the first 15 characters.
+void platform_thread_set_name(const char* name);
+// Restricts the calling thread to one logical processor. Not supported on macOS.
+bool platform_thread_set_affinity(u32 processor);
+// Raising the priority above normal may need privileges the process doesn't have.
+bool platform_thread_set_priority(ThreadPriority priority);
+// Id of the calling thread as the OS, debuggers and profilers show it.
+u64 platform_thread_id(void);
+
+// Tells the processor the thread is spinning, which frees resources for its SMT sibling.
+INLINE void platform_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+#define PLATFORM_WAKE_ALL 0xFFFFFFFFu
+
+/**
+ * Futex-style waiting, the building block of the primitives in platform/sync.h. Blocks while
+ * `*address` still holds `expected`, for at most `timeout` seconds when it is positive.
+ * Returns false on timeout; any other return, including a spurious one, is true, so callers
+ * re-check their condition.
+ */
+bool platform_wait_on_address(_Atomic(u32)* address, u32 expected, f64 timeout);
+// Wakes up to `count` threads waiting on `address`, or all of them with PLATFORM_WAKE_ALL.
+void platform_wake_address(_Atomic(u32)* address, u32 count);
+
+#define PLATFORM_MAX_PROCESSORS 256
+
+typedef struct CpuTopology {
+    u32 logical_count;
+    u32 core_count;
+    u32 package_count;
+    // Most logical processors on one core, and logical processors per L2 and L3 cache.
+    u32 smt_width;
+    u32 l2_sharing;
+    u32 l3_sharing;
+    // Bytes per cache, 0 when unknown.
+    u64 l2_size;
+    u64 l3_size;
+    u64 cache_line_size;
+    // Physical core of each logical processor; SMT siblings share an index.
+    u16 core_of[PLATFORM_MAX_PROCESSORS];
+    // OS id of each logical processor, as platform_thread_set_affinity takes it.
+    u16 cpu_id[PLATFORM_MAX_PROCESSORS];
+} CpuTopology;
+
+// Fills in what the OS reports. Missing information falls back to one core per processor.
+void platform_cpu_topology(CpuTopology* topology);
+
+/**
+ * Virtual memory. A reserved range only takes address space; pages have to be committed
+ * before they are touched. Addresses and sizes passed to commit and decommit must be page
+ * aligned.
+ */
+u64 platform_page_size(void);
+void* platform_memory_reserve(u64 bytes);
+bool platform_memory_commit(void* address, u64 bytes);
+// Returns the pages to the OS but keeps the range reserved.
+void platform_memory_decommit(void* address, u64 bytes);
+void platform_memory_release(void* address, u64 bytes);
 
 #endif
@@ -1,10 +1,27 @@
+// Feature-test macros only count before the first system header, platform.h's included.
+#if defined(__linux__) || defined(__gnu_linux__)
+#define _POSIX_C_SOURCE 200809L
+// MAP_ANON, MAP_NORESERVE, madvise and the CPU affinity calls.
+#define _GNU_SOURCE
+#endif
+
 #include "platform.h"
 
 #ifdef PLATFORM_LINUX
-#define _POSIX_C_SOURCE 199309L
-
+#include "core/mem.h"
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
 
 void platform_println(const char* buf, WriteColor color) {
     // 30 = black, 31 = red, 32 = green, 33 = yellow = 34 = blue
@@ -24,4 +41,253 @@ f64 platform_system_time(void) {
     return systime.tv_sec + (systime.tv_nsec * 0.000000001);
 }
 
+void platform_sleep(f64 seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+    struct timespec duration;
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)((seconds - (f64)duration.tv_sec) * 1000000000.0);
+    nanosleep(&duration, 0);
+}
+
+typedef struct ThreadStart {
+    pthread_t handle;
+    ThreadFn fn;
+    void* arg;
+} ThreadStart;
+
+static void* thread_start(void* data) {
+    ThreadStart* start = data;
+    start->fn(start->arg);
+    return 0;
+}
+
+bool platform_thread_create(ThreadFn fn, void* arg, Thread* thread) {
+    ThreadStart* start = mem_alloc_tagged(sizeof(ThreadStart), MEM_TAG_PLATFORM);
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(&start->handle, 0, thread_start, start) != 0) {
+        mem_free(start);
+        thread->handle = 0;
+        return false;
+    }
+    thread->handle = start;
+    return true;
+}
+
+void platform_thread_join(Thread* thread) {
+    ThreadStart* start = thread->handle;
+    if (!start) {
+        return;
+    }
+    pthread_join(start->handle, 0);
+    mem_free(start);
+    thread->handle = 0;
+}
+
+void platform_thread_yield(void) {
+    sched_yield();
+}
+
+u32 platform_processor_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+void platform_thread_set_name(const char* name) {
+    prctl(PR_SET_NAME, name, 0, 0, 0);
+}
+
+bool platform_thread_set_affinity(u32 processor) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(processor, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+bool platform_thread_set_priority(ThreadPriority priority) {
+    // Threads have their own nice value on Linux.
+    static const int nice_values[] = {10, 0, -5};
+    return setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice_values[priority]) == 0;
+}
+
+u64 platform_thread_id(void) {
+    return (u64)syscall(SYS_gettid);
+}
+
+bool platform_wait_on_address(_Atomic(u32)* address, u32 expected, f64 timeout) {
+    struct timespec duration;
+    struct timespec* duration_ptr = 0;
+    if (timeout > 0.0) {
+        duration.tv_sec = (time_t)timeout;
+        duration.tv_nsec = (long)((timeout - (f64)duration.tv_sec) * 1000000000.0);
+        duration_ptr = &duration;
+    }
+    long result =
+        syscall(SYS_futex, (u32*)address, FUTEX_WAIT_PRIVATE, expected, duration_ptr, 0, 0);
+    return result == 0 || errno != ETIMEDOUT;
+}
+
+void platform_wake_address(_Atomic(u32)* address, u32 count) {
+    int wake = count > INT_MAX ? INT_MAX : (int)count;
+    syscall(SYS_futex, (u32*)address, FUTEX_WAKE_PRIVATE, wake, 0, 0, 0);
+}
+
+static bool read_sysfs(const char* path, char* buf, u32 size) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+    bool ok = fgets(buf, (int)size, file) != 0;
+    fclose(file);
+    return ok;
+}
+
+static bool read_sysfs_u32(const char* path, u32* value) {
+    char buf[32];
+    return read_sysfs(path, buf, sizeof(buf)) && sscanf(buf, "%u", value) == 1;
+}
+
+/**
+ * Counts the processors in a list such as "0-3,8-11", storing the first `max` of their ids in
+ * `ids` when it isn't 0.
+ */
+static u32 parse_cpu_list(const char* list, u16* ids, u32 max) {
+    u32 count = 0;
+    while (*list) {
+        u32 first, last;
+        int read = 0;
+        if (sscanf(list, "%u-%u%n", &first, &last, &read) != 2) {
+            if (sscanf(list, "%u%n", &first, &read) != 1) {
+                break;
+            }
+            last = first;
+        }
+        for (u32 id = first; id <= last; id++, count++) {
+            if (ids && count < max) {
+                ids[count] = (u16)id;
+            }
+        }
+        list += read;
+        if (*list == ',') {
+            list++;
+        }
+    }
+    return count;
+}
+
+// Fills in the unified or data cache of one level as seen from processor 0.
+static void read_cache(u32 level, u64* size, u32* sharing) {
+    char path[128];
+    char buf[256];
+    for (u32 index = 0; index < 8; index++) {
+        u32 cache_level;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/level", index);
+        if (!read_sysfs_u32(path, &cache_level)) {
+            return;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/type", index);
+        if (cache_level != level || !read_sysfs(path, buf, sizeof(buf)) ||
+            strncmp(buf, "Instruction", 11) == 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/size", index);
+        u32 kilobytes;
+        if (read_sysfs(path, buf, sizeof(buf)) && sscanf(buf, "%uK", &kilobytes) == 1) {
+            *size = (u64)kilobytes * 1024;
+        }
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu0/cache/index%u/shared_cpu_list", index);
+        if (read_sysfs(path, buf, sizeof(buf))) {
+            *sharing = parse_cpu_list(buf, 0, 0);
+        }
+        return;
+    }
+}
+
+void platform_cpu_topology(CpuTopology* topology) {
+    memset(topology, 0, sizeof(CpuTopology));
+    // Online processors aren't necessarily numbered 0..n-1, e.g. with some of them offlined.
+    char online[1024];
+    u32 logical = 0;
+    if (read_sysfs("/sys/devices/system/cpu/online", online, sizeof(online))) {
+        logical = parse_cpu_list(online, topology->cpu_id, PLATFORM_MAX_PROCESSORS);
+    }
+    if (logical == 0) {
+        logical = platform_processor_count();
+        for (u32 i = 0; i < logical && i < PLATFORM_MAX_PROCESSORS; i++) {
+            topology->cpu_id[i] = (u16)i;
+        }
+    }
+    topology->logical_count = logical > PLATFORM_MAX_PROCESSORS ? PLATFORM_MAX_PROCESSORS : logical;
+    // Cores are only unique within their package, so both ids make up the key.
+    u32 keys[PLATFORM_MAX_PROCESSORS];
+    u32 packages[PLATFORM_MAX_PROCESSORS];
+    u32 siblings[PLATFORM_MAX_PROCESSORS] = {0};
+    for (u32 i = 0; i < topology->logical_count; i++) {
+        char path[96];
+        u32 cpu = topology->cpu_id[i];
+        u32 core = cpu, package = 0;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+        read_sysfs_u32(path, &core);
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+        read_sysfs_u32(path, &package);
+        u32 key = (package << 16) | (core & 0xFFFF);
+        u32 index = 0;
+        while (index < topology->core_count && keys[index] != key) {
+            index++;
+        }
+        if (index == topology->core_count) {
+            keys[topology->core_count++] = key;
+        }
+        topology->core_of[i] = (u16)index;
+        siblings[index]++;
+        u32 known = 0;
+        while (known < topology->package_count && packages[known] != package) {
+            known++;
+        }
+        if (known == topology->package_count) {
+            packages[topology->package_count++] = package;
+        }
+    }
+    // Hybrid processors mix cores with and without SMT; the widest one is reported.
+    for (u32 i = 0; i < topology->core_count; i++) {
+        topology->smt_width = siblings[i] > topology->smt_width ? siblings[i] : topology->smt_width;
+    }
+    read_cache(2, &topology->l2_size, &topology->l2_sharing);
+    read_cache(3, &topology->l3_size, &topology->l3_sharing);
+    u32 line = 0;
+    if (read_sysfs_u32("/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size",
+                       &line)) {
+        topology->cache_line_size = line;
+    }
+}
+
+u64 platform_page_size(void) {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (u64)size : 4096;
+}
+
+void* platform_memory_reserve(u64 bytes) {
+    void* address = mmap(0, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    return address == MAP_FAILED ? 0 : address;
+}
+
+bool platform_memory_commit(void* address, u64 bytes) {
+    return mprotect(address, bytes, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platform_memory_decommit(void* address, u64 bytes) {
+    madvise(address, bytes, MADV_DONTNEED);
+    mprotect(address, bytes, PROT_NONE);
+}
+
+void platform_memory_release(void* address, u64 bytes) {
+    if (address) {
+        munmap(address, bytes);
+    }
+}
+
 #endif
@@ -1,8 +1,26 @@
 #include "platform.h"
 
 #ifdef PLATFORM_MACOS
+#include "core/mem.h"
+#include <errno.h>
+#include <pthread.h>
+#include <pthread/qos.h>
+#include <sched.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/sysctl.h>
 #include <time.h>
+#include <unistd.h>
+
+// The wait-on-address calls behind libc++'s atomic wait; there is no public futex on macOS
+// before 14.4.
+#define UL_COMPARE_AND_WAIT 1
+#define ULF_WAKE_ALL 0x00000100
+#define ULF_NO_ERRNO 0x01000000
+extern int __ulock_wait(u32 operation, void* address, u64 value, u32 timeout_us);
+extern int __ulock_wake(u32 operation, void* address, u64 wake_value);
+
 void platform_println(const char* buf, WriteColor color) {
     // 30 = black, 31 = red, 32 = green, 33 = yellow = 34 = blue
     const char* colors[] = {"1;31", "1;33", "1;32", "1;34", "1;30"};
@@ -19,4 +37,165 @@ f64 platform_system_time(void) {
     clock_gettime(CLOCK_MONOTONIC, &systime);
     return systime.tv_sec + (systime.tv_nsec * 0.000000001);
 }
+
+void platform_sleep(f64 seconds) {
+    if (seconds <= 0.0) {
+        return;
+    }
+    struct timespec duration;
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)((seconds - (f64)duration.tv_sec) * 1000000000.0);
+    nanosleep(&duration, 0);
+}
+
+typedef struct ThreadStart {
+    pthread_t handle;
+    ThreadFn fn;
+    void* arg;
+} ThreadStart;
+
+static void* thread_start(void* data) {
+    ThreadStart* start = data;
+    start->fn(start->arg);
+    return 0;
+}
+
+bool platform_thread_create(ThreadFn fn, void* arg, Thread* thread) {
+    ThreadStart* start = mem_alloc_tagged(sizeof(ThreadStart), MEM_TAG_PLATFORM);
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(&start->handle, 0, thread_start, start) != 0) {
+        mem_free(start);
+        thread->handle = 0;
+        return false;
+    }
+    thread->handle = start;
+    return true;
+}
+
+void platform_thread_join(Thread* thread) {
+    ThreadStart* start = thread->handle;
+    if (!start) {
+        return;
+    }
+    pthread_join(start->handle, 0);
+    mem_free(start);
+    thread->handle = 0;
+}
+
+void platform_thread_yield(void) {
+    sched_yield();
+}
+
+u32 platform_processor_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+void platform_thread_set_name(const char* name) {
+    pthread_setname_np(name);
+}
+
+bool platform_thread_set_affinity(u32 processor) {
+    // macOS only takes affinity hints between threads, not processor numbers.
+    UNUSED(processor);
+    return false;
+}
+
+bool platform_thread_set_priority(ThreadPriority priority) {
+    static const qos_class_t classes[] = {QOS_CLASS_UTILITY, QOS_CLASS_DEFAULT,
+                                          QOS_CLASS_USER_INTERACTIVE};
+    return pthread_set_qos_class_self_np(classes[priority], 0) == 0;
+}
+
+u64 platform_thread_id(void) {
+    u64 id = 0;
+    pthread_threadid_np(0, &id);
+    return id;
+}
+
+bool platform_wait_on_address(_Atomic(u32)* address, u32 expected, f64 timeout) {
+    u32 timeout_us = 0;
+    if (timeout > 0.0) {
+        f64 micros = timeout * 1000000.0;
+        timeout_us = micros >= 4294967295.0 ? 0xFFFFFFFFu : (micros < 1.0 ? 1 : (u32)micros);
+    }
+    int result =
+        __ulock_wait(UL_COMPARE_AND_WAIT | ULF_NO_ERRNO, (void*)address, expected, timeout_us);
+    return result != -ETIMEDOUT;
+}
+
+void platform_wake_address(_Atomic(u32)* address, u32 count) {
+    u32 operation = UL_COMPARE_AND_WAIT | ULF_NO_ERRNO;
+    // The wake is either one thread or every thread.
+    if (count > 1) {
+        operation |= ULF_WAKE_ALL;
+    }
+    __ulock_wake(operation, (void*)address, 0);
+}
+
+static u64 sysctl_u64(const char* name) {
+    u64 value = 0;
+    size_t size = sizeof(value);
+    if (sysctlbyname(name, &value, &size, 0, 0) != 0) {
+        return 0;
+    }
+    // Some entries are 32 bits wide.
+    return size == sizeof(u32) ? (u64)(u32)value : value;
+}
+
+void platform_cpu_topology(CpuTopology* topology) {
+    memset(topology, 0, sizeof(CpuTopology));
+    u32 logical = platform_processor_count();
+    topology->logical_count = logical > PLATFORM_MAX_PROCESSORS ? PLATFORM_MAX_PROCESSORS : logical;
+    u64 cores = sysctl_u64("hw.physicalcpu");
+    topology->core_count = cores > 0 && cores <= logical ? (u32)cores : topology->logical_count;
+    u64 packages = sysctl_u64("hw.packages");
+    topology->package_count = packages > 0 ? (u32)packages : 1;
+    // Rounded up, for processors that mix cores with and without SMT.
+    topology->smt_width =
+        (topology->logical_count + topology->core_count - 1) / topology->core_count;
+    // macOS numbers the SMT siblings of a core next to each other.
+    for (u32 i = 0; i < topology->logical_count; i++) {
+        u32 core = i / topology->smt_width;
+        topology->core_of[i] = (u16)(core < topology->core_count ? core : topology->core_count - 1);
+        topology->cpu_id[i] = (u16)i;
+    }
+    topology->l2_size = sysctl_u64("hw.l2cachesize");
+    topology->l3_size = sysctl_u64("hw.l3cachesize");
+    topology->cache_line_size = sysctl_u64("hw.cachelinesize");
+    // Processors sharing each level, starting with memory at index 0.
+    u64 sharing[10] = {0};
+    size_t size = sizeof(sharing);
+    if (sysctlbyname("hw.cacheconfig", sharing, &size, 0, 0) == 0) {
+        topology->l2_sharing = (u32)sharing[2];
+        topology->l3_sharing = (u32)sharing[3];
+    }
+}
+
+u64 platform_page_size(void) {
+    long size = sysconf(_SC_PAGESIZE);
+    return size > 0 ? (u64)size : 4096;
+}
+
+void* platform_memory_reserve(u64 bytes) {
+    void* address = mmap(0, bytes, PROT_NONE, MAP_PRIVATE | MAP_ANON | MAP_NORESERVE, -1, 0);
+    return address == MAP_FAILED ? 0 : address;
+}
+
+bool platform_memory_commit(void* address, u64 bytes) {
+    return mprotect(address, bytes, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platform_memory_decommit(void* address, u64 bytes) {
+    madvise(address, bytes, MADV_FREE);
+    mprotect(address, bytes, PROT_NONE);
+}
+
+void platform_memory_release(void* address, u64 bytes) {
+    if (address) {
+        munmap(address, bytes);
+    }
+}
+
 #endif
@@ -0,0 +1,140 @@
+#include "sync.h"
+#include "platform.h"
+
+#define MUTEX_SPINS 64
+
+// Takes the lock in the contended state, so whoever unlocks next wakes a waiter.
+static void lock_contended(Mutex* mutex) {
+    while (atomic_exchange_explicit(&mutex->state, 2, memory_order_acquire) != 0) {
+        platform_wait_on_address(&mutex->state, 2, 0.0);
+    }
+}
+
+void mutex_lock(Mutex* mutex) {
+    for (u32 i = 0; i < MUTEX_SPINS; i++) {
+        u32 unlocked = 0;
+        if (atomic_compare_exchange_weak_explicit(&mutex->state, &unlocked, 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return;
+        }
+        if (unlocked == 2) {
+            break;
+        }
+        platform_cpu_relax();
+    }
+    lock_contended(mutex);
+}
+
+bool mutex_try_lock(Mutex* mutex) {
+    u32 unlocked = 0;
+    return atomic_compare_exchange_strong_explicit(&mutex->state, &unlocked, 1,
+                                                   memory_order_acquire, memory_order_relaxed);
+}
+
+void mutex_unlock(Mutex* mutex) {
+    if (atomic_exchange_explicit(&mutex->state, 0, memory_order_release) == 2) {
+        platform_wake_address(&mutex->state, 1);
+    }
+}
+
+void cond_var_wait(CondVar* cond, Mutex* mutex) {
+    cond_var_wait_timeout(cond, mutex, 0.0);
+}
+
+bool cond_var_wait_timeout(CondVar* cond, Mutex* mutex, f64 timeout) {
+    // Read under the lock: a signal sent after the unlock changes the value and the wait below
+    // returns straight away instead of missing it.
+    u32 sequence = atomic_load_explicit(&cond->sequence, memory_order_relaxed);
+    mutex_unlock(mutex);
+    bool signaled = platform_wait_on_address(&cond->sequence, sequence, timeout);
+    // Other threads may have been woken by a broadcast as well.
+    lock_contended(mutex);
+    return signaled;
+}
+
+void cond_var_signal(CondVar* cond) {
+    atomic_fetch_add_explicit(&cond->sequence, 1, memory_order_release);
+    platform_wake_address(&cond->sequence, 1);
+}
+
+void cond_var_broadcast(CondVar* cond) {
+    atomic_fetch_add_explicit(&cond->sequence, 1, memory_order_release);
+    platform_wake_address(&cond->sequence, PLATFORM_WAKE_ALL);
+}
+
+void semaphore_init(Semaphore* semaphore, u32 count) {
+    atomic_init(&semaphore->count, count);
+    atomic_init(&semaphore->waiters, 0);
+}
+
+bool semaphore_try_wait(Semaphore* semaphore) {
+    u32 count = atomic_load_explicit(&semaphore->count, memory_order_relaxed);
+    while (count > 0) {
+        if (atomic_compare_exchange_weak_explicit(&semaphore->count, &count, count - 1,
+                                                  memory_order_acquire, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void semaphore_wait(Semaphore* semaphore) {
+    while (!semaphore_try_wait(semaphore)) {
+        // Sequentially consistent with the post, so either the poster sees this waiter or the
+        // wait below sees the new count.
+        atomic_fetch_add(&semaphore->waiters, 1);
+        platform_wait_on_address(&semaphore->count, 0, 0.0);
+        atomic_fetch_sub(&semaphore->waiters, 1);
+    }
+}
+
+void semaphore_post(Semaphore* semaphore, u32 count) {
+    atomic_fetch_add(&semaphore->count, count);
+    if (atomic_load(&semaphore->waiters) > 0) {
+        platform_wake_address(&semaphore->count, count);
+    }
+}
+
+void event_set(Event* event) {
+    if (atomic_exchange_explicit(&event->state, 1, memory_order_release) == 2) {
+        platform_wake_address(&event->state, PLATFORM_WAKE_ALL);
+    }
+}
+
+void event_reset(Event* event) {
+    u32 set = 1;
+    atomic_compare_exchange_strong_explicit(&event->state, &set, 0, memory_order_relaxed,
+                                            memory_order_relaxed);
+}
+
+bool event_is_set(Event* event) {
+    return atomic_load_explicit(&event->state, memory_order_acquire) == 1;
+}
+
+void event_wait(Event* event) {
+    event_wait_timeout(event, 0.0);
+}
+
+bool event_wait_timeout(Event* event, f64 timeout) {
+    f64 deadline = timeout > 0.0 ? platform_system_time() + timeout : 0.0;
+    for (;;) {
+        u32 state = atomic_load_explicit(&event->state, memory_order_acquire);
+        if (state == 1) {
+            return true;
+        }
+        // Marks that a setter has to wake someone.
+        if (state == 0 && !atomic_compare_exchange_weak_explicit(&event->state, &state, 2,
+                                                                 memory_order_relaxed,
+                                                                 memory_order_relaxed)) {
+            continue;
+        }
+        f64 remaining = 0.0;
+        if (timeout > 0.0) {
+            remaining = deadline - platform_system_time();
+            if (remaining <= 0.0) {
+                return false;
+            }
+        }
+        platform_wait_on_address(&event->state, 2, remaining);
+    }
+}
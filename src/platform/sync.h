@@ -0,0 +1,57 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include "types.h"
+#include <stdatomic.h>
+
+/**
+ * Blocking primitives built on platform_wait_on_address. Each one is a single word or two,
+ * needs no creation or destruction, and is ready to use when zeroed. None of them enter the
+ * kernel unless a thread actually has to sleep or be woken.
+ */
+
+typedef struct Mutex {
+    // 0 unlocked, 1 locked, 2 locked with threads possibly waiting.
+    _Atomic(u32) state;
+} Mutex;
+
+typedef struct CondVar {
+    _Atomic(u32) sequence;
+} CondVar;
+
+typedef struct Semaphore {
+    _Atomic(u32) count;
+    _Atomic(u32) waiters;
+} Semaphore;
+
+// Manual-reset event: stays set, releasing every waiter, until it is reset.
+typedef struct Event {
+    // 0 unset, 1 set, 2 unset with threads possibly waiting.
+    _Atomic(u32) state;
+} Event;
+
+// Spins briefly before sleeping, since most critical sections are shorter than a sleep.
+void mutex_lock(Mutex* mutex);
+bool mutex_try_lock(Mutex* mutex);
+void mutex_unlock(Mutex* mutex);
+
+// `mutex` must be locked, and is locked again on return. Wake-ups can be spurious.
+void cond_var_wait(CondVar* cond, Mutex* mutex);
+// Returns false if `timeout` seconds passed without a signal.
+bool cond_var_wait_timeout(CondVar* cond, Mutex* mutex, f64 timeout);
+void cond_var_signal(CondVar* cond);
+void cond_var_broadcast(CondVar* cond);
+
+void semaphore_init(Semaphore* semaphore, u32 count);
+void semaphore_wait(Semaphore* semaphore);
+bool semaphore_try_wait(Semaphore* semaphore);
+void semaphore_post(Semaphore* semaphore, u32 count);
+
+void event_set(Event* event);
+void event_reset(Event* event);
+bool event_is_set(Event* event);
+void event_wait(Event* event);
+// Returns false if the event was still unset after `timeout` seconds.
+bool event_wait_timeout(Event* event, f64 timeout);
+
+#endif
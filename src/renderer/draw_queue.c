@@ -0,0 +1,96 @@
+#include "draw_queue.h"
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_PASSES (64 / RADIX_BITS)
+
+void draw_queue_create(DrawQueue* queue) {
+    queue->items = vector_new(DrawItem);
+    queue->scratch = vector_new(DrawItem);
+    queue->packets = vector_new(DrawPacket);
+}
+
+void draw_queue_destroy(DrawQueue* queue) {
+    vector_free(queue->items);
+    vector_free(queue->scratch);
+    vector_free(queue->packets);
+}
+
+void draw_queue_clear(DrawQueue* queue) {
+    vector_clear(queue->items);
+    vector_clear(queue->packets);
+}
+
+u64 draw_queue_key(DrawPass pass, RenderPipeline pipeline, u32 material, f32 depth) {
+    depth = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    u64 bucket = (u64)(depth * (f32)DRAW_KEY_DEPTH_MASK);
+    // Blended geometry has to be drawn from the back.
+    if (pass == DRAW_PASS_TRANSPARENT) {
+        bucket = DRAW_KEY_DEPTH_MASK - bucket;
+    }
+    return ((u64)pass & DRAW_KEY_PASS_MASK) << DRAW_KEY_PASS_SHIFT |
+           ((u64)pipeline & DRAW_KEY_PIPELINE_MASK) << DRAW_KEY_PIPELINE_SHIFT |
+           ((u64)material & DRAW_KEY_MATERIAL_MASK) << DRAW_KEY_MATERIAL_SHIFT |
+           (bucket & DRAW_KEY_DEPTH_MASK) << DRAW_KEY_DEPTH_SHIFT;
+}
+
+RenderPipeline draw_queue_key_pipeline(u64 key) {
+    return (RenderPipeline)((key >> DRAW_KEY_PIPELINE_SHIFT) & DRAW_KEY_PIPELINE_MASK);
+}
+
+void draw_queue_push(DrawQueue* queue, u64 key, const DrawPacket* packet) {
+    DrawItem item = {0};
+    item.key = key;
+    item.packet = (u32)vector_length(queue->packets);
+    vector_push(queue->packets, *packet);
+    vector_push(queue->items, item);
+}
+
+void draw_queue_sort(DrawQueue* queue) {
+    u64 count = vector_length(queue->items);
+    if (count < 2) {
+        return;
+    }
+    // The scratch contents are dead, so clearing first keeps the reserve from copying them.
+    vector_clear(queue->scratch);
+    vector_reserve(queue->scratch, count);
+    vector_length_set(queue->scratch, count);
+
+    // All the histograms in a single read of the keys.
+    u32 histograms[RADIX_PASSES][RADIX_BUCKETS] = {0};
+    for (u64 i = 0; i < count; i++) {
+        u64 key = queue->items[i].key;
+        for (u32 pass = 0; pass < RADIX_PASSES; pass++) {
+            histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+        }
+    }
+
+    DrawItem* src = queue->items;
+    DrawItem* dst = queue->scratch;
+    for (u32 pass = 0; pass < RADIX_PASSES; pass++) {
+        u32* histogram = histograms[pass];
+        u32 shift = pass * RADIX_BITS;
+        // Every key has the same byte here, the pass would not move anything.
+        if (histogram[(src[0].key >> shift) & (RADIX_BUCKETS - 1)] == count) {
+            continue;
+        }
+        u32 offset = 0;
+        for (u32 bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+            u32 bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+        for (u64 i = 0; i < count; i++) {
+            dst[histogram[(src[i].key >> shift) & (RADIX_BUCKETS - 1)]++] = src[i];
+        }
+        DrawItem* temp = src;
+        src = dst;
+        dst = temp;
+    }
+
+    // Keep the sorted items in `items`; the scratch vector stays as the spare buffer.
+    if (src != queue->items) {
+        queue->scratch = queue->items;
+        queue->items = src;
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef DRAW_QUEUE_H
+#define DRAW_QUEUE_H
+
+#include "collections/vector.h"
+#include "renderer_backend.h"
+#include "types.h"
+
+/**
+ * Sort key layout, most significant first. Sorting by the key groups draws by pass, then by
+ * pipeline and material so state changes are minimal, and finally by depth.
+ *
+ *  63..60  pass
+ *  59..52  pipeline
+ *  51..36  material
+ *  35..12  depth bucket, front-to-back for opaque passes, back-to-front for transparent ones
+ *  11..0   reserved
+ */
+#define DRAW_KEY_PASS_SHIFT 60
+#define DRAW_KEY_PIPELINE_SHIFT 52
+#define DRAW_KEY_MATERIAL_SHIFT 36
+#define DRAW_KEY_DEPTH_SHIFT 12
+#define DRAW_KEY_PASS_MASK 0xFull
+#define DRAW_KEY_PIPELINE_MASK 0xFFull
+#define DRAW_KEY_MATERIAL_MASK 0xFFFFull
+#define DRAW_KEY_DEPTH_MASK 0xFFFFFFull
+
+typedef enum DrawPass {
+    DRAW_PASS_OPAQUE,
+    DRAW_PASS_TRANSPARENT,
+} DrawPass;
+
+/**
+ * What the backend needs to issue one draw.
+ */
+typedef struct DrawPacket {
+    MeshRange mesh;
+    DrawConstants constants;
+} DrawPacket;
+
+typedef struct DrawItem {
+    u64 key;
+    // Index into DrawQueue.packets.
+    u32 packet;
+    u32 pad_0;
+} DrawItem;
+
+/**
+ * Per-frame list of draws, sorted by key before being handed to the backend.
+ */
+typedef struct DrawQueue {
+    Vector(DrawItem) items;
+    // Ping-pong buffer for the radix sort.
+    Vector(DrawItem) scratch;
+    Vector(DrawPacket) packets;
+} DrawQueue;
+
+void draw_queue_create(DrawQueue* queue);
+void draw_queue_destroy(DrawQueue* queue);
+void draw_queue_clear(DrawQueue* queue);
+
+/**
+ * Packs a sort key. `depth` is the normalized view depth in [0, 1]; values outside are clamped.
+ */
+u64 draw_queue_key(DrawPass pass, RenderPipeline pipeline, u32 material, f32 depth);
+RenderPipeline draw_queue_key_pipeline(u64 key);
+
+void draw_queue_push(DrawQueue* queue, u64 key, const DrawPacket* packet);
+
+/**
+ * Stable LSD radix sort of the items by key, one byte per pass. Bytes that are the same for
+ * every key are skipped, so in practice only a few passes run.
+ */
+void draw_queue_sort(DrawQueue* queue);
+
+#endif
@@ -1,8 +1,31 @@
 #include "renderer.h"
+#include "collections/vector.h"
 #include "core/log.h"
+#include "core/profiler.h"
+#include "draw_queue.h"
 #include "math/lineal.h"
 #include "renderer_backend.h"
+#include "resolution_scaler.h"
 static RendererBackend backend = {0};
+static ResolutionScaler scaler = {0};
+static DrawQueue draw_queue = {0};
+
+typedef struct QueuedInstances {
+    MeshRange mesh;
+    u32 count;
+} QueuedInstances;
+
+// Upper bounds of the instance queues. Only address space is reserved for them.
+#define MAX_QUEUED_INSTANCES (1 << 20)
+#define MAX_QUEUED_BATCHES (1 << 16)
+
+// Instances submitted between frames, forwarded to the backend once the frame begins.
+static Vector(InstanceData) queued_instances = 0;
+static Vector(QueuedInstances) queued_batches = 0;
+
+#define BLOCK_TEXTURE_SIZE 16
+// Layer order matches DrawConstants.material.
+static const char* block_textures[] = {"stone", "dirt", "grass_side", "grass_top"};
 
 bool renderer_create(const char* app_name, Window* window) {
     // TODO: make this configurable
@@ -12,24 +35,96 @@ bool renderer_create(const char* app_name, Window* window) {
         ERROR("Failed to create render system");
         return false;
     }
+    draw_queue_create(&draw_queue);
+    queued_instances = vector_reserved(InstanceData, MAX_QUEUED_INSTANCES);
+    queued_batches = vector_reserved(QueuedInstances, MAX_QUEUED_BATCHES);
+    u32 texture_count = sizeof(block_textures) / sizeof(block_textures[0]);
+    if (!backend.set_textures(block_textures, texture_count, BLOCK_TEXTURE_SIZE)) {
+        ERROR("Failed to load block textures");
+        return false;
+    }
     return true;
 }
 
+// Sorted by key, so the pipeline only changes between groups of draws.
+static void submit_draws(void) {
+    draw_queue_sort(&draw_queue);
+    u32 bound_pipeline = RENDER_PIPELINE_COUNT;
+    for (u64 i = 0; i < vector_length(draw_queue.items); i++) {
+        DrawItem* item = &draw_queue.items[i];
+        RenderPipeline pipeline = draw_queue_key_pipeline(item->key);
+        if (pipeline != bound_pipeline) {
+            backend.bind_pipeline(pipeline);
+            bound_pipeline = pipeline;
+        }
+        DrawPacket* packet = &draw_queue.packets[item->packet];
+        backend.draw(packet->mesh, packet->constants);
+    }
+}
+
 bool renderer_render(f32 dt) {
+    PROFILE_SCOPE("renderer_render");
+    bool is_ok = true;
     if (backend.begin_frame(dt)) {
+        f32 gpu_ms = 0.0f;
+        if (backend.gpu_frame_time(&gpu_ms) && resolution_scaler_update(&scaler, gpu_ms)) {
+            backend.set_render_scale(scaler.scale);
+        }
         backend.update_globals(mat4_identity(), mat4_identity());
-        bool is_ok = backend.end_frame(dt);
+        DrawPacket quad = {0};
+        quad.mesh = RENDERER_QUAD_MESH;
+        renderer_draw(&quad, 0.0f);
+        submit_draws();
+        u32 first = 0;
+        for (u64 i = 0; i < vector_length(queued_batches); i++) {
+            QueuedInstances* batch = &queued_batches[i];
+            backend.draw_instanced(batch->mesh, &queued_instances[first], batch->count);
+            first += batch->count;
+        }
+        is_ok = backend.end_frame(dt);
         if (!is_ok) {
             ERROR("Could not finish frame.");
-            return false;
         }
     }
-    return true;
+    // Frames that could not begin drop their draws; the caller submits fresh ones.
+    draw_queue_clear(&draw_queue);
+    vector_clear(queued_instances);
+    vector_clear(queued_batches);
+    return is_ok;
 }
 
 void renderer_resize(u16 width, u16 height) { backend.resize(width, height); }
 
+void renderer_draw(const DrawPacket* packet, f32 depth) {
+    u64 key = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, packet->constants.material,
+                             depth);
+    draw_queue_push(&draw_queue, key, packet);
+}
+
+void renderer_draw_instanced(MeshRange mesh, const InstanceData* instances, u32 count) {
+    if (count == 0) {
+        return;
+    }
+    for (u32 i = 0; i < count; i++) {
+        vector_push(queued_instances, instances[i]);
+    }
+    QueuedInstances batch = {mesh, count};
+    vector_push(queued_batches, batch);
+}
+
+void renderer_set_present_mode(PresentMode mode) { backend.set_present_mode(mode); }
+
+void renderer_set_gpu_budget(f32 budget_ms) {
+    resolution_scaler_create(budget_ms, &scaler);
+    backend.set_render_scale(scaler.scale);
+}
+
+bool renderer_wait_for_frame(void) { return backend.wait_frame(); }
+
 void renderer_destroy(void) {
+    draw_queue_destroy(&draw_queue);
+    vector_free(queued_instances);
+    vector_free(queued_batches);
     backend.destroy();
     renderer_backend_reset(&backend);
 }
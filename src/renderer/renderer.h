@@ -1,12 +1,37 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include "draw_queue.h"
+#include "renderer_backend.h"
 #include "types.h"
 #include "window_types.h"
 
+// Unit quad placed at the start of the shared buffers when the renderer is created.
+#define RENDERER_QUAD_MESH ((MeshRange){6, 0, 0})
+
 bool renderer_create(const char* app_name, Window* window);
 void renderer_destroy(void);
 bool renderer_render(f32 dt);
 void renderer_resize(u16 width, u16 height);
+void renderer_set_present_mode(PresentMode mode);
+/**
+ * Queues an opaque draw for the next rendered frame. `depth` is the normalized view depth of
+ * the draw; draws are sorted by pipeline, material and then front-to-back.
+ */
+void renderer_draw(const DrawPacket* packet, f32 depth);
+/**
+ * Queues `count` instances of the mesh for the next rendered frame. Submitting every instance
+ * of a mesh type in one call keeps it to a single draw call.
+ */
+void renderer_draw_instanced(MeshRange mesh, const InstanceData* instances, u32 count);
+/**
+ * GPU frame time the scene resolution is adjusted for. 0 renders at full resolution.
+ */
+void renderer_set_gpu_budget(f32 budget_ms);
+/**
+ * Blocks until the GPU can accept the next frame. Calling this before sampling input keeps
+ * the wait out of the input-to-present path.
+ */
+bool renderer_wait_for_frame(void);
 
 #endif
@@ -5,8 +5,17 @@ bool renderer_backend_setup(const char* app_name, Window* window, RendererBacken
     if (backend->type == RENDER_BACKEND_VULKAN) {
         backend->create = vulkan_backend_create;
         backend->resize = vulkan_backend_resize;
+        backend->set_present_mode = vulkan_backend_set_present_mode;
+        backend->wait_frame = vulkan_backend_wait_frame;
         backend->begin_frame = vulkan_backend_begin_frame;
         backend->update_globals = vulkan_backend_update_globals;
+        backend->bind_pipeline = vulkan_backend_bind_pipeline;
+        backend->draw = vulkan_backend_draw;
+        backend->draw_instanced = vulkan_backend_draw_instanced;
+        backend->set_render_scale = vulkan_backend_set_render_scale;
+        backend->gpu_frame_time = vulkan_backend_gpu_frame_time;
+        backend->set_chunk_draws = vulkan_backend_set_chunk_draws;
+        backend->set_textures = vulkan_backend_set_textures;
         backend->end_frame = vulkan_backend_end_frame;
         backend->destroy = vulkan_backend_destroy;
         return true;
@@ -17,8 +26,17 @@ bool renderer_backend_setup(const char* app_name, Window* window, RendererBacken
 void renderer_backend_reset(RendererBackend* backend) {
     backend->create = 0;
     backend->resize = 0;
+    backend->set_present_mode = 0;
+    backend->wait_frame = 0;
     backend->begin_frame = 0;
     backend->update_globals = 0;
+    backend->bind_pipeline = 0;
+    backend->draw = 0;
+    backend->draw_instanced = 0;
+    backend->set_render_scale = 0;
+    backend->gpu_frame_time = 0;
+    backend->set_chunk_draws = 0;
+    backend->set_textures = 0;
     backend->end_frame = 0;
     backend->destroy = 0;
 }
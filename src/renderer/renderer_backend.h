@@ -10,19 +10,112 @@ typedef enum RenderBackend {
     RENDER_BACKEND_OPENGL,
 } RenderBackend;
 
+/**
+ * Presentation policy. Modes the surface does not support fall back to the closest one:
+ * MAILBOX and IMMEDIATE to each other, then everything to FIFO, which is always available.
+ */
+typedef enum PresentMode {
+    // Vsync, frames queue up behind the display. No tearing, highest latency.
+    PRESENT_MODE_FIFO,
+    // Vsync, but a late frame is shown at once instead of waiting for the next refresh.
+    PRESENT_MODE_FIFO_RELAXED,
+    // Vsync, the newest frame replaces the queued one. No tearing, low latency.
+    PRESENT_MODE_MAILBOX,
+    // No vsync. Lowest latency, may tear.
+    PRESENT_MODE_IMMEDIATE,
+} PresentMode;
+
+/**
+ * Graphics pipelines draws can select; part of the draw sort key.
+ */
+typedef enum RenderPipeline {
+    // Textured geometry with depth test and write.
+    RENDER_PIPELINE_OPAQUE,
+    RENDER_PIPELINE_COUNT,
+} RenderPipeline;
+
 typedef struct GlobalsUBO {
-    Mat4 proj;  // 64 bytes
-    Mat4 view;  // 64 bytes
-    Mat4 pad_0; // 64 bytes, reserved
-    Mat4 pad_1; // 64 bytes, reserved
+    Mat4 proj;     // 64 bytes
+    Mat4 view;     // 64 bytes
+    Vec4 textures; // 16 bytes, x = finest resident mip of the block texture array
+    Vec4 pad_0[3]; // 48 bytes, reserved
+    Mat4 pad_1;    // 64 bytes, reserved
 } GlobalsUBO;
 
+/**
+ * Small per-draw payload delivered through push constants, so per-chunk draws need
+ * neither a descriptor update nor a uniform write. Must stay within the 128 bytes
+ * every Vulkan implementation guarantees for `maxPushConstantsSize`.
+ */
+typedef struct DrawConstants {
+    Vec4 origin;  // 16 bytes, world-space origin of the draw (w unused)
+    u32 lod;      // 4 bytes, level of detail of the mesh
+    u32 material; // 4 bytes, material index
+    u32 pad_0;    // 4 bytes, reserved
+    u32 pad_1;    // 4 bytes, reserved
+} DrawConstants;
+
+/**
+ * A chunk mesh drawn through the GPU-driven path. The bounds are used for Hi-Z occlusion
+ * culling; the remaining fields describe the indexed draw. Layout matches the std430
+ * `ChunkDraw` struct in the culling shader.
+ */
+typedef struct ChunkDraw {
+    Vec4 bounds_min;   // 16 bytes, world-space AABB min (w unused)
+    Vec4 bounds_max;   // 16 bytes, world-space AABB max (w unused)
+    u32 index_count;   // 4 bytes
+    u32 first_index;   // 4 bytes
+    i32 vertex_offset; // 4 bytes
+    u32 pad_0;         // 4 bytes, reserved
+} ChunkDraw;
+
+/**
+ * Indexed range of the shared vertex and index buffers, drawn once per instance.
+ */
+typedef struct MeshRange {
+    u32 index_count;
+    u32 first_index;
+    i32 vertex_offset;
+} MeshRange;
+
+/**
+ * Compact per-instance transform for instanced draws (mobs, items, particles). Read by the
+ * vertex shader through a per-instance vertex binding.
+ */
+typedef struct InstanceData {
+    Vec4 position_scale; // 16 bytes, world-space position and uniform scale in w
+    f32 yaw;             // 4 bytes, rotation around +y in radians
+    u32 material;        // 4 bytes, material index
+    u32 pad_0;           // 4 bytes, reserved
+    u32 pad_1;           // 4 bytes, reserved
+} InstanceData;
+
 typedef struct RendererBackend {
     RenderBackend type;
     bool (*create)(const char* app_name, Window* window);
     void (*resize)(u16 width, u16 height);
+    void (*set_present_mode)(PresentMode mode);
+    // Blocks until the GPU released the resources of the next frame.
+    bool (*wait_frame)(void);
     bool (*begin_frame)(f32 dt);
     void (*update_globals)(Mat4 proj, Mat4 view);
+    void (*bind_pipeline)(RenderPipeline pipeline);
+    void (*draw)(MeshRange mesh, DrawConstants constants);
+    /**
+     * Draws `count` instances of the mesh. The instances are copied, so the array can be
+     * reused right away. Consecutive calls with the same mesh share a single draw call.
+     */
+    void (*draw_instanced)(MeshRange mesh, const InstanceData* instances, u32 count);
+    // Fraction of the framebuffer, per axis, the scene is rendered at before being upscaled.
+    void (*set_render_scale)(f32 scale);
+    // Returns true with the GPU time of a finished frame, once per measurement.
+    bool (*gpu_frame_time)(f32* frame_ms);
+    void (*set_chunk_draws)(const ChunkDraw* draws, u32 count);
+    /**
+     * Replaces the block texture array. Each name is loaded from `assets/textures/<name>.ppm`
+     * into the layer of the same index, which DrawConstants.material selects.
+     */
+    bool (*set_textures)(const char** names, u32 count, u32 size);
     bool (*end_frame)(f32 dt);
     void (*destroy)(void);
 } RendererBackend;
@@ -0,0 +1,54 @@
+#include "resolution_scaler.h"
+
+// Smallest change worth recreating the viewport for; keeps the scale from jittering.
+#define RESOLUTION_SCALE_STEP 0.01f
+
+static f32 clamp_f32(f32 value, f32 min, f32 max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+void resolution_scaler_create(f32 target_ms, ResolutionScaler* scaler) {
+    scaler->target_ms = target_ms;
+    scaler->kp = 0.15f;
+    scaler->ki = 0.1f;
+    scaler->integral = 0.0f;
+    scaler->sample_sum = 0.0f;
+    scaler->sample_count = 0;
+    scaler->scale = RESOLUTION_SCALE_MAX;
+}
+
+bool resolution_scaler_update(ResolutionScaler* scaler, f32 gpu_ms) {
+    if (scaler->target_ms <= 0.0f) {
+        return false;
+    }
+    scaler->sample_sum += gpu_ms;
+    scaler->sample_count++;
+    if (scaler->sample_count < RESOLUTION_SCALER_INTERVAL) {
+        return false;
+    }
+    f32 average = scaler->sample_sum / (f32)scaler->sample_count;
+    scaler->sample_sum = 0.0f;
+    scaler->sample_count = 0;
+
+    // Positive while under budget. A frame taking twice the target or more saturates it.
+    f32 error = clamp_f32((scaler->target_ms - average) / scaler->target_ms, -1.0f, 1.0f);
+
+    // The integral is bounded to the range the output can use, so a long overload can't wind
+    // it up and keep the scale low well after the load is gone. Full resolution is reached
+    // with an empty integral.
+    f32 integral_min = (RESOLUTION_SCALE_MIN - RESOLUTION_SCALE_MAX) / scaler->ki;
+    scaler->integral = clamp_f32(scaler->integral + error, integral_min, 0.0f);
+    f32 output = RESOLUTION_SCALE_MAX + scaler->kp * error + scaler->ki * scaler->integral;
+    output = clamp_f32(output, RESOLUTION_SCALE_MIN, RESOLUTION_SCALE_MAX);
+
+    f32 delta = output - scaler->scale;
+    if (delta > -RESOLUTION_SCALE_STEP && delta < RESOLUTION_SCALE_STEP &&
+        output != RESOLUTION_SCALE_MIN && output != RESOLUTION_SCALE_MAX) {
+        return false;
+    }
+    if (output == scaler->scale) {
+        return false;
+    }
+    scaler->scale = output;
+    return true;
+}
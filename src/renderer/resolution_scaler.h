@@ -0,0 +1,35 @@
+#ifndef RESOLUTION_SCALER_H
+#define RESOLUTION_SCALER_H
+
+#include "types.h"
+
+#define RESOLUTION_SCALE_MIN 0.5f
+#define RESOLUTION_SCALE_MAX 1.0f
+// GPU frame times averaged before each adjustment.
+#define RESOLUTION_SCALER_INTERVAL 8
+
+/**
+ * PI controller that picks the fraction of the framebuffer the scene is rendered at, so the
+ * measured GPU frame time holds at `target_ms`. The error is normalized by the target, which
+ * keeps the gains meaningful for any budget.
+ */
+typedef struct ResolutionScaler {
+    f32 target_ms;
+    f32 kp;
+    f32 ki;
+    f32 integral;
+    f32 sample_sum;
+    u32 sample_count;
+    // Scale currently applied, per axis.
+    f32 scale;
+} ResolutionScaler;
+
+void resolution_scaler_create(f32 target_ms, ResolutionScaler* scaler);
+
+/**
+ * Feeds the GPU time of one frame. Every RESOLUTION_SCALER_INTERVAL samples the average is
+ * compared against the target and the scale is adjusted. Returns true when `scale` changed.
+ */
+bool resolution_scaler_update(ResolutionScaler* scaler, f32 gpu_ms);
+
+#endif
@@ -0,0 +1,268 @@
+#include "texture.h"
+#include "core/job.h"
+#include "core/log.h"
+#include "core/mem.h"
+#include "core/str.h"
+#include "platform/fs.h"
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define CHECKERBOARD_CELL 8
+
+typedef struct BuildJob {
+    const char** names;
+    TextureArrayData* data;
+} BuildJob;
+
+static const u8* ppm_skip_space(const u8* cursor, const u8* end) {
+    while (cursor < end) {
+        if (*cursor == '#') {
+            while (cursor < end && *cursor != '\n') {
+                cursor++;
+            }
+        } else if (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n') {
+            cursor++;
+        } else {
+            break;
+        }
+    }
+    return cursor;
+}
+
+static const u8* ppm_read_u32(const u8* cursor, const u8* end, u32* value) {
+    cursor = ppm_skip_space(cursor, end);
+    if (cursor >= end || *cursor < '0' || *cursor > '9') {
+        return 0;
+    }
+    u32 result = 0;
+    while (cursor < end && *cursor >= '0' && *cursor <= '9') {
+        result = result * 10 + (*cursor - '0');
+        cursor++;
+    }
+    *value = result;
+    return cursor;
+}
+
+bool texture_load_ppm(const char* path, TextureImage* out) {
+    File file;
+    if (!fs_open(path, OPEN_FILE_MODE_READ_BINARY, &file)) {
+        return false;
+    }
+    u64 size = 0;
+    u8* bytes = fs_read_all(&file, &size);
+    fs_close(&file);
+    if (!bytes) {
+        return false;
+    }
+
+    const u8* end = bytes + size;
+    const u8* cursor = bytes;
+    u32 width = 0;
+    u32 height = 0;
+    u32 max_value = 0;
+    bool ok = size > 2 && bytes[0] == 'P' && bytes[1] == '6';
+    if (ok) {
+        cursor = ppm_read_u32(cursor + 2, end, &width);
+        cursor = cursor ? ppm_read_u32(cursor, end, &height) : 0;
+        cursor = cursor ? ppm_read_u32(cursor, end, &max_value) : 0;
+        // A single whitespace character separates the header from the pixels.
+        ok = cursor && cursor < end && width > 0 && height > 0 && max_value > 0 &&
+             max_value < 256 && (u64)(end - cursor - 1) >= (u64)width * height * 3;
+    }
+    if (!ok) {
+        WARN("Unsupported PPM file: %s", path);
+        mem_free(bytes);
+        return false;
+    }
+
+    const u8* rgb = cursor + 1;
+    out->width = width;
+    out->height = height;
+    out->pixels = mem_alloc_tagged((u64)width * height * 4, MEM_TAG_TEXTURE);
+    for (u64 i = 0; i < (u64)width * height; i++) {
+        out->pixels[i * 4 + 0] = rgb[i * 3 + 0];
+        out->pixels[i * 4 + 1] = rgb[i * 3 + 1];
+        out->pixels[i * 4 + 2] = rgb[i * 3 + 2];
+        out->pixels[i * 4 + 3] = 255;
+    }
+    mem_free(bytes);
+    return true;
+}
+
+void texture_checkerboard(u32 size, u32 color_a, u32 color_b, TextureImage* out) {
+    out->width = size;
+    out->height = size;
+    out->pixels = mem_alloc_tagged((u64)size * size * 4, MEM_TAG_TEXTURE);
+    for (u32 y = 0; y < size; y++) {
+        for (u32 x = 0; x < size; x++) {
+            bool odd = ((x / CHECKERBOARD_CELL) + (y / CHECKERBOARD_CELL)) & 1;
+            u32 color = odd ? color_b : color_a;
+            u8* pixel = &out->pixels[((u64)y * size + x) * 4];
+            pixel[0] = (color >> 24) & 0xFF;
+            pixel[1] = (color >> 16) & 0xFF;
+            pixel[2] = (color >> 8) & 0xFF;
+            pixel[3] = color & 0xFF;
+        }
+    }
+}
+
+void texture_image_free(TextureImage* image) {
+    if (image->pixels) {
+        mem_free(image->pixels);
+    }
+    image->pixels = 0;
+    image->width = 0;
+    image->height = 0;
+}
+
+u32 texture_mip_count(u32 size) {
+    u32 count = 1;
+    while (size > 1) {
+        size >>= 1;
+        count++;
+    }
+    return count;
+}
+
+static void downsample_scalar(const u8* row_a, const u8* row_b, u32 x_a, u32 x_b, u8* dst) {
+    for (u32 c = 0; c < 4; c++) {
+        u32 sum = row_a[x_a * 4 + c] + row_a[x_b * 4 + c] + row_b[x_a * 4 + c] +
+                  row_b[x_b * 4 + c];
+        dst[c] = (u8)((sum + 2) >> 2);
+    }
+}
+
+void texture_downsample(const u8* src, u32 width, u32 height, u8* dst) {
+    u32 dst_width = width > 1 ? width / 2 : 1;
+    u32 dst_height = height > 1 ? height / 2 : 1;
+    for (u32 y = 0; y < dst_height; y++) {
+        const u8* row_a = src + (u64)(height > 1 ? y * 2 : 0) * width * 4;
+        const u8* row_b = src + (u64)(height > 1 ? y * 2 + 1 : 0) * width * 4;
+        u8* out = dst + (u64)y * dst_width * 4;
+        u32 x = 0;
+        if (width > 1) {
+#if defined(__SSE2__)
+            // Four source pixels per row become two destination pixels.
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i round = _mm_set1_epi16(2);
+            for (; x + 2 <= dst_width; x += 2) {
+                __m128i a = _mm_loadu_si128((const __m128i*)(row_a + x * 8));
+                __m128i b = _mm_loadu_si128((const __m128i*)(row_b + x * 8));
+                __m128i low =
+                    _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                __m128i high =
+                    _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+                // Add each pixel to its right neighbour, both sums end up in the low halves.
+                low = _mm_add_epi16(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+                high = _mm_add_epi16(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+                __m128i sum = _mm_unpacklo_epi64(low, high);
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, round), 2);
+                _mm_storel_epi64((__m128i*)(out + x * 4), _mm_packus_epi16(sum, sum));
+            }
+#endif
+            for (; x < dst_width; x++) {
+                downsample_scalar(row_a, row_b, x * 2, x * 2 + 1, out + x * 4);
+            }
+        } else {
+            downsample_scalar(row_a, row_b, 0, 0, out);
+        }
+    }
+}
+
+static u8* layer_pixels(TextureArrayData* data, u32 level, u32 layer) {
+    u64 layer_size = data->level_sizes[level] / data->layer_count;
+    return data->pixels + data->level_offsets[level] + layer_size * layer;
+}
+
+// Loads the named texture and halves it until it matches `size`. Leaves `image` empty when
+// the file is missing or cannot be brought to the layer size.
+static void load_layer_image(const char* name, u32 size, TextureImage* image) {
+    char path[256];
+    str_format(path, 256, "assets/textures/%s.ppm", name);
+    if (!texture_load_ppm(path, image)) {
+        WARN("Could not load texture %s. Using a placeholder.", path);
+        return;
+    }
+    while (image->width > size && image->width % 2 == 0 && image->height % 2 == 0) {
+        TextureImage half = {0};
+        half.width = image->width / 2;
+        half.height = image->height / 2;
+        half.pixels = mem_alloc_tagged((u64)half.width * half.height * 4, MEM_TAG_TEXTURE);
+        texture_downsample(image->pixels, image->width, image->height, half.pixels);
+        texture_image_free(image);
+        *image = half;
+    }
+    if (image->width != size || image->height != size) {
+        WARN("Texture %s is %dx%d, expected %dx%d. Using a placeholder.", path, image->width,
+             image->height, size, size);
+        texture_image_free(image);
+    }
+}
+
+static void build_layer(const char* name, TextureArrayData* data, u32 layer) {
+    TextureImage image = {0};
+    if (name) {
+        load_layer_image(name, data->size, &image);
+    }
+    if (!image.pixels) {
+        texture_checkerboard(data->size, 0xFF00FFFF, 0x000000FF, &image);
+    }
+
+    mem_copy(layer_pixels(data, 0, layer), image.pixels, (u64)data->size * data->size * 4);
+    texture_image_free(&image);
+
+    u32 size = data->size;
+    for (u32 level = 1; level < data->mip_levels; level++) {
+        texture_downsample(layer_pixels(data, level - 1, layer), size, size,
+                           layer_pixels(data, level, layer));
+        size /= 2;
+    }
+}
+
+static void build_layers(u32 start, u32 end, void* arg) {
+    BuildJob* job = arg;
+    for (u32 layer = start; layer < end; layer++) {
+        build_layer(job->names ? job->names[layer] : 0, job->data, layer);
+    }
+}
+
+bool texture_array_build(const char** names, u32 count, u32 size, TextureArrayData* out) {
+    if (count == 0 || size == 0 || (size & (size - 1)) != 0) {
+        ERROR("Texture arrays need at least one layer and a power of two size.");
+        return false;
+    }
+    u32 mip_levels = texture_mip_count(size);
+    if (mip_levels > TEXTURE_MAX_MIP_LEVELS) {
+        ERROR("Texture array size %d is too large.", size);
+        return false;
+    }
+
+    out->size = size;
+    out->layer_count = count;
+    out->mip_levels = mip_levels;
+    u64 total = 0;
+    for (u32 level = 0; level < mip_levels; level++) {
+        u64 level_size = (u64)(size >> level) * (size >> level) * 4 * count;
+        out->level_offsets[level] = total;
+        out->level_sizes[level] = level_size;
+        total += level_size;
+    }
+    out->pixels = mem_alloc_tagged(total, MEM_TAG_TEXTURE);
+
+    // Layers are independent, so they are spread over the job system one by one.
+    BuildJob job = {names, out};
+    parallel_for(count, 1, build_layers, &job);
+    return true;
+}
+
+void texture_array_free(TextureArrayData* data) {
+    if (data->pixels) {
+        mem_free(data->pixels);
+    }
+    data->pixels = 0;
+    data->layer_count = 0;
+    data->mip_levels = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "types.h"
+
+// Enough levels for a 4096x4096 layer.
+#define TEXTURE_MAX_MIP_LEVELS 13
+
+/**
+ * An RGBA8 image in CPU memory.
+ */
+typedef struct TextureImage {
+    u32 width;
+    u32 height;
+    u8* pixels;
+} TextureImage;
+
+/**
+ * Square RGBA8 layers of the same size with their full mip chains, ready to be uploaded
+ * into a 2D texture array. Pixels are stored level-major: every layer of mip 0, then every
+ * layer of mip 1, and so on, so each level can be copied with a single region.
+ */
+typedef struct TextureArrayData {
+    u32 size;
+    u32 layer_count;
+    u32 mip_levels;
+    u64 level_offsets[TEXTURE_MAX_MIP_LEVELS];
+    u64 level_sizes[TEXTURE_MAX_MIP_LEVELS];
+    u8* pixels;
+} TextureArrayData;
+
+/**
+ * Loads a binary (P6) PPM file with an 8-bit max value.
+ */
+bool texture_load_ppm(const char* path, TextureImage* out);
+
+/**
+ * Fills a size x size image with an 8x8 cell checkerboard of the two RGBA colors.
+ */
+void texture_checkerboard(u32 size, u32 color_a, u32 color_b, TextureImage* out);
+
+void texture_image_free(TextureImage* image);
+
+u32 texture_mip_count(u32 size);
+
+/**
+ * Writes the 2x2 box filtered version of `src` into `dst`, which must hold
+ * max(width / 2, 1) x max(height / 2, 1) pixels.
+ */
+void texture_downsample(const u8* src, u32 width, u32 height, u8* dst);
+
+/**
+ * Loads `assets/textures/<name>.ppm` for every name into its own layer and generates the mip
+ * chains on the job system. Images larger than `size` are halved until they fit; missing or
+ * mismatched images are replaced by a checkerboard so the layer index stays valid.
+ * Passing no names builds `count` checkerboard layers. `size` must be a power of two.
+ */
+bool texture_array_build(const char** names, u32 count, u32 size, TextureArrayData* out);
+void texture_array_free(TextureArrayData* data);
+
+#endif
@@ -1,16 +1,27 @@
 #include "vulkan_backend.h"
 #include "collections/vector.h"
+#include "core/job.h"
 #include "core/log.h"
 #include "core/mem.h"
 #include "core/str.h"
 #include "defines.h"
+#include "math/lineal.h"
+#include "platform/platform.h"
 #include "vulkan_buffer.h"
 #include "vulkan_command_buffer.h"
+#include "vulkan_deletion_queue.h"
+#include "vulkan_descriptor_set.h"
 #include "vulkan_device.h"
+#include "vulkan_gpu_timer.h"
+#include "vulkan_hiz.h"
+#include "vulkan_instancing.h"
 #include "vulkan_renderpass.h"
 #include "vulkan_shader.h"
 #include "vulkan_swapchain.h"
+#include "vulkan_texture.h"
+#include "vulkan_timeline.h"
 #include "vulkan_types.h"
+#include "vulkan_upload.h"
 #include "vulkan_utils.h"
 #include "window.h"
 
@@ -21,17 +32,77 @@ VkBool32 vulkan_debug_callback(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
 
 i32 find_memory_Type(u32 type_filter, VkMemoryPropertyFlags properties);
 static void allocate_command_buffers(VulkanBackend* backend);
-static void create_framebuffers(VulkanBackend* backend);
+static void create_framebuffer(VulkanBackend* backend);
+static void update_scene_extent(void);
 static bool recreate_swapchain(void);
-
-static void buffer_data_transfer(VulkanBackend* ctx, VkCommandPool pool, VkFence fence,
-                                 VkQueue queue, Buffer* dst, u64 dst_offset, u64 size, void* data);
+static Mat4 globals_view_proj(void);
+static void draw_culled_chunks(CommandBuffer* command_buffer);
+
+static bool create_frame_resources(void);
+static bool upload_quad(void);
+
+#define STARTUP_MAX_STAGES 16
+
+// Wall time of one startup stage. Stages run on the worker overlap the ones that don't.
+typedef struct StartupStage {
+    const char* name;
+    f64 ms;
+    bool worker;
+} StartupStage;
+
+typedef struct StartupTimings {
+    StartupStage stages[STARTUP_MAX_STAGES];
+    u32 count;
+} StartupTimings;
+
+// Loads the shader modules and compiles the pipelines, which only need the device and the
+// main render pass, while the calling thread builds everything that depends on the swapchain.
+typedef struct ShaderJob {
+    bool ok;
+    // False when the job ended up running on the calling thread.
+    bool worker;
+    f64 load_ms;
+    f64 compile_ms;
+} ShaderJob;
 
 static VulkanBackend backend;
+static StartupTimings startup;
+
+static void startup_record(const char* name, f64 ms, bool worker) {
+    if (startup.count < STARTUP_MAX_STAGES) {
+        StartupStage* stage = &startup.stages[startup.count++];
+        stage->name = name;
+        stage->ms = ms;
+        stage->worker = worker;
+    }
+}
+
+// Records the time since `since` under `name` and returns the current time.
+static f64 startup_stage(const char* name, f64 since) {
+    f64 now = platform_system_time();
+    startup_record(name, (now - since) * 1000.0, false);
+    return now;
+}
+
+static void shader_job(void* arg) {
+    ShaderJob* job = arg;
+    job->worker = job_thread_index() != 0;
+    f64 start = platform_system_time();
+    job->ok = vulkan_shader_load_modules(&backend, &backend.basic_shader);
+    f64 loaded = platform_system_time();
+    job->ok = job->ok && vulkan_shader_create_pipelines(&backend, &backend.basic_shader);
+    job->load_ms = (loaded - start) * 1000.0;
+    job->compile_ms = (platform_system_time() - loaded) * 1000.0;
+}
 
 bool vulkan_backend_create(const char* app_name, Window* window) {
+    f64 start = platform_system_time();
+    f64 time = start;
+    startup.count = 0;
 
     backend.find_memory_type = find_memory_Type;
+    backend.present_mode = PRESENT_MODE_MAILBOX;
+    backend.render_scale = 1.0f;
 
     window_get_framebuffer_size(window, &backend.framebuffer_width, &backend.framebuffer_height);
 
@@ -121,34 +192,90 @@ bool vulkan_backend_create(const char* app_name, Window* window) {
 
     window_create_vulkan_surface(window, &backend);
     DEBUG("Vulkan Surface created");
+    time = startup_stage("instance", time);
 
     if (!vulkan_device_create(&backend)) {
         ERROR("Failed to create Vulkan Device");
         return false;
     }
     DEBUG("Vulkan Device created");
+    time = startup_stage("device", time);
+
+    // Render passes only need the attachment formats, so they are created ahead of the
+    // swapchain and the pipelines can be compiled while it is being set up.
+    vulkan_swapchain_select_format(&backend, &backend.swapchain);
+    if (!vulkan_device_detect_depth_format(&backend.device)) {
+        ERROR("Failed to find a supported Depth format for the current device.");
+        return false;
+    }
+    Vec4 area = (Vec4){0, 0, backend.framebuffer_width, backend.framebuffer_height};
+    Vec4 clear_color = (Vec4){0.4, 0.5, 0.6, 1.0};
+    vulkan_renderpass_create(&backend, area, clear_color, 1.0f, 0.0f, true, &backend.main_pass);
+    vulkan_renderpass_create(&backend, area, clear_color, 1.0f, 0.0f, false,
+                             &backend.main_pass_load);
+    DEBUG("Vulkan Main Renderpass created");
+    time = startup_stage("render passes", time);
+
+    ShaderJob shader_job_data = {0};
+    JobCounter shader_counter = {0};
+    job_run(shader_job, &shader_job_data, &shader_counter);
+    bool frame_resources_ok = create_frame_resources();
+    time = platform_system_time();
+    // Runs the job here if no worker has picked it up yet.
+    job_wait(&shader_counter);
+    startup_record("shader modules", shader_job_data.load_ms, shader_job_data.worker);
+    startup_record("pipelines", shader_job_data.compile_ms, shader_job_data.worker);
+    // Time the calling thread spent idle because the worker finished last.
+    time = startup_stage("worker wait", time);
+    if (!frame_resources_ok) {
+        return false;
+    }
+    if (!shader_job_data.ok) {
+        ERROR("Failed to create Vulkan Shader");
+        return false;
+    }
+
+    vulkan_shader_create_resources(&backend, &backend.basic_shader);
+    time = startup_stage("shader resources", time);
+    // Keeps the texture binding valid until the application provides its block textures.
+    if (!vulkan_backend_set_textures(0, 1, 16)) {
+        ERROR("Failed to create Vulkan placeholder textures");
+        return false;
+    }
+    startup_stage("textures", time);
+
+    INFO("Vulkan Backend initializated in %.2f ms", (platform_system_time() - start) * 1000.0);
+    for (u32 i = 0; i < startup.count; i++) {
+        StartupStage* stage = &startup.stages[i];
+        INFO(" - %-18s %8.2f ms%s", stage->name, stage->ms, stage->worker ? " (worker)" : "");
+    }
+    return true;
+}
+
+// Everything that depends on the swapchain. Runs on the calling thread while the shader job
+// compiles the pipelines.
+static bool create_frame_resources(void) {
+    f64 time = platform_system_time();
     if (!vulkan_swapchain_create(&backend, backend.framebuffer_width, backend.framebuffer_height,
                                  &backend.swapchain)) {
         ERROR("Failed to create Vulkan Swapchain");
         return false;
     }
     DEBUG("Vulkan Swapchain created");
-    Vec4 area = (Vec4){0, 0, backend.framebuffer_width, backend.framebuffer_height};
-    Vec4 clear_color = (Vec4){0.4, 0.5, 0.6, 1.0};
-    vulkan_renderpass_create(&backend, area, clear_color, 1.0f, 0.0f, &backend.main_pass);
-    DEBUG("Vulkan Main Renderpass created");
+    time = startup_stage("swapchain", time);
     allocate_command_buffers(&backend);
     DEBUG("Vulkan Command Buffers allocated");
-    backend.framebuffers = vector_with_capacity(VkFramebuffer, backend.swapchain.image_count);
-    create_framebuffers(&backend);
-    DEBUG("Vulkan Framebuffers created");
+    create_framebuffer(&backend);
+    DEBUG("Vulkan Framebuffer created");
+    if (!vulkan_gpu_timer_create(&backend, backend.swapchain.image_count, &backend.gpu_timer)) {
+        return false;
+    }
     // Create sync objects
     backend.image_available_semaphores =
         vector_with_capacity(VkSemaphore, backend.swapchain.max_frames_in_flight);
     backend.queue_complete_semaphores =
         vector_with_capacity(VkSemaphore, backend.swapchain.max_frames_in_flight);
-    backend.in_flight_fences =
-        vector_with_capacity(VkFence, backend.swapchain.max_frames_in_flight);
+    backend.in_flight_values = vector_with_capacity(u64, backend.swapchain.max_frames_in_flight);
 
     for (u32 i = 0; i < backend.swapchain.max_frames_in_flight; i++) {
         VkSemaphoreCreateInfo semaphore_info = {0};
@@ -157,22 +284,47 @@ bool vulkan_backend_create(const char* app_name, Window* window) {
                                       &backend.image_available_semaphores[i]));
         VK_FN_CHECK(vkCreateSemaphore(backend.device.logical, &semaphore_info, backend.allocator,
                                       &backend.queue_complete_semaphores[i]));
-
-        VkFenceCreateInfo fence_info = {0};
-        fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-        VK_FN_CHECK(vkCreateFence(backend.device.logical, &fence_info, backend.allocator,
-                                  &backend.in_flight_fences[i]));
+        backend.in_flight_values[i] = 0;
     }
-    backend.images_in_flight = mem_alloc(sizeof(VkFence) * backend.swapchain.image_count);
+    VkQueue timeline_queues[TIMELINE_QUEUE_COUNT] = {
+        backend.device.graphics_queue,
+        backend.device.transfer_queue,
+        backend.device.compute_queue,
+    };
+    for (u32 i = 0; i < TIMELINE_QUEUE_COUNT; i++) {
+        if (!vulkan_timeline_create(&backend, timeline_queues[i], &backend.timelines[i])) {
+            return false;
+        }
+    }
+    vulkan_deletion_queue_create(&backend.deletion_queue);
+    vulkan_upload_create(&backend.uploads);
+    backend.images_in_flight =
+        mem_alloc_tagged(sizeof(u64) * backend.swapchain.image_count, MEM_TAG_RENDERER);
     for (u32 i = 0; i < backend.swapchain.image_count; i++) {
         backend.images_in_flight[i] = 0;
     }
-    if (!vulkan_shader_create(&backend, &backend.basic_shader)) {
-        ERROR("Failed to create Vulkan Shader");
+    time = startup_stage("frame resources", time);
+    if (!vulkan_instancing_create(&backend, backend.swapchain.max_frames_in_flight,
+                                  &backend.instancing)) {
+        ERROR("Failed to create Vulkan instance buffers");
         return false;
     }
+    if (!upload_quad()) {
+        ERROR("Failed to upload the Vulkan geometry buffers");
+        return false;
+    }
+    time = startup_stage("geometry", time);
+    if (!vulkan_hiz_create(&backend, &backend.hiz)) {
+        ERROR("Failed to create Vulkan Hi-Z");
+        return false;
+    }
+    startup_stage("hi-z", time);
+    return true;
+}
 
+// Creates the shared vertex and index buffers and uploads the quad through the transfer queue.
+// The first frame waits for the copy on the GPU; nothing blocks here.
+static bool upload_quad(void) {
     VkMemoryPropertyFlags memory_flags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
     u64 vertex_buffer_size = sizeof(Vertex) * 1024 * 1024;
     vulkan_buffer_create(&backend,
@@ -192,32 +344,27 @@ bool vulkan_backend_create(const char* app_name, Window* window) {
     const u32 vertices = 4;
     Vertex verts[vertices];
 
-    verts[0].pos.x = -0.5f;
-    verts[0].pos.y = -0.5f;
+    verts[0].pos = (Vec3){{-0.5f, -0.5f, 0.0f}};
+    verts[0].uv = (Vec2){{0.0f, 1.0f}};
 
-    verts[1].pos.x = 0.5f;
-    verts[1].pos.y = -0.5f;
+    verts[1].pos = (Vec3){{0.5f, -0.5f, 0.0f}};
+    verts[1].uv = (Vec2){{1.0f, 1.0f}};
 
-    verts[2].pos.x = 0.5f;
-    verts[2].pos.y = 0.5f;
+    verts[2].pos = (Vec3){{0.5f, 0.5f, 0.0f}};
+    verts[2].uv = (Vec2){{1.0f, 0.0f}};
 
-    verts[3].pos.x = -0.5f;
-    verts[3].pos.y = 0.5f;
+    verts[3].pos = (Vec3){{-0.5f, 0.5f, 0.0f}};
+    verts[3].uv = (Vec2){{0.0f, 0.0f}};
 
-    buffer_data_transfer(&backend, backend.device.graphics_command_pool, 0,
-                         backend.device.graphics_queue, &backend.vertex_buffer, 0,
+    vulkan_upload_buffer(&backend, &backend.uploads, &backend.vertex_buffer, 0,
                          sizeof(Vertex) * vertices, verts);
 
     const u32 indices = 6;
     u32 indices_data[] = {0, 1, 2, 2, 3, 0};
 
-    buffer_data_transfer(&backend, backend.device.graphics_command_pool, 0,
-                         backend.device.graphics_queue, &backend.index_buffer, 0,
+    vulkan_upload_buffer(&backend, &backend.uploads, &backend.index_buffer, 0,
                          sizeof(u32) * indices, indices_data);
-
-    INFO("Vulkan Backend initializated");
-
-    return true;
+    return vulkan_upload_submit(&backend, &backend.uploads);
 }
 
 void vulkan_backend_resize(u16 width, u16 height) {
@@ -227,6 +374,26 @@ void vulkan_backend_resize(u16 width, u16 height) {
     INFO("Resizing backend to: (%dx%d)", width, height);
 }
 
+void vulkan_backend_set_present_mode(PresentMode mode) {
+    if (mode == backend.present_mode) {
+        return;
+    }
+    backend.present_mode = mode;
+    // The present mode is fixed at swapchain creation.
+    backend.swapchain_needs_resize = true;
+}
+
+bool vulkan_backend_wait_frame(void) {
+    // Wait for the last submit that used this frame slot to be completed.
+    Timeline* graphics = &backend.timelines[TIMELINE_QUEUE_GRAPHICS];
+    if (!vulkan_timeline_wait(&backend, graphics, backend.in_flight_values[backend.current_frame],
+                              UINT64_MAX)) {
+        ERROR("Failed to wait for in flight frame");
+        return false;
+    }
+    return true;
+}
+
 bool vulkan_backend_begin_frame(f32 dt) {
     Device* device = &backend.device;
 
@@ -250,14 +417,14 @@ bool vulkan_backend_begin_frame(f32 dt) {
         return false;
     }
 
-    // Wait for the current frame to be completed.
-    VkResult result = vkWaitForFences(
-        device->logical, 1, &backend.in_flight_fences[backend.current_frame], VK_TRUE, UINT64_MAX);
-
-    if (result != VK_SUCCESS) {
-        ERROR("Failed to wait for InFlight fence");
+    // Returns at once if the application already waited for this frame.
+    if (!vulkan_backend_wait_frame()) {
         return false;
     }
+    Timeline* graphics = &backend.timelines[TIMELINE_QUEUE_GRAPHICS];
+    vulkan_deletion_queue_flush(&backend, &backend.deletion_queue,
+                                vulkan_timeline_completed(&backend, graphics));
+    vulkan_upload_collect(&backend, &backend.uploads);
 
     if (!vulkan_swapchain_acquire_next_image(
             &backend, backend.image_available_semaphores[backend.current_frame], 0,
@@ -266,32 +433,45 @@ bool vulkan_backend_begin_frame(f32 dt) {
         return false;
     }
 
+    // The wait above released this slot's instance buffer.
+    vulkan_instancing_begin(&backend.instancing, backend.current_frame);
+
     CommandBuffer* gfx_cmdbuf = &backend.graphics_command_buffers[backend.image_index];
     vkResetCommandBuffer(gfx_cmdbuf->handle, 0);
     vulkan_command_buffer_begin(gfx_cmdbuf, false, false, false);
+    vulkan_gpu_timer_begin(&backend, &backend.gpu_timer, gfx_cmdbuf, backend.image_index);
+    vulkan_upload_acquire(&backend, &backend.uploads, gfx_cmdbuf);
+
+    update_scene_extent();
+    vulkan_texture_array_stream(&backend, &backend.block_textures, gfx_cmdbuf);
+    if (backend.hiz.chunk_count > 0) {
+        vulkan_hiz_cull(&backend, &backend.hiz, gfx_cmdbuf, HIZ_CULL_PHASE_EARLY,
+                        globals_view_proj());
+    }
     vulkan_shader_bind(&backend, &backend.basic_shader);
 
+    // The scene only covers the top-left region of its target that matches the render scale.
     VkViewport viewport = {0};
     viewport.x = 0.0f;
-    viewport.y = backend.framebuffer_height;
-    viewport.width = (f32)backend.framebuffer_width;
-    viewport.height = -(f32)backend.framebuffer_height;
+    viewport.y = backend.scene_height;
+    viewport.width = (f32)backend.scene_width;
+    viewport.height = -(f32)backend.scene_height;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
 
     VkRect2D scissor;
     scissor.offset.x = scissor.offset.y = 0;
-    scissor.extent.width = backend.framebuffer_width;
-    scissor.extent.height = backend.framebuffer_height;
+    scissor.extent.width = backend.scene_width;
+    scissor.extent.height = backend.scene_height;
 
     vkCmdSetViewport(gfx_cmdbuf->handle, 0, 1, &viewport);
     vkCmdSetScissor(gfx_cmdbuf->handle, 0, 1, &scissor);
 
-    backend.main_pass.render_area.width = backend.framebuffer_width;
-    backend.main_pass.render_area.height = backend.framebuffer_height;
+    backend.main_pass.render_area.width = backend.scene_width;
+    backend.main_pass.render_area.height = backend.scene_height;
+    backend.main_pass_load.render_area = backend.main_pass.render_area;
 
-    vulkan_renderpass_begin(&backend, &backend.main_pass, gfx_cmdbuf,
-                            backend.framebuffers[backend.image_index]);
+    vulkan_renderpass_begin(&backend, &backend.main_pass, gfx_cmdbuf, backend.framebuffer);
     return true;
 }
 
@@ -299,6 +479,7 @@ void vulkan_backend_update_globals(Mat4 proj, Mat4 view) {
     CommandBuffer* gfx_cmdbuf = &backend.graphics_command_buffers[backend.image_index];
     backend.basic_shader.globals.proj = proj;
     backend.basic_shader.globals.view = view;
+    backend.basic_shader.globals.textures.x = (f32)backend.block_textures.resident_mip;
     Shader* shader = &backend.basic_shader;
 
     Buffer* globals_buffer = shader->globals_buffer;
@@ -309,44 +490,116 @@ void vulkan_backend_update_globals(Mat4 proj, Mat4 view) {
                             shader->pipeline.layout, 0, 1, &shader->descriptor_sets[0], 0, 0);
     vkCmdBindVertexBuffers(gfx_cmdbuf->handle, 0, 1, &backend.vertex_buffer.handle, offsets);
     vkCmdBindIndexBuffer(gfx_cmdbuf->handle, backend.index_buffer.handle, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdDrawIndexed(gfx_cmdbuf->handle, 6, 1, 0, 0, 0);
+}
+
+void vulkan_backend_bind_pipeline(RenderPipeline pipeline) {
+    switch (pipeline) {
+    case RENDER_PIPELINE_OPAQUE:
+    default:
+        vulkan_shader_bind(&backend, &backend.basic_shader);
+        break;
+    }
+}
+
+void vulkan_backend_draw(MeshRange mesh, DrawConstants constants) {
+    CommandBuffer* gfx_cmdbuf = &backend.graphics_command_buffers[backend.image_index];
+    vulkan_shader_push_constants(&backend, &backend.basic_shader, 0, sizeof(DrawConstants),
+                                 &constants);
+    vkCmdDrawIndexed(gfx_cmdbuf->handle, mesh.index_count, 1, mesh.first_index,
+                     mesh.vertex_offset, 0);
+}
+
+void vulkan_backend_draw_instanced(MeshRange mesh, const InstanceData* instances, u32 count) {
+    // Recorded at the end of the main pass, after every non-instanced draw.
+    vulkan_instancing_push(&backend.instancing, mesh, instances, count);
+}
+
+bool vulkan_backend_set_textures(const char** names, u32 count, u32 size) {
+    TextureArrayData data = {0};
+    if (!texture_array_build(names, count, size, &data)) {
+        return false;
+    }
+    TextureArray textures = {0};
+    bool created = vulkan_texture_array_create(&backend, &data, &textures);
+    texture_array_free(&data);
+    if (!created) {
+        vulkan_texture_array_destroy(&backend, &textures);
+        return false;
+    }
+
+    // Every frame binds the same descriptor set, so the old array must be idle before the
+    // descriptor is rewritten.
+    Timeline* graphics = &backend.timelines[TIMELINE_QUEUE_GRAPHICS];
+    vulkan_timeline_wait(&backend, graphics, graphics->value, UINT64_MAX);
+    vulkan_texture_array_destroy(&backend, &backend.block_textures);
+    backend.block_textures = textures;
+    vulkan_descriptor_set_update_texture(&backend, backend.basic_shader.descriptor_sets,
+                                         &backend.block_textures,
+                                         backend.swapchain.max_frames_in_flight);
+    return true;
+}
+
+void vulkan_backend_set_render_scale(f32 scale) {
+    // Takes effect with the next frame; the scene target itself keeps its size.
+    backend.render_scale = CLAMP(scale, 0.1f, 1.0f);
+}
+
+bool vulkan_backend_gpu_frame_time(f32* frame_ms) {
+    return vulkan_gpu_timer_read(&backend.gpu_timer, frame_ms);
+}
+
+void vulkan_backend_set_chunk_draws(const ChunkDraw* draws, u32 count) {
+    vulkan_hiz_set_chunks(&backend, &backend.hiz, draws, count);
 }
 
 bool vulkan_backend_end_frame(f32 dt) {
     CommandBuffer* gfx_cmdbuf = &backend.graphics_command_buffers[backend.image_index];
+    bool draw_chunks = backend.hiz.chunk_count > 0;
+    if (draw_chunks) {
+        // Early phase: chunks visible last frame.
+        draw_culled_chunks(gfx_cmdbuf);
+    }
+    vulkan_instancing_draw(&backend, &backend.instancing, &backend.basic_shader, gfx_cmdbuf);
     vulkan_renderpass_end(&backend.main_pass, gfx_cmdbuf);
+
+    if (draw_chunks) {
+        // Late phase: test everything against the early depth and draw what became visible.
+        vulkan_hiz_build(&backend, &backend.hiz, gfx_cmdbuf);
+        vulkan_hiz_cull(&backend, &backend.hiz, gfx_cmdbuf, HIZ_CULL_PHASE_LATE,
+                        globals_view_proj());
+        vulkan_renderpass_begin(&backend, &backend.main_pass_load, gfx_cmdbuf,
+                                backend.framebuffer);
+        vulkan_shader_bind(&backend, &backend.basic_shader);
+        draw_culled_chunks(gfx_cmdbuf);
+        vulkan_renderpass_end(&backend.main_pass_load, gfx_cmdbuf);
+    }
+    vulkan_swapchain_blit_scene(&backend.swapchain, gfx_cmdbuf, backend.image_index,
+                                backend.scene_width, backend.scene_height);
+    vulkan_gpu_timer_end(&backend.gpu_timer, gfx_cmdbuf, backend.image_index);
     vulkan_command_buffer_end(gfx_cmdbuf);
-    if (backend.images_in_flight[backend.image_index] != VK_NULL_HANDLE) {
-        vkWaitForFences(backend.device.logical, 1, backend.images_in_flight[backend.image_index],
-                        VK_TRUE, UINT64_MAX);
-    }
-    backend.images_in_flight[backend.image_index] =
-        &backend.in_flight_fences[backend.current_frame];
-
-    // Reset the fence so that it can be reused in the next frame
-    vkResetFences(backend.device.logical, 1, &backend.in_flight_fences[backend.current_frame]);
-
-    VkSubmitInfo submit_info = {0};
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    // Each semaphore will wait on a pipeline stage to complete
-    // In this case, we want to wait for the color attachment output stage
-    // which means one frame will be presented at a time
-    VkPipelineStageFlags wait_stages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submit_info.pWaitDstStageMask = wait_stages;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &gfx_cmdbuf->handle;
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = &backend.queue_complete_semaphores[backend.current_frame];
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &backend.image_available_semaphores[backend.current_frame];
-
-    VkResult submit_result = vkQueueSubmit(backend.device.graphics_queue, 1, &submit_info,
-                                           backend.in_flight_fences[backend.current_frame]);
-
-    if (submit_result != VK_SUCCESS) {
-        ERROR("Failed to submit work.");
+    // The image may still be in use by a submit from another frame slot.
+    Timeline* graphics = &backend.timelines[TIMELINE_QUEUE_GRAPHICS];
+    vulkan_timeline_wait(&backend, graphics, backend.images_in_flight[backend.image_index],
+                         UINT64_MAX);
+
+    // The swapchain image is first touched by the blit, so only the transfer stage has to wait
+    // until it is acquired; the scene itself renders meanwhile.
+    TimelineWait waits[2] = {0};
+    waits[0].semaphore = backend.image_available_semaphores[backend.current_frame];
+    waits[0].stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    u32 wait_count = 1;
+    if (vulkan_upload_wait(&backend, &backend.uploads, &waits[1])) {
+        wait_count++;
+    }
+
+    u64 submit_value = 0;
+    if (!vulkan_timeline_submit(&backend, graphics, 1, &gfx_cmdbuf->handle, wait_count, waits,
+                                backend.queue_complete_semaphores[backend.current_frame],
+                                &submit_value)) {
         return false;
     }
+    backend.in_flight_values[backend.current_frame] = submit_value;
+    backend.images_in_flight[backend.image_index] = submit_value;
 
     vulkan_command_buffer_set_submitted(gfx_cmdbuf);
 
@@ -378,25 +631,42 @@ static bool recreate_swapchain(void) {
     vulkan_swapchain_recreate(&backend, backend.framebuffer_width, backend.framebuffer_height,
                               &backend.swapchain);
 
-    backend.main_pass.render_area.width = backend.framebuffer_width;
-    backend.main_pass.render_area.height = backend.framebuffer_height;
+    update_scene_extent();
+    backend.main_pass.render_area.width = backend.scene_width;
+    backend.main_pass.render_area.height = backend.scene_height;
+    backend.main_pass_load.render_area = backend.main_pass.render_area;
+
+    vulkan_hiz_resize(&backend, &backend.hiz);
 
     for (u32 i = 0; i < backend.swapchain.image_count; i++) {
         vulkan_command_buffer_free(&backend, backend.device.graphics_command_pool,
                                    &backend.graphics_command_buffers[i]);
     }
 
-    for (u32 i = 0; i < backend.swapchain.image_count; i++) {
-        vkDestroyFramebuffer(backend.device.logical, backend.framebuffers[i], backend.allocator);
-    }
+    vkDestroyFramebuffer(backend.device.logical, backend.framebuffer, backend.allocator);
+    vulkan_gpu_timer_destroy(&backend, &backend.gpu_timer);
 
-    create_framebuffers(&backend);
+    create_framebuffer(&backend);
     allocate_command_buffers(&backend);
+    vulkan_gpu_timer_create(&backend, backend.swapchain.image_count, &backend.gpu_timer);
     backend.recreating_swapchain = false;
     backend.swapchain_needs_resize = false;
     return true;
 }
 
+// Matches `globals.proj * globals.view` in the shaders.
+static Mat4 globals_view_proj(void) {
+    return mat4_mul(backend.basic_shader.globals.view, backend.basic_shader.globals.proj);
+}
+
+static void draw_culled_chunks(CommandBuffer* command_buffer) {
+    // Chunk meshes are stored in world space.
+    DrawConstants constants = {0};
+    vulkan_shader_push_constants(&backend, &backend.basic_shader, 0, sizeof(DrawConstants),
+                                 &constants);
+    vulkan_hiz_draw(&backend, &backend.hiz, command_buffer);
+}
+
 // Checks the available memory types and returns the index of the first one that
 // matches the filter and has all the required properties.
 i32 find_memory_Type(u32 type_filter, VkMemoryPropertyFlags properties) {
@@ -423,28 +693,34 @@ static void allocate_command_buffers(VulkanBackend* backend) {
     }
 }
 
-static void create_framebuffers(VulkanBackend* backend) {
-    // create a framebuffer per swapchain image.
-    for (u32 i = 0; i < backend->swapchain.image_count; i++) {
-        u32 count = 2;
-        VkImageView attachments[] = {
-            backend->swapchain.views[i],
-            backend->swapchain.depth_image.view,
-        };
-
-        VkFramebufferCreateInfo framebuffer_info = {0};
-        framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebuffer_info.renderPass = backend->main_pass.handle;
-        framebuffer_info.attachmentCount = count;
-        framebuffer_info.pAttachments = attachments;
-        framebuffer_info.width = backend->framebuffer_width;
-        framebuffer_info.height = backend->framebuffer_height;
-        framebuffer_info.layers = 1;
-
-        VK_FN_CHECK(vkCreateFramebuffer(backend->device.logical, &framebuffer_info,
-                                        backend->allocator, &backend->framebuffers[i]));
-    }
+static void create_framebuffer(VulkanBackend* backend) {
+    u32 count = 2;
+    VkImageView attachments[] = {
+        backend->swapchain.color_image.view,
+        backend->swapchain.depth_image.view,
+    };
+
+    VkFramebufferCreateInfo framebuffer_info = {0};
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = backend->main_pass.handle;
+    framebuffer_info.attachmentCount = count;
+    framebuffer_info.pAttachments = attachments;
+    framebuffer_info.width = backend->swapchain.extent.width;
+    framebuffer_info.height = backend->swapchain.extent.height;
+    framebuffer_info.layers = 1;
+
+    VK_FN_CHECK(vkCreateFramebuffer(backend->device.logical, &framebuffer_info,
+                                    backend->allocator, &backend->framebuffer));
+}
+
+static void update_scene_extent(void) {
+    VkExtent2D extent = backend.swapchain.extent;
+    u32 width = (u32)((f32)extent.width * backend.render_scale + 0.5f);
+    u32 height = (u32)((f32)extent.height * backend.render_scale + 0.5f);
+    backend.scene_width = CLAMP(width, 1, extent.width);
+    backend.scene_height = CLAMP(height, 1, extent.height);
 }
+
 VKAPI_ATTR VkBool32 VKAPI_CALL vulkan_debug_callback(
     VkDebugUtilsMessageSeverityFlagBitsEXT severity, VkDebugUtilsMessageTypeFlagsEXT type,
     const VkDebugUtilsMessengerCallbackDataEXT* callback_data, void* data) {
@@ -453,44 +729,38 @@ VKAPI_ATTR VkBool32 VKAPI_CALL vulkan_debug_callback(
     switch (severity) {
     case VK_DEBUG_UTILS_MESSAGE_SEVERITY_FLAG_BITS_MAX_ENUM_EXT:
     case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-        TRACE(callback_data->pMessage);
+        TRACE("%s", callback_data->pMessage);
     case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-        INFO(callback_data->pMessage);
+        INFO("%s", callback_data->pMessage);
         break;
     case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-        WARN(callback_data->pMessage);
+        WARN("%s", callback_data->pMessage);
         break;
     case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-        ERROR(callback_data->pMessage);
+        ERROR("%s", callback_data->pMessage);
         break;
     }
     return VK_FALSE;
 }
 
-void buffer_data_transfer(VulkanBackend* ctx, VkCommandPool pool, VkFence fence, VkQueue queue,
-                          Buffer* dst, u64 dst_offset, u64 size, void* data) {
-    u32 memory_flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-    u32 buffer_flags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-    Buffer stanging;
-    // 1) Create a stanging buffer
-    vulkan_buffer_create(ctx, buffer_flags, memory_flags, size, true, &stanging);
-    // 2) Write data to the stanging buffer
-    vulkan_buffer_write(ctx, &stanging, 0, size, 0, data);
-    // 3) Copy the stanging buffer to the destination buffer
-    vulkan_buffer_copy(ctx, pool, queue, &stanging, dst, size, 0, dst_offset);
-    // 4) Destroy the stanging buffer
-    vulkan_buffer_destroy(ctx, &stanging);
-}
-
 void vulkan_backend_destroy(void) {
     vkDeviceWaitIdle(backend.device.logical);
 
+    INFO("Destroying Vulkan Deferred Deletions...");
+    vulkan_deletion_queue_destroy(&backend, &backend.deletion_queue);
+    INFO("Destroying Vulkan Uploads...");
+    vulkan_upload_destroy(&backend, &backend.uploads);
     INFO("Destroying Vulkan Vertex Buffer...");
     vulkan_buffer_destroy(&backend, &backend.vertex_buffer);
     INFO("Destroying Vulkan Index Buffer...");
     vulkan_buffer_destroy(&backend, &backend.index_buffer);
 
+    INFO("Destroying Vulkan Instance Buffers...");
+    vulkan_instancing_destroy(&backend, &backend.instancing);
+    INFO("Destroying Vulkan Textures...");
+    vulkan_texture_array_destroy(&backend, &backend.block_textures);
+    INFO("Destroying Vulkan Hi-Z...");
+    vulkan_hiz_destroy(&backend, &backend.hiz);
     INFO("Destroying Vulkan Shaders...");
     vulkan_shader_destroy(&backend, &backend.basic_shader);
     // Destroy sync objects
@@ -500,18 +770,20 @@ void vulkan_backend_destroy(void) {
                            backend.allocator);
         vkDestroySemaphore(backend.device.logical, backend.queue_complete_semaphores[i],
                            backend.allocator);
-        vkDestroyFence(backend.device.logical, backend.in_flight_fences[i], backend.allocator);
+    }
+    for (u32 i = 0; i < TIMELINE_QUEUE_COUNT; i++) {
+        vulkan_timeline_destroy(&backend, &backend.timelines[i]);
     }
     vector_free(backend.image_available_semaphores);
     vector_free(backend.queue_complete_semaphores);
-    vector_free(backend.in_flight_fences);
+    vector_free(backend.in_flight_values);
     mem_free(backend.images_in_flight);
     backend.images_in_flight = 0;
 
-    INFO("Destroying Vulkan Framebuffers...");
-    for (u32 i = 0; i < backend.swapchain.image_count; i++) {
-        vkDestroyFramebuffer(backend.device.logical, backend.framebuffers[i], backend.allocator);
-    }
+    INFO("Destroying Vulkan GPU Timer...");
+    vulkan_gpu_timer_destroy(&backend, &backend.gpu_timer);
+    INFO("Destroying Vulkan Framebuffer...");
+    vkDestroyFramebuffer(backend.device.logical, backend.framebuffer, backend.allocator);
     // Destroy command buffers
     INFO("Destroying Vulkan Command Buffers...");
     for (u32 i = 0; i < backend.swapchain.image_count; i++) {
@@ -523,6 +795,7 @@ void vulkan_backend_destroy(void) {
     vector_free(backend.graphics_command_buffers);
     INFO("Destroying Vulkan Renderpass...");
     vulkan_renderpass_destroy(&backend, &backend.main_pass);
+    vulkan_renderpass_destroy(&backend, &backend.main_pass_load);
     INFO("Destroying Vulkan Swapchain...");
     vulkan_swapchain_destroy(&backend, &backend.swapchain);
 
@@ -6,8 +6,17 @@
 
 bool vulkan_backend_create(const char* app_name, Window* window);
 void vulkan_backend_resize(u16 width, u16 height);
+void vulkan_backend_set_present_mode(PresentMode mode);
+bool vulkan_backend_wait_frame(void);
 bool vulkan_backend_begin_frame(f32 dt);
 void vulkan_backend_update_globals(Mat4 view, Mat4 proj);
+void vulkan_backend_bind_pipeline(RenderPipeline pipeline);
+void vulkan_backend_draw(MeshRange mesh, DrawConstants constants);
+void vulkan_backend_draw_instanced(MeshRange mesh, const InstanceData* instances, u32 count);
+void vulkan_backend_set_render_scale(f32 scale);
+bool vulkan_backend_gpu_frame_time(f32* frame_ms);
+void vulkan_backend_set_chunk_draws(const ChunkDraw* draws, u32 count);
+bool vulkan_backend_set_textures(const char** names, u32 count, u32 size);
 bool vulkan_backend_end_frame(f32 dt);
 void vulkan_backend_destroy(void);
 
@@ -38,6 +38,17 @@ void vulkan_buffer_write(VulkanBackend* context, Buffer* buffer, u64 offset, u64
     vkUnmapMemory(context->device.logical, buffer->memory);
 }
 
+void* vulkan_buffer_map(VulkanBackend* context, Buffer* buffer) {
+    void* mapped = 0;
+    VK_FN_CHECK(
+        vkMapMemory(context->device.logical, buffer->memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+    return mapped;
+}
+
+void vulkan_buffer_unmap(VulkanBackend* context, Buffer* buffer) {
+    vkUnmapMemory(context->device.logical, buffer->memory);
+}
+
 void vulkan_buffer_bind(VulkanBackend* context, Buffer* buffer, u64 offset) {
     VK_FN_CHECK(
         vkBindBufferMemory(context->device.logical, buffer->handle, buffer->memory, offset));
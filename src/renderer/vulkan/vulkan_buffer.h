@@ -11,6 +11,13 @@ void vulkan_buffer_bind(VulkanBackend* context, Buffer* buffer, u64 offset);
 void vulkan_buffer_write(VulkanBackend* context, Buffer* buffer, u64 offset, u64 size, u32 flags,
                          void* data);
 
+/**
+ * Maps the whole buffer, which must be host visible. Persistently mapped buffers stay mapped
+ * until `vulkan_buffer_unmap`.
+ */
+void* vulkan_buffer_map(VulkanBackend* context, Buffer* buffer);
+void vulkan_buffer_unmap(VulkanBackend* context, Buffer* buffer);
+
 void vulkan_buffer_copy(VulkanBackend* context, VkCommandPool pool, VkQueue queue, Buffer* src,
                         Buffer* dst, u64 size, u64 src_offset, u64 dst_offset);
 
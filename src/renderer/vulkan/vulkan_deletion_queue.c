@@ -0,0 +1,105 @@
+#include "vulkan_deletion_queue.h"
+#include "vulkan_buffer.h"
+#include "vulkan_image.h"
+#include "vulkan_pipeline.h"
+#include <string.h>
+
+static void push(VulkanBackend* backend, DeferredDeletion entry) {
+    // The graphics submit being recorded is the last one that can still reference the resource.
+    entry.value = backend->timelines[TIMELINE_QUEUE_GRAPHICS].value + 1;
+    vector_push(backend->deletion_queue.entries, entry);
+}
+
+static void release(VulkanBackend* backend, DeferredDeletion* entry) {
+    switch (entry->type) {
+    case DEFERRED_RESOURCE_BUFFER:
+        vulkan_buffer_destroy(backend, &entry->resource.buffer);
+        break;
+    case DEFERRED_RESOURCE_IMAGE:
+        vulkan_image_destroy(backend, &entry->resource.image);
+        break;
+    case DEFERRED_RESOURCE_IMAGE_VIEW:
+        vkDestroyImageView(backend->device.logical, entry->resource.view, backend->allocator);
+        break;
+    case DEFERRED_RESOURCE_PIPELINE:
+        vulkan_pipeline_destroy(backend, &entry->resource.pipeline);
+        break;
+    case DEFERRED_RESOURCE_DESCRIPTOR_POOL:
+        vkDestroyDescriptorPool(backend->device.logical, entry->resource.descriptor_pool,
+                                backend->allocator);
+        break;
+    }
+}
+
+void vulkan_deletion_queue_create(DeletionQueue* queue) {
+    queue->entries = vector_with_capacity(DeferredDeletion, 64);
+}
+
+void vulkan_deletion_queue_push_buffer(VulkanBackend* backend, Buffer* buffer) {
+    DeferredDeletion entry = {0};
+    entry.type = DEFERRED_RESOURCE_BUFFER;
+    entry.resource.buffer = *buffer;
+    push(backend, entry);
+    buffer->handle = 0;
+    buffer->memory = 0;
+}
+
+void vulkan_deletion_queue_push_image(VulkanBackend* backend, Image* image) {
+    DeferredDeletion entry = {0};
+    entry.type = DEFERRED_RESOURCE_IMAGE;
+    entry.resource.image = *image;
+    push(backend, entry);
+    image->handle = 0;
+    image->view = 0;
+    image->memory = 0;
+}
+
+void vulkan_deletion_queue_push_image_view(VulkanBackend* backend, VkImageView* view) {
+    DeferredDeletion entry = {0};
+    entry.type = DEFERRED_RESOURCE_IMAGE_VIEW;
+    entry.resource.view = *view;
+    push(backend, entry);
+    *view = 0;
+}
+
+void vulkan_deletion_queue_push_pipeline(VulkanBackend* backend, Pipeline* pipeline) {
+    DeferredDeletion entry = {0};
+    entry.type = DEFERRED_RESOURCE_PIPELINE;
+    entry.resource.pipeline = *pipeline;
+    push(backend, entry);
+    pipeline->pipeline = 0;
+    pipeline->layout = 0;
+}
+
+void vulkan_deletion_queue_push_descriptor_pool(VulkanBackend* backend, VkDescriptorPool* pool) {
+    DeferredDeletion entry = {0};
+    entry.type = DEFERRED_RESOURCE_DESCRIPTOR_POOL;
+    entry.resource.descriptor_pool = *pool;
+    push(backend, entry);
+    *pool = 0;
+}
+
+void vulkan_deletion_queue_flush(VulkanBackend* backend, DeletionQueue* queue,
+                                 u64 completed_value) {
+    u64 length = vector_length(queue->entries);
+    u64 released = 0;
+    while (released < length && queue->entries[released].value <= completed_value) {
+        release(backend, &queue->entries[released]);
+        released++;
+    }
+    if (released == 0) {
+        return;
+    }
+    // Entries are ordered by value, so the remaining ones are a suffix.
+    memmove(queue->entries, queue->entries + released,
+            (length - released) * sizeof(DeferredDeletion));
+    vector_length_set(queue->entries, length - released);
+}
+
+void vulkan_deletion_queue_destroy(VulkanBackend* backend, DeletionQueue* queue) {
+    u64 length = vector_length(queue->entries);
+    for (u64 i = 0; i < length; i++) {
+        release(backend, &queue->entries[i]);
+    }
+    vector_free(queue->entries);
+}
@@ -0,0 +1,31 @@
+#ifndef VULKAN_DELETION_QUEUE_H
+#define VULKAN_DELETION_QUEUE_H
+
+#include "vulkan_types.h"
+
+/**
+ * Deferred destruction of GPU resources. Resources pushed while recording the graphics submit
+ * that will signal timeline value N are released once the graphics timeline reaches N, so
+ * callers can drop a resource at any time without waiting for the device to go idle.
+ *
+ * The push functions take ownership of the resource and clear the caller's handle.
+ */
+void vulkan_deletion_queue_create(DeletionQueue* queue);
+void vulkan_deletion_queue_push_buffer(VulkanBackend* backend, Buffer* buffer);
+void vulkan_deletion_queue_push_image(VulkanBackend* backend, Image* image);
+void vulkan_deletion_queue_push_image_view(VulkanBackend* backend, VkImageView* view);
+void vulkan_deletion_queue_push_pipeline(VulkanBackend* backend, Pipeline* pipeline);
+void vulkan_deletion_queue_push_descriptor_pool(VulkanBackend* backend, VkDescriptorPool* pool);
+
+/**
+ * Releases every entry whose value is less than or equal to `completed_value`.
+ */
+void vulkan_deletion_queue_flush(VulkanBackend* backend, DeletionQueue* queue,
+                                 u64 completed_value);
+
+/**
+ * Releases every remaining entry. The device must be idle.
+ */
+void vulkan_deletion_queue_destroy(VulkanBackend* backend, DeletionQueue* queue);
+
+#endif
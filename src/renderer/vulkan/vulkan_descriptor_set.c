@@ -1,4 +1,5 @@
 #include "vulkan_descriptor_set.h"
+#include "core/arena.h"
 #include "core/log.h"
 #include "core/mem.h"
 #include "vulkan_buffer.h"
@@ -7,29 +8,36 @@ void vulkan_descriptor_set_layout_create(VulkanBackend* backend, u32 binding,
                                          VkDescriptorSetLayout* layout) {
 
     // descriptors
-    VkDescriptorSetLayoutBinding descriptor_set_layout_binding = {0};
-    descriptor_set_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptor_set_layout_binding.binding = 0;
-    descriptor_set_layout_binding.descriptorCount = 1;
-    descriptor_set_layout_binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    VkDescriptorSetLayoutBinding descriptor_set_layout_bindings[2] = {0};
+    descriptor_set_layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptor_set_layout_bindings[0].binding = 0;
+    descriptor_set_layout_bindings[0].descriptorCount = 1;
+    descriptor_set_layout_bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    // Block texture array
+    descriptor_set_layout_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptor_set_layout_bindings[1].binding = 1;
+    descriptor_set_layout_bindings[1].descriptorCount = 1;
+    descriptor_set_layout_bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
     VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info = {0};
     descriptor_set_layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    descriptor_set_layout_create_info.bindingCount = 1;
-    descriptor_set_layout_create_info.pBindings = &descriptor_set_layout_binding;
+    descriptor_set_layout_create_info.bindingCount = 2;
+    descriptor_set_layout_create_info.pBindings = descriptor_set_layout_bindings;
     VK_FN_CHECK(vkCreateDescriptorSetLayout(
         backend->device.logical, &descriptor_set_layout_create_info, backend->allocator, layout));
 }
 
 void vulkan_descriptor_set_pool_create(VulkanBackend* backend, u32 maxSet, VkDescriptorPool* out) {
-    VkDescriptorPoolSize descriptor_pool_size = {0};
-    descriptor_pool_size.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    descriptor_pool_size.descriptorCount = maxSet;
+    VkDescriptorPoolSize descriptor_pool_sizes[2] = {0};
+    descriptor_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    descriptor_pool_sizes[0].descriptorCount = maxSet;
+    descriptor_pool_sizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptor_pool_sizes[1].descriptorCount = maxSet;
 
     VkDescriptorPoolCreateInfo descriptor_pool_create_info = {0};
     descriptor_pool_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    descriptor_pool_create_info.poolSizeCount = 1; // number of PoolSize objects
-    descriptor_pool_create_info.pPoolSizes = &descriptor_pool_size;
+    descriptor_pool_create_info.poolSizeCount = 2; // number of PoolSize objects
+    descriptor_pool_create_info.pPoolSizes = descriptor_pool_sizes;
     descriptor_pool_create_info.maxSets = maxSet;
 
     VK_FN_CHECK(vkCreateDescriptorPool(backend->device.logical, &descriptor_pool_create_info,
@@ -38,7 +46,8 @@ void vulkan_descriptor_set_pool_create(VulkanBackend* backend, u32 maxSet, VkDes
 
 VkDescriptorSet* vulkan_descriptor_set_create(VulkanBackend* backend, VkDescriptorPool pool,
                                               u32 set_count) {
-    VkDescriptorSetLayout* layouts = mem_alloc(sizeof(VkDescriptorSetLayout) * set_count);
+    // Only needed for the call below.
+    VkDescriptorSetLayout* layouts = frame_push(VkDescriptorSetLayout, set_count);
 
     for (int i = 0; i < set_count; i++) {
         layouts[i] = backend->basic_shader.descriptor_layout;
@@ -50,10 +59,9 @@ VkDescriptorSet* vulkan_descriptor_set_create(VulkanBackend* backend, VkDescript
     alloc_info.descriptorSetCount = set_count;
     alloc_info.pSetLayouts = layouts;
 
-    VkDescriptorSet* sets = mem_alloc(sizeof(VkDescriptorSet) * set_count);
+    VkDescriptorSet* sets =
+        mem_alloc_tagged(sizeof(VkDescriptorSet) * set_count, MEM_TAG_RENDERER);
     VK_FN_CHECK(vkAllocateDescriptorSets(backend->device.logical, &alloc_info, sets));
-
-    mem_free(layouts);
     return sets;
 }
 
@@ -78,6 +86,26 @@ void vulkan_descriptor_set_update(VulkanBackend* context, VkDescriptorSet* sets,
     }
 }
 
+void vulkan_descriptor_set_update_texture(VulkanBackend* context, VkDescriptorSet* sets,
+                                          const TextureArray* textures, u32 set_count) {
+    for (u32 i = 0; i < set_count; i++) {
+        VkDescriptorImageInfo image_info = {0};
+        image_info.sampler = textures->sampler;
+        image_info.imageView = textures->image.view;
+        image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkWriteDescriptorSet write = {0};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = sets[i];
+        write.dstBinding = 1;
+        write.dstArrayElement = 0;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.descriptorCount = 1;
+        write.pImageInfo = &image_info;
+        vkUpdateDescriptorSets(context->device.logical, 1, &write, 0, 0);
+    }
+}
+
 void vulkan_descriptor_set_destroy(VulkanBackend* context, VkDescriptorSetLayout* layout,
                                    Buffer* global_buffers, VkDescriptorPool pool) {
     DEBUG("Destroying descriptor pool");
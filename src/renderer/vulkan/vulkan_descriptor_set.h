@@ -14,6 +14,9 @@ VkDescriptorSet* vulkan_descriptor_set_create(VulkanBackend* backend, VkDescript
 void vulkan_descriptor_set_update(VulkanBackend* context, VkDescriptorSet* sets,
                                   Buffer* globals_buffer, u32 set_count);
 
+void vulkan_descriptor_set_update_texture(VulkanBackend* context, VkDescriptorSet* sets,
+                                          const TextureArray* textures, u32 set_count);
+
 void vulkan_descriptor_set_destroy(VulkanBackend* context, VkDescriptorSetLayout* layout,
                                    Buffer* global_buffers, VkDescriptorPool pool);
 
@@ -10,6 +10,7 @@ typedef struct DeviceSelectionCriteria {
     bool with_transfer_queue;
     bool with_compute_queue;
     bool with_discrete_gpu;
+    bool with_timeline_semaphore;
     Vector(const char*) device_extensions;
 } DeviceSelectionCriteria;
 
@@ -34,7 +35,8 @@ void vulkan_device_query_swapchain_support(VkPhysicalDevice device, VkSurfaceKHR
 
     if (out->format_count != 0) {
         if (!out->formats) {
-            out->formats = mem_alloc(sizeof(VkSurfaceFormatKHR) * out->format_count);
+            out->formats = mem_alloc_tagged(sizeof(VkSurfaceFormatKHR) * out->format_count,
+                                            MEM_TAG_RENDERER);
         }
         VK_FN_CHECK(vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &out->format_count,
                                                          out->formats));
@@ -45,7 +47,8 @@ void vulkan_device_query_swapchain_support(VkPhysicalDevice device, VkSurfaceKHR
 
     if (out->present_mode_count != 0) {
         if (!out->present_modes) {
-            out->present_modes = mem_alloc(sizeof(VkPresentModeKHR) * out->present_mode_count);
+            out->present_modes = mem_alloc_tagged(
+                sizeof(VkPresentModeKHR) * out->present_mode_count, MEM_TAG_RENDERER);
         }
         VK_FN_CHECK(vkGetPhysicalDeviceSurfacePresentModesKHR(
             device, surface, &out->present_mode_count, out->present_modes));
@@ -76,10 +79,15 @@ bool device_selection_criteria_satisfied(DeviceSelectionCriteria* criteria,
     bool transfer_family = false;
     bool compute_family = false;
 
+    // Transfer and compute prefer families without graphics so their work can overlap rendering.
+    bool dedicated_transfer_family = false;
+    bool dedicated_compute_family = false;
+
     for (u32 i = 0; i < queue_family_count; i++) {
         VkQueueFamilyProperties queue_family_props = queue_families[i];
+        bool has_graphics = queue_family_props.queueFlags & VK_QUEUE_GRAPHICS_BIT;
 
-        if (queue_family_props.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        if (has_graphics) {
             // Do not switch your family index if you already found one
             if (!graphics_family) {
                 queue_indices->graphics_family = i;
@@ -87,15 +95,17 @@ bool device_selection_criteria_satisfied(DeviceSelectionCriteria* criteria,
             }
         }
         if (queue_family_props.queueFlags & VK_QUEUE_COMPUTE_BIT) {
-            if (!compute_family) {
+            if (!compute_family || (!has_graphics && !dedicated_compute_family)) {
                 queue_indices->compute_family = i;
                 compute_family = true;
+                dedicated_compute_family = !has_graphics;
             }
         }
         if (queue_family_props.queueFlags & VK_QUEUE_TRANSFER_BIT) {
-            if (!transfer_family) {
+            if (!transfer_family || (!has_graphics && !dedicated_transfer_family)) {
                 queue_indices->transfer_family = i;
                 transfer_family = true;
+                dedicated_transfer_family = !has_graphics;
             }
         }
         if (!present_family) {
@@ -120,6 +130,20 @@ bool device_selection_criteria_satisfied(DeviceSelectionCriteria* criteria,
     if (criteria->with_compute_queue && !compute_family) {
         return false;
     }
+    if (criteria->with_timeline_semaphore) {
+        if (properties->apiVersion < VK_API_VERSION_1_2) {
+            return false;
+        }
+        VkPhysicalDeviceVulkan12Features features_12 = {0};
+        features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 features = {0};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &features_12;
+        vkGetPhysicalDeviceFeatures2(device, &features);
+        if (!features_12.timelineSemaphore) {
+            return false;
+        }
+    }
 
     vulkan_device_query_swapchain_support(device, surface, swapchain_support);
 
@@ -203,8 +227,9 @@ static bool pick_physical_device(VulkanBackend* backend) {
     criteria.with_graphics_queue = true;
     criteria.with_present_queue = true;
     criteria.with_transfer_queue = true;
-    criteria.with_compute_queue = false;
+    criteria.with_compute_queue = true;
     criteria.with_discrete_gpu = false;
+    criteria.with_timeline_semaphore = true;
     // TODO: is a vector necessary here?. Most likely we will only have a fixed set of extensions
     // known at compile time.
     criteria.device_extensions = vector_new(const char*);
@@ -232,6 +257,7 @@ static bool pick_physical_device(VulkanBackend* backend) {
                                                  &swapchain_support)) {
             DEBUG("Device selection criteria was not satifisfied. Skipping device %s",
                   properties.deviceName);
+            continue;
         }
 
         INFO("Device %s was picked.", properties.deviceName);
@@ -296,41 +322,33 @@ static bool pick_physical_device(VulkanBackend* backend) {
 
 static bool create_logical_device(VulkanBackend* backend) {
 
-    bool present_share_graphics_queue = backend->device.queue_family_indices.graphics_family ==
-                                        backend->device.queue_family_indices.present_family;
-    bool transfer_share_graphics_queue = backend->device.queue_family_indices.graphics_family ==
-                                         backend->device.queue_family_indices.transfer_family;
-    u32 family_count = 1;
-
-    if (!present_share_graphics_queue) {
-        family_count++;
-    }
-
-    if (!transfer_share_graphics_queue) {
-        family_count++;
-    }
-
-    u32 family_indices[family_count];
-    u32 i = 0;
-
-    family_indices[i++] = backend->device.queue_family_indices.graphics_family;
-
-    if (!present_share_graphics_queue) {
-        family_indices[i++] = backend->device.queue_family_indices.present_family;
-    }
-
-    if (!transfer_share_graphics_queue) {
-        family_indices[i++] = backend->device.queue_family_indices.transfer_family;
+    DeviceQueueFamilyIndices* indices = &backend->device.queue_family_indices;
+    u32 requested_families[] = {indices->graphics_family, indices->present_family,
+                                indices->transfer_family, indices->compute_family};
+    // A queue family can only be requested once.
+    u32 family_count = 0;
+    u32 family_indices[4];
+    for (u32 i = 0; i < 4; i++) {
+        bool duplicate = false;
+        for (u32 j = 0; j < family_count; j++) {
+            if (family_indices[j] == requested_families[i]) {
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            family_indices[family_count++] = requested_families[i];
+        }
     }
 
     VkDeviceQueueCreateInfo queue_create_infos[family_count];
 
+    f32 queue_priority = 1.0f;
     for (u32 i = 0; i < family_count; i++) {
         VkDeviceQueueCreateInfo info = {0};
         info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
         info.queueFamilyIndex = family_indices[i];
         info.queueCount = 1;
-        f32 queue_priority = 1.0f;
         info.pQueuePriorities = &queue_priority;
         queue_create_infos[i] = info;
     }
@@ -360,8 +378,15 @@ static bool create_logical_device(VulkanBackend* backend) {
         extensions[c++] = "VK_KHR_portability_subset";
 
     VkPhysicalDeviceFeatures features = {0};
+    // Lets the Hi-Z chunk draws go out in a single indirect call when supported.
+    features.multiDrawIndirect = backend->device.features.multiDrawIndirect;
+    // Timeline semaphores back all queue synchronization.
+    VkPhysicalDeviceVulkan12Features features_12 = {0};
+    features_12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    features_12.timelineSemaphore = VK_TRUE;
     VkDeviceCreateInfo device_create_info = {0};
     device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    device_create_info.pNext = &features_12;
     device_create_info.queueCreateInfoCount = family_count;
     device_create_info.pQueueCreateInfos = queue_create_infos;
     device_create_info.enabledExtensionCount = c;
@@ -377,10 +402,12 @@ static bool create_logical_device(VulkanBackend* backend) {
                      0, &backend->device.present_queue);
     vkGetDeviceQueue(backend->device.logical, backend->device.queue_family_indices.transfer_family,
                      0, &backend->device.transfer_queue);
+    vkGetDeviceQueue(backend->device.logical, backend->device.queue_family_indices.compute_family,
+                     0, &backend->device.compute_queue);
 
     if (backend->device.graphics_queue && backend->device.present_queue &&
-        backend->device.transfer_queue) {
-        DEBUG("Graphics, Present, Transfer queues ready");
+        backend->device.transfer_queue && backend->device.compute_queue) {
+        DEBUG("Graphics, Present, Transfer, Compute queues ready");
     } else {
         DEBUG("Failed to obtain queues.");
     }
@@ -392,6 +419,14 @@ static bool create_logical_device(VulkanBackend* backend) {
     VK_FN_CHECK(vkCreateCommandPool(backend->device.logical, &pool_info, backend->allocator,
                                     &backend->device.graphics_command_pool));
     DEBUG("Graphics Command Pool created");
+
+    pool_info.queueFamilyIndex = backend->device.queue_family_indices.transfer_family;
+    VK_FN_CHECK(vkCreateCommandPool(backend->device.logical, &pool_info, backend->allocator,
+                                    &backend->device.transfer_command_pool));
+    pool_info.queueFamilyIndex = backend->device.queue_family_indices.compute_family;
+    VK_FN_CHECK(vkCreateCommandPool(backend->device.logical, &pool_info, backend->allocator,
+                                    &backend->device.compute_command_pool));
+    DEBUG("Transfer and Compute Command Pools created");
     return true;
 }
 
@@ -402,7 +437,9 @@ bool vulkan_device_detect_depth_format(Device* device) {
         VK_FORMAT_D32_SFLOAT_S8_UINT,
         VK_FORMAT_D24_UNORM_S8_UINT,
     };
-    VkFormatFeatureFlags flags = VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    // Depth is sampled by the Hi-Z reduction, so the format must support sampling too.
+    VkFormatFeatureFlags flags =
+        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
     for (u32 i = 0; i < c; i++) {
         VkFormatProperties properties;
         vkGetPhysicalDeviceFormatProperties(device->physical, candidates[i], &properties);
@@ -425,10 +462,19 @@ void vulkan_device_destroy(VulkanBackend* backend) {
         vkDestroyCommandPool(backend->device.logical, backend->device.graphics_command_pool,
                              backend->allocator);
     }
+    if (backend->device.transfer_command_pool) {
+        vkDestroyCommandPool(backend->device.logical, backend->device.transfer_command_pool,
+                             backend->allocator);
+    }
+    if (backend->device.compute_command_pool) {
+        vkDestroyCommandPool(backend->device.logical, backend->device.compute_command_pool,
+                             backend->allocator);
+    }
     DEBUG("Destroying Vulkan Device...");
     backend->device.graphics_queue = VK_NULL_HANDLE;
     backend->device.present_queue = VK_NULL_HANDLE;
     backend->device.transfer_queue = VK_NULL_HANDLE;
+    backend->device.compute_queue = VK_NULL_HANDLE;
     if (backend->device.logical) {
         vkDestroyDevice(backend->device.logical, backend->allocator);
     }
@@ -0,0 +1,84 @@
+#include "vulkan_gpu_timer.h"
+#include "core/log.h"
+#include "core/mem.h"
+
+bool vulkan_gpu_timer_create(VulkanBackend* backend, u32 slot_count, GpuTimer* timer) {
+    timer->pool = 0;
+    timer->slot_count = slot_count;
+    timer->pending = 0;
+    timer->period = backend->device.properties.limits.timestampPeriod;
+    timer->frame_ms = 0.0f;
+    timer->has_sample = false;
+    if (!backend->device.properties.limits.timestampComputeAndGraphics) {
+        WARN("Device can't write timestamps, GPU frame time is not measured.");
+        return true;
+    }
+
+    VkQueryPoolCreateInfo pool_info = {0};
+    pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    pool_info.queryCount = slot_count * 2;
+    if (vkCreateQueryPool(backend->device.logical, &pool_info, backend->allocator,
+                          &timer->pool) != VK_SUCCESS) {
+        ERROR("Failed to create timestamp query pool");
+        return false;
+    }
+    timer->pending = mem_alloc_tagged(sizeof(bool) * slot_count, MEM_TAG_RENDERER);
+    for (u32 i = 0; i < slot_count; i++) {
+        timer->pending[i] = false;
+    }
+    return true;
+}
+
+void vulkan_gpu_timer_destroy(VulkanBackend* backend, GpuTimer* timer) {
+    if (timer->pool) {
+        vkDestroyQueryPool(backend->device.logical, timer->pool, backend->allocator);
+        timer->pool = 0;
+    }
+    if (timer->pending) {
+        mem_free(timer->pending);
+        timer->pending = 0;
+    }
+    timer->has_sample = false;
+}
+
+void vulkan_gpu_timer_begin(VulkanBackend* backend, GpuTimer* timer,
+                            CommandBuffer* command_buffer, u32 slot) {
+    if (!timer->pool) {
+        return;
+    }
+    if (timer->pending[slot]) {
+        // Not waiting keeps the CPU from stalling on the GPU; a result that is not ready yet
+        // is simply dropped.
+        u64 timestamps[2];
+        VkResult result = vkGetQueryPoolResults(backend->device.logical, timer->pool, slot * 2, 2,
+                                                sizeof(timestamps), timestamps, sizeof(u64),
+                                                VK_QUERY_RESULT_64_BIT);
+        if (result == VK_SUCCESS && timestamps[1] >= timestamps[0]) {
+            timer->frame_ms = (f32)((f64)(timestamps[1] - timestamps[0]) * timer->period / 1e6);
+            timer->has_sample = true;
+        }
+        timer->pending[slot] = false;
+    }
+    vkCmdResetQueryPool(command_buffer->handle, timer->pool, slot * 2, 2);
+    vkCmdWriteTimestamp(command_buffer->handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timer->pool,
+                        slot * 2);
+}
+
+void vulkan_gpu_timer_end(GpuTimer* timer, CommandBuffer* command_buffer, u32 slot) {
+    if (!timer->pool) {
+        return;
+    }
+    vkCmdWriteTimestamp(command_buffer->handle, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timer->pool,
+                        slot * 2 + 1);
+    timer->pending[slot] = true;
+}
+
+bool vulkan_gpu_timer_read(GpuTimer* timer, f32* frame_ms) {
+    if (!timer->has_sample) {
+        return false;
+    }
+    *frame_ms = timer->frame_ms;
+    timer->has_sample = false;
+    return true;
+}
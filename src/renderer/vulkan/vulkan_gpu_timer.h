@@ -0,0 +1,31 @@
+#ifndef VULKAN_GPU_TIMER_H
+#define VULKAN_GPU_TIMER_H
+
+#include "vulkan_types.h"
+
+/**
+ * Creates one timestamp pair per slot. Every function is a no-op when the device can't write
+ * timestamps on its graphics queue.
+ */
+bool vulkan_gpu_timer_create(VulkanBackend* backend, u32 slot_count, GpuTimer* timer);
+void vulkan_gpu_timer_destroy(VulkanBackend* backend, GpuTimer* timer);
+
+/**
+ * Reads back the previous measurement of the slot if the GPU already finished it, then records
+ * the start timestamp. Must be recorded outside a render pass, first in the command buffer.
+ */
+void vulkan_gpu_timer_begin(VulkanBackend* backend, GpuTimer* timer,
+                            CommandBuffer* command_buffer, u32 slot);
+
+/**
+ * Records the end timestamp, last in the command buffer.
+ */
+void vulkan_gpu_timer_end(GpuTimer* timer, CommandBuffer* command_buffer, u32 slot);
+
+/**
+ * Returns true and writes the frame time in milliseconds when a measurement arrived since
+ * the last call.
+ */
+bool vulkan_gpu_timer_read(GpuTimer* timer, f32* frame_ms);
+
+#endif
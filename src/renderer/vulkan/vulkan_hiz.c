@@ -0,0 +1,472 @@
+#include "vulkan_hiz.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_image.h"
+#include "vulkan_pipeline.h"
+#include "vulkan_shader.h"
+#include "vulkan_timeline.h"
+
+#define HIZ_REDUCE_SHADER_NAME "hiz_reduce.shader"
+#define HIZ_CULL_SHADER_NAME "hiz_cull.shader"
+// Must match the local sizes declared in the compute shaders.
+#define HIZ_REDUCE_GROUP_SIZE 8
+#define HIZ_CULL_GROUP_SIZE 64
+
+typedef struct HiZReduceConstants {
+    i32 src_width;
+    i32 src_height;
+    i32 dst_width;
+    i32 dst_height;
+} HiZReduceConstants;
+
+typedef struct HiZCullConstants {
+    Mat4 view_proj;     // 64 bytes
+    f32 pyramid_width;  // 4 bytes
+    f32 pyramid_height; // 4 bytes
+    u32 chunk_count;    // 4 bytes
+    u32 phase;          // 4 bytes
+} HiZCullConstants;
+
+static void create_descriptor_layouts(VulkanBackend* backend, HiZ* hiz);
+static void create_pyramid(VulkanBackend* backend, HiZ* hiz);
+static void destroy_pyramid(VulkanBackend* backend, HiZ* hiz);
+
+static u32 previous_power_of_two(u32 value) {
+    u32 result = 1;
+    while (result * 2 <= value) {
+        result *= 2;
+    }
+    return result;
+}
+
+bool vulkan_hiz_create(VulkanBackend* backend, HiZ* hiz) {
+    if (!vulkan_shader_module_create(backend, HIZ_REDUCE_SHADER_NAME, "comp",
+                                     VK_SHADER_STAGE_COMPUTE_BIT, &hiz->reduce_module)) {
+        return false;
+    }
+    if (!vulkan_shader_module_create(backend, HIZ_CULL_SHADER_NAME, "comp",
+                                     VK_SHADER_STAGE_COMPUTE_BIT, &hiz->cull_module)) {
+        return false;
+    }
+
+    create_descriptor_layouts(backend, hiz);
+
+    VkPushConstantRange reduce_range = {0};
+    reduce_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    reduce_range.size = sizeof(HiZReduceConstants);
+    if (!vulkan_compute_pipeline_create(backend, 1, &hiz->reduce_layout, 1, &reduce_range,
+                                        hiz->reduce_module.stage_info, &hiz->reduce_pipeline)) {
+        ERROR("Failed to create Hi-Z reduce pipeline");
+        return false;
+    }
+
+    VkPushConstantRange cull_range = {0};
+    cull_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    cull_range.size = sizeof(HiZCullConstants);
+    if (!vulkan_compute_pipeline_create(backend, 1, &hiz->cull_layout, 1, &cull_range,
+                                        hiz->cull_module.stage_info, &hiz->cull_pipeline)) {
+        ERROR("Failed to create Hi-Z cull pipeline");
+        return false;
+    }
+
+    // Nearest filtering: the reduction already stores the farthest depth of each footprint.
+    VkSamplerCreateInfo sampler_info = {0};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_NEAREST;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.minLod = 0.0f;
+    sampler_info.maxLod = (f32)HIZ_MAX_MIP_LEVELS;
+    VK_FN_CHECK(
+        vkCreateSampler(backend->device.logical, &sampler_info, backend->allocator, &hiz->sampler));
+
+    vulkan_buffer_create(backend, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         sizeof(ChunkDraw) * HIZ_MAX_CHUNKS, true, &hiz->chunk_buffer);
+    vulkan_buffer_create(backend,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         sizeof(VkDrawIndexedIndirectCommand) * HIZ_MAX_CHUNKS, true,
+                         &hiz->indirect_buffer);
+    vulkan_buffer_create(backend,
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sizeof(u32) * HIZ_MAX_CHUNKS, true,
+                         &hiz->visibility_buffer);
+    hiz->chunk_count = 0;
+    hiz->visibility_dirty = true;
+
+    create_pyramid(backend, hiz);
+    DEBUG("Vulkan Hi-Z created.");
+    return true;
+}
+
+void vulkan_hiz_resize(VulkanBackend* backend, HiZ* hiz) {
+    destroy_pyramid(backend, hiz);
+    create_pyramid(backend, hiz);
+}
+
+void vulkan_hiz_set_chunks(VulkanBackend* backend, HiZ* hiz, const ChunkDraw* draws, u32 count) {
+    if (count > HIZ_MAX_CHUNKS) {
+        WARN("Too many chunk draws (%d), only the first %d will be drawn.", count, HIZ_MAX_CHUNKS);
+        count = HIZ_MAX_CHUNKS;
+    }
+    // The chunk buffer is read by frames still in flight. Chunk sets change rarely, so
+    // waiting for the last graphics submit is cheaper than keeping a copy per frame.
+    Timeline* graphics = &backend->timelines[TIMELINE_QUEUE_GRAPHICS];
+    vulkan_timeline_wait(backend, graphics, graphics->value, UINT64_MAX);
+    if (count > 0) {
+        vulkan_buffer_write(backend, &hiz->chunk_buffer, 0, sizeof(ChunkDraw) * count, 0,
+                            (void*)draws);
+    }
+    hiz->chunk_count = count;
+    hiz->visibility_dirty = true;
+}
+
+void vulkan_hiz_cull(VulkanBackend* backend, HiZ* hiz, CommandBuffer* command_buffer,
+                     HiZCullPhase phase, Mat4 view_proj) {
+    VkCommandBuffer cmd = command_buffer->handle;
+
+    if (hiz->visibility_dirty) {
+        vkCmdFillBuffer(cmd, hiz->visibility_buffer.handle, 0, VK_WHOLE_SIZE, 0);
+        VkMemoryBarrier fill_barrier = {0};
+        fill_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        fill_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        fill_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &fill_barrier, 0, 0, 0,
+                             0);
+        hiz->visibility_dirty = false;
+    }
+
+    // The indirect commands may still be consumed by the previous phase's draws, and the
+    // visibility written by the previous late phase must be visible to this dispatch.
+    VkMemoryBarrier before = {0};
+    before.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    before.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    before.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &before, 0, 0, 0, 0);
+
+    HiZCullConstants constants = {0};
+    constants.view_proj = view_proj;
+    constants.pyramid_width = (f32)hiz->pyramid.width;
+    constants.pyramid_height = (f32)hiz->pyramid.height;
+    constants.chunk_count = hiz->chunk_count;
+    constants.phase = phase;
+
+    vulkan_pipeline_bind(backend, *command_buffer, &hiz->cull_pipeline);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, hiz->cull_pipeline.layout, 0, 1,
+                            &hiz->cull_set, 0, 0);
+    vkCmdPushConstants(cmd, hiz->cull_pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                       sizeof(HiZCullConstants), &constants);
+    vkCmdDispatch(cmd, (hiz->chunk_count + HIZ_CULL_GROUP_SIZE - 1) / HIZ_CULL_GROUP_SIZE, 1, 1);
+
+    VkMemoryBarrier after = {0};
+    after.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    after.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    after.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &after, 0, 0, 0, 0);
+}
+
+void vulkan_hiz_build(VulkanBackend* backend, HiZ* hiz, CommandBuffer* command_buffer) {
+    VkCommandBuffer cmd = command_buffer->handle;
+
+    // The pyramid is rebuilt from scratch, so its previous contents can be discarded. This
+    // also orders the rebuild after the previous late cull finished sampling it.
+    VkImageMemoryBarrier discard = {0};
+    discard.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    discard.srcAccessMask = 0;
+    discard.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    discard.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    discard.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    discard.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    discard.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    discard.image = hiz->pyramid.handle;
+    discard.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    discard.subresourceRange.levelCount = hiz->pyramid.mip_levels;
+    discard.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, 0, 0, 0, 1, &discard);
+
+    vulkan_pipeline_bind(backend, *command_buffer, &hiz->reduce_pipeline);
+
+    // Only the region the scene was rendered into is reduced, so the pyramid always spans
+    // the whole viewport whatever the render scale.
+    u32 src_width = backend->scene_width;
+    u32 src_height = backend->scene_height;
+    for (u32 level = 0; level < hiz->pyramid.mip_levels; level++) {
+        u32 dst_width = hiz->pyramid.width >> level;
+        u32 dst_height = hiz->pyramid.height >> level;
+        dst_width = dst_width > 0 ? dst_width : 1;
+        dst_height = dst_height > 0 ? dst_height : 1;
+
+        HiZReduceConstants constants = {0};
+        constants.src_width = src_width;
+        constants.src_height = src_height;
+        constants.dst_width = dst_width;
+        constants.dst_height = dst_height;
+
+        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, hiz->reduce_pipeline.layout,
+                                0, 1, &hiz->reduce_sets[level], 0, 0);
+        vkCmdPushConstants(cmd, hiz->reduce_pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                           sizeof(HiZReduceConstants), &constants);
+        vkCmdDispatch(cmd, (dst_width + HIZ_REDUCE_GROUP_SIZE - 1) / HIZ_REDUCE_GROUP_SIZE,
+                      (dst_height + HIZ_REDUCE_GROUP_SIZE - 1) / HIZ_REDUCE_GROUP_SIZE, 1);
+
+        // The next level (or the late cull) reads what this level wrote.
+        VkImageMemoryBarrier barrier = {0};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = hiz->pyramid.handle;
+        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.layerCount = 1;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+
+        src_width = dst_width;
+        src_height = dst_height;
+    }
+}
+
+void vulkan_hiz_draw(VulkanBackend* backend, HiZ* hiz, CommandBuffer* command_buffer) {
+    u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+    if (backend->device.features.multiDrawIndirect) {
+        vkCmdDrawIndexedIndirect(command_buffer->handle, hiz->indirect_buffer.handle, 0,
+                                 hiz->chunk_count, stride);
+        return;
+    }
+    for (u32 i = 0; i < hiz->chunk_count; i++) {
+        vkCmdDrawIndexedIndirect(command_buffer->handle, hiz->indirect_buffer.handle, i * stride,
+                                 1, stride);
+    }
+}
+
+void vulkan_hiz_destroy(VulkanBackend* backend, HiZ* hiz) {
+    destroy_pyramid(backend, hiz);
+    vulkan_buffer_destroy(backend, &hiz->chunk_buffer);
+    vulkan_buffer_destroy(backend, &hiz->indirect_buffer);
+    vulkan_buffer_destroy(backend, &hiz->visibility_buffer);
+    vkDestroySampler(backend->device.logical, hiz->sampler, backend->allocator);
+    hiz->sampler = 0;
+    vulkan_pipeline_destroy(backend, &hiz->reduce_pipeline);
+    vulkan_pipeline_destroy(backend, &hiz->cull_pipeline);
+    vkDestroyDescriptorSetLayout(backend->device.logical, hiz->reduce_layout, backend->allocator);
+    vkDestroyDescriptorSetLayout(backend->device.logical, hiz->cull_layout, backend->allocator);
+    hiz->reduce_layout = 0;
+    hiz->cull_layout = 0;
+    vkDestroyShaderModule(backend->device.logical, hiz->reduce_module.handle, backend->allocator);
+    vkDestroyShaderModule(backend->device.logical, hiz->cull_module.handle, backend->allocator);
+    hiz->reduce_module.handle = 0;
+    hiz->cull_module.handle = 0;
+    DEBUG("Vulkan Hi-Z destroyed.");
+}
+
+static void create_descriptor_layouts(VulkanBackend* backend, HiZ* hiz) {
+    // reduce: source level (sampled) -> destination level (storage)
+    VkDescriptorSetLayoutBinding reduce_bindings[2] = {0};
+    reduce_bindings[0].binding = 0;
+    reduce_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    reduce_bindings[0].descriptorCount = 1;
+    reduce_bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    reduce_bindings[1].binding = 1;
+    reduce_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    reduce_bindings[1].descriptorCount = 1;
+    reduce_bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkDescriptorSetLayoutCreateInfo reduce_info = {0};
+    reduce_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    reduce_info.bindingCount = 2;
+    reduce_info.pBindings = reduce_bindings;
+    VK_FN_CHECK(vkCreateDescriptorSetLayout(backend->device.logical, &reduce_info,
+                                            backend->allocator, &hiz->reduce_layout));
+
+    // cull: pyramid, chunks, indirect commands, visibility
+    VkDescriptorSetLayoutBinding cull_bindings[4] = {0};
+    cull_bindings[0].binding = 0;
+    cull_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    cull_bindings[0].descriptorCount = 1;
+    cull_bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    for (u32 i = 1; i < 4; i++) {
+        cull_bindings[i].binding = i;
+        cull_bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        cull_bindings[i].descriptorCount = 1;
+        cull_bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo cull_info = {0};
+    cull_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    cull_info.bindingCount = 4;
+    cull_info.pBindings = cull_bindings;
+    VK_FN_CHECK(vkCreateDescriptorSetLayout(backend->device.logical, &cull_info,
+                                            backend->allocator, &hiz->cull_layout));
+}
+
+static void create_pyramid(VulkanBackend* backend, HiZ* hiz) {
+    Image* depth = &backend->swapchain.depth_image;
+    u32 width = previous_power_of_two(depth->width);
+    u32 height = previous_power_of_two(depth->height);
+    u32 mip_levels = 1;
+    while (mip_levels < HIZ_MAX_MIP_LEVELS &&
+           ((width >> mip_levels) > 0 || (height >> mip_levels) > 0)) {
+        mip_levels++;
+    }
+
+    vulkan_image_create(backend, VK_IMAGE_TYPE_2D, width, height, mip_levels, 1,
+                        VK_FORMAT_R32_SFLOAT, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VK_IMAGE_ASPECT_COLOR_BIT,
+                        &hiz->pyramid);
+
+    for (u32 level = 0; level < mip_levels; level++) {
+        VkImageViewCreateInfo view_info = {0};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = VK_FORMAT_R32_SFLOAT;
+        view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        view_info.subresourceRange.baseMipLevel = level;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.layerCount = 1;
+        view_info.image = hiz->pyramid.handle;
+        VK_FN_CHECK(vkCreateImageView(backend->device.logical, &view_info, backend->allocator,
+                                      &hiz->mip_views[level]));
+    }
+
+    // The cull shader statically references the pyramid, so it has to be in GENERAL layout
+    // even before the first reduction ran.
+    CommandBuffer command_buffer;
+    vulkan_command_buffer_allocate_and_begin_single_use(
+        backend, backend->device.graphics_command_pool, &command_buffer);
+    VkImageMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = hiz->pyramid.handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = mip_levels;
+    barrier.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(command_buffer.handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+    vulkan_command_buffer_end_single_use(backend, backend->device.graphics_command_pool,
+                                         &command_buffer, backend->device.graphics_queue);
+
+    VkDescriptorPoolSize pool_sizes[3] = {0};
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[0].descriptorCount = mip_levels + 1;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    pool_sizes[1].descriptorCount = mip_levels;
+    pool_sizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_sizes[2].descriptorCount = 3;
+
+    VkDescriptorPoolCreateInfo pool_info = {0};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.poolSizeCount = 3;
+    pool_info.pPoolSizes = pool_sizes;
+    pool_info.maxSets = mip_levels + 1;
+    VK_FN_CHECK(vkCreateDescriptorPool(backend->device.logical, &pool_info, backend->allocator,
+                                       &hiz->descriptor_pool));
+
+    VkDescriptorSetLayout reduce_layouts[HIZ_MAX_MIP_LEVELS];
+    for (u32 level = 0; level < mip_levels; level++) {
+        reduce_layouts[level] = hiz->reduce_layout;
+    }
+    VkDescriptorSetAllocateInfo alloc_info = {0};
+    alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    alloc_info.descriptorPool = hiz->descriptor_pool;
+    alloc_info.descriptorSetCount = mip_levels;
+    alloc_info.pSetLayouts = reduce_layouts;
+    VK_FN_CHECK(vkAllocateDescriptorSets(backend->device.logical, &alloc_info, hiz->reduce_sets));
+
+    alloc_info.descriptorSetCount = 1;
+    alloc_info.pSetLayouts = &hiz->cull_layout;
+    VK_FN_CHECK(vkAllocateDescriptorSets(backend->device.logical, &alloc_info, &hiz->cull_set));
+
+    for (u32 level = 0; level < mip_levels; level++) {
+        VkDescriptorImageInfo src_info = {0};
+        src_info.sampler = hiz->sampler;
+        if (level == 0) {
+            src_info.imageView = depth->view;
+            src_info.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+        } else {
+            src_info.imageView = hiz->mip_views[level - 1];
+            src_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        }
+        VkDescriptorImageInfo dst_info = {0};
+        dst_info.imageView = hiz->mip_views[level];
+        dst_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+        VkWriteDescriptorSet writes[2] = {0};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = hiz->reduce_sets[level];
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo = &src_info;
+        writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[1].dstSet = hiz->reduce_sets[level];
+        writes[1].dstBinding = 1;
+        writes[1].descriptorCount = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo = &dst_info;
+        vkUpdateDescriptorSets(backend->device.logical, 2, writes, 0, 0);
+    }
+
+    VkDescriptorImageInfo pyramid_info = {0};
+    pyramid_info.sampler = hiz->sampler;
+    pyramid_info.imageView = hiz->pyramid.view;
+    pyramid_info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    VkDescriptorBufferInfo buffer_infos[3] = {0};
+    buffer_infos[0].buffer = hiz->chunk_buffer.handle;
+    buffer_infos[0].range = VK_WHOLE_SIZE;
+    buffer_infos[1].buffer = hiz->indirect_buffer.handle;
+    buffer_infos[1].range = VK_WHOLE_SIZE;
+    buffer_infos[2].buffer = hiz->visibility_buffer.handle;
+    buffer_infos[2].range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet writes[4] = {0};
+    writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[0].dstSet = hiz->cull_set;
+    writes[0].dstBinding = 0;
+    writes[0].descriptorCount = 1;
+    writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writes[0].pImageInfo = &pyramid_info;
+    for (u32 i = 1; i < 4; i++) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = hiz->cull_set;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &buffer_infos[i - 1];
+    }
+    vkUpdateDescriptorSets(backend->device.logical, 4, writes, 0, 0);
+
+    DEBUG("Hi-Z pyramid created: %dx%d, %d levels", width, height, mip_levels);
+}
+
+static void destroy_pyramid(VulkanBackend* backend, HiZ* hiz) {
+    if (hiz->descriptor_pool) {
+        // Destroying the pool also frees the descriptor sets.
+        vkDestroyDescriptorPool(backend->device.logical, hiz->descriptor_pool, backend->allocator);
+        hiz->descriptor_pool = 0;
+    }
+    for (u32 level = 0; level < hiz->pyramid.mip_levels; level++) {
+        vkDestroyImageView(backend->device.logical, hiz->mip_views[level], backend->allocator);
+        hiz->mip_views[level] = 0;
+    }
+    vulkan_image_destroy(backend, &hiz->pyramid);
+}
@@ -0,0 +1,48 @@
+#ifndef VULKAN_HIZ_H
+#define VULKAN_HIZ_H
+
+#include "vulkan_types.h"
+
+/**
+ * Hierarchical-Z occlusion culling for chunk draws.
+ *
+ * Each frame runs in two phases:
+ *  1. Early: chunks that were visible last frame are drawn without an occlusion test.
+ *  2. Late: a max-depth pyramid is built from the early depth buffer, every chunk is tested
+ *     against it and the ones that became visible are drawn on top.
+ * The visibility produced by the late phase feeds the next frame's early phase.
+ */
+bool vulkan_hiz_create(VulkanBackend* backend, HiZ* hiz);
+
+/**
+ * Recreates the pyramid for the current depth attachment. Must be called whenever the
+ * swapchain (and therefore `Swapchain.depth_image`) is recreated.
+ */
+void vulkan_hiz_resize(VulkanBackend* backend, HiZ* hiz);
+
+/**
+ * Replaces the set of chunks to cull. Resets visibility, so every chunk goes through the
+ * late phase on the next frame.
+ */
+void vulkan_hiz_set_chunks(VulkanBackend* backend, HiZ* hiz, const ChunkDraw* draws, u32 count);
+
+/**
+ * Records the culling dispatch for the given phase. Must be recorded outside a render pass.
+ */
+void vulkan_hiz_cull(VulkanBackend* backend, HiZ* hiz, CommandBuffer* command_buffer,
+                     HiZCullPhase phase, Mat4 view_proj);
+
+/**
+ * Records the reduction of the depth attachment into the pyramid. Must be recorded after
+ * the main render pass ended.
+ */
+void vulkan_hiz_build(VulkanBackend* backend, HiZ* hiz, CommandBuffer* command_buffer);
+
+/**
+ * Records the indirect chunk draws produced by the last culling dispatch.
+ */
+void vulkan_hiz_draw(VulkanBackend* backend, HiZ* hiz, CommandBuffer* command_buffer);
+
+void vulkan_hiz_destroy(VulkanBackend* backend, HiZ* hiz);
+
+#endif
@@ -2,11 +2,13 @@
 #include "renderer/vulkan/vulkan_types.h"
 
 void vulkan_image_create(VulkanBackend* backend, VkImageType type, u32 width, u32 height,
-                         VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-                         VkMemoryPropertyFlags memory_flags, bool create_view,
-                         VkImageAspectFlags aspect_flags, Image* image) {
+                         u32 mip_levels, u32 layer_count, VkFormat format, VkImageTiling tiling,
+                         VkImageUsageFlags usage, VkMemoryPropertyFlags memory_flags,
+                         bool create_view, VkImageAspectFlags aspect_flags, Image* image) {
     image->width = width;
     image->height = height;
+    image->mip_levels = mip_levels;
+    image->layer_count = layer_count;
 
     VkImageCreateInfo image_create_info = {0};
     image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -14,8 +16,8 @@ void vulkan_image_create(VulkanBackend* backend, VkImageType type, u32 width, u3
     image_create_info.extent.width = width;
     image_create_info.extent.height = height;
     image_create_info.extent.depth = 1;
-    image_create_info.mipLevels = 1;
-    image_create_info.arrayLayers = 1;
+    image_create_info.mipLevels = mip_levels;
+    image_create_info.arrayLayers = layer_count;
     image_create_info.format = format;
     image_create_info.tiling = tiling;
     image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -46,19 +48,21 @@ void vulkan_image_create(VulkanBackend* backend, VkImageType type, u32 width, u3
     VK_FN_CHECK(vkBindImageMemory(backend->device.logical, image->handle, image->memory, 0));
 
     if (create_view) {
-        vulkan_image_create_view(backend, format, aspect_flags, image);
+        VkImageViewType view_type =
+            layer_count > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+        vulkan_image_create_view(backend, view_type, format, aspect_flags, image);
     }
 }
 
-void vulkan_image_create_view(VulkanBackend* backend, VkFormat format,
+void vulkan_image_create_view(VulkanBackend* backend, VkImageViewType view_type, VkFormat format,
                               VkImageAspectFlags aspect_flags, Image* image) {
     VkImageViewCreateInfo view_info = {0};
     view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.viewType = view_type;
     view_info.format = format;
     view_info.subresourceRange.aspectMask = aspect_flags;
-    view_info.subresourceRange.levelCount = 1;
-    view_info.subresourceRange.layerCount = 1;
+    view_info.subresourceRange.levelCount = image->mip_levels;
+    view_info.subresourceRange.layerCount = image->layer_count;
     view_info.image = image->handle;
     VK_FN_CHECK(
         vkCreateImageView(backend->device.logical, &view_info, backend->allocator, &image->view));
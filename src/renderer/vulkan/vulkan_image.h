@@ -3,13 +3,17 @@
 
 #include "vulkan_types.h"
 
-void vulkan_image_create(
-    VulkanBackend* backend, VkImageType type, u32 width, u32 height, VkFormat format, VkImageTiling tiling,
-    VkImageUsageFlags usage, VkMemoryPropertyFlags memory_flags, bool create_view, VkImageAspectFlags aspect_flags,
-    Image* image
-);
+/**
+ * Creates an image with its own memory. When `create_view` is set, the view covers every mip
+ * level and layer, and is a 2D array view if there is more than one layer.
+ */
+void vulkan_image_create(VulkanBackend* backend, VkImageType type, u32 width, u32 height,
+                         u32 mip_levels, u32 layer_count, VkFormat format, VkImageTiling tiling,
+                         VkImageUsageFlags usage, VkMemoryPropertyFlags memory_flags,
+                         bool create_view, VkImageAspectFlags aspect_flags, Image* image);
 
-void vulkan_image_create_view(VulkanBackend* backend, VkFormat format, VkImageAspectFlags aspect_flags, Image* image);
+void vulkan_image_create_view(VulkanBackend* backend, VkImageViewType view_type, VkFormat format,
+                              VkImageAspectFlags aspect_flags, Image* image);
 
 void vulkan_image_destroy(VulkanBackend* backend, Image* image);
 #endif
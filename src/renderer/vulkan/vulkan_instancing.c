@@ -0,0 +1,97 @@
+#include "vulkan_instancing.h"
+#include "core/mem.h"
+#include "vulkan_buffer.h"
+#include "vulkan_pipeline.h"
+
+bool vulkan_instancing_create(VulkanBackend* backend, u32 frame_count, Instancing* instancing) {
+    instancing->buffer_count = frame_count;
+    instancing->frame = 0;
+    instancing->instance_count = 0;
+    instancing->buffers = mem_alloc_tagged(sizeof(Buffer) * frame_count, MEM_TAG_RENDERER);
+    instancing->mapped = mem_alloc_tagged(sizeof(InstanceData*) * frame_count, MEM_TAG_RENDERER);
+    for (u32 i = 0; i < frame_count; i++) {
+        vulkan_buffer_create(backend, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             sizeof(InstanceData) * INSTANCE_BUFFER_CAPACITY, true,
+                             &instancing->buffers[i]);
+        instancing->mapped[i] = vulkan_buffer_map(backend, &instancing->buffers[i]);
+        if (!instancing->mapped[i]) {
+            ERROR("Failed to map instance buffer");
+            return false;
+        }
+    }
+    instancing->batches = vector_new(InstanceBatch);
+    return true;
+}
+
+void vulkan_instancing_begin(Instancing* instancing, u32 frame) {
+    instancing->frame = frame;
+    instancing->instance_count = 0;
+    vector_clear(instancing->batches);
+}
+
+static bool mesh_equals(MeshRange a, MeshRange b) {
+    return a.index_count == b.index_count && a.first_index == b.first_index &&
+           a.vertex_offset == b.vertex_offset;
+}
+
+void vulkan_instancing_push(Instancing* instancing, MeshRange mesh, const InstanceData* instances,
+                            u32 count) {
+    u32 available = INSTANCE_BUFFER_CAPACITY - instancing->instance_count;
+    if (count > available) {
+        WARN("Instance buffer is full, dropping %d instances", count - available);
+        count = available;
+    }
+    if (count == 0) {
+        return;
+    }
+    InstanceData* dst = instancing->mapped[instancing->frame] + instancing->instance_count;
+    mem_copy(dst, instances, sizeof(InstanceData) * count);
+
+    u64 batch_count = vector_length(instancing->batches);
+    InstanceBatch* last = batch_count > 0 ? &instancing->batches[batch_count - 1] : 0;
+    if (last && mesh_equals(last->mesh, mesh)) {
+        last->instance_count += count;
+    } else {
+        InstanceBatch batch = {0};
+        batch.mesh = mesh;
+        batch.first_instance = instancing->instance_count;
+        batch.instance_count = count;
+        vector_push(instancing->batches, batch);
+    }
+    instancing->instance_count += count;
+}
+
+void vulkan_instancing_draw(VulkanBackend* backend, Instancing* instancing, Shader* shader,
+                            CommandBuffer* command_buffer) {
+    u64 batch_count = vector_length(instancing->batches);
+    if (batch_count == 0) {
+        return;
+    }
+    VkCommandBuffer cmd = command_buffer->handle;
+    vulkan_pipeline_bind(backend, *command_buffer, &shader->instanced_pipeline);
+    VkDeviceSize offset = 0;
+    vkCmdBindVertexBuffers(cmd, 1, 1, &instancing->buffers[instancing->frame].handle, &offset);
+    for (u64 i = 0; i < batch_count; i++) {
+        InstanceBatch* batch = &instancing->batches[i];
+        vkCmdDrawIndexed(cmd, batch->mesh.index_count, batch->instance_count,
+                         batch->mesh.first_index, batch->mesh.vertex_offset,
+                         batch->first_instance);
+    }
+}
+
+void vulkan_instancing_destroy(VulkanBackend* backend, Instancing* instancing) {
+    for (u32 i = 0; i < instancing->buffer_count; i++) {
+        vulkan_buffer_unmap(backend, &instancing->buffers[i]);
+        vulkan_buffer_destroy(backend, &instancing->buffers[i]);
+    }
+    if (instancing->buffers) {
+        mem_free(instancing->buffers);
+        mem_free(instancing->mapped);
+    }
+    instancing->buffers = 0;
+    instancing->mapped = 0;
+    instancing->buffer_count = 0;
+    vector_free(instancing->batches);
+}
@@ -0,0 +1,32 @@
+#ifndef VULKAN_INSTANCING_H
+#define VULKAN_INSTANCING_H
+
+#include "vulkan_types.h"
+
+/**
+ * Creates one persistently mapped instance buffer per frame in flight.
+ */
+bool vulkan_instancing_create(VulkanBackend* backend, u32 frame_count, Instancing* instancing);
+
+/**
+ * Starts filling the buffer of the given frame slot. The previous submit that used the slot
+ * must have completed.
+ */
+void vulkan_instancing_begin(Instancing* instancing, u32 frame);
+
+/**
+ * Copies the instances into the mapped buffer. Extends the last batch when it draws the same
+ * mesh; instances past the buffer capacity are dropped.
+ */
+void vulkan_instancing_push(Instancing* instancing, MeshRange mesh, const InstanceData* instances,
+                            u32 count);
+
+/**
+ * Records one indexed draw per batch with the instanced pipeline. Leaves that pipeline bound.
+ */
+void vulkan_instancing_draw(VulkanBackend* backend, Instancing* instancing, Shader* shader,
+                            CommandBuffer* command_buffer);
+
+void vulkan_instancing_destroy(VulkanBackend* backend, Instancing* instancing);
+
+#endif
@@ -1,12 +1,40 @@
 #include "vulkan_pipeline.h"
 
-bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32 attribute_count,
+// Push constant ranges must fit within the device limit and be 4-byte aligned.
+static bool push_constant_ranges_valid(VulkanBackend* backend, u32 range_count,
+                                       VkPushConstantRange* ranges) {
+    u32 max_push_constants_size = backend->device.properties.limits.maxPushConstantsSize;
+    for (u32 i = 0; i < range_count; i++) {
+        VkPushConstantRange range = ranges[i];
+        if (range.offset % 4 != 0 || range.size % 4 != 0) {
+            ERROR("Push constant range %d is not 4-byte aligned (offset: %d, size: %d)", i,
+                  range.offset, range.size);
+            return false;
+        }
+        if (range.offset + range.size > max_push_constants_size) {
+            ERROR("Push constant range %d exceeds maxPushConstantsSize (%d > %d)", i,
+                  range.offset + range.size, max_push_constants_size);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32 binding_count,
+                                   VkVertexInputBindingDescription* vertex_bindings,
+                                   u32 attribute_count,
                                    VkVertexInputAttributeDescription* vertex_attributes,
                                    u32 descriptor_set_layout_count,
-                                   VkDescriptorSetLayout* descriptor_set_layouts, u32 stage_count,
+                                   VkDescriptorSetLayout* descriptor_set_layouts,
+                                   u32 push_constant_range_count,
+                                   VkPushConstantRange* push_constant_ranges, u32 stage_count,
                                    VkPipelineShaderStageCreateInfo* create_infos,
                                    VkViewport viewport, VkRect2D scissor, bool wireframe,
                                    Pipeline* pipeline) {
+    if (!push_constant_ranges_valid(backend, push_constant_range_count, push_constant_ranges)) {
+        return false;
+    }
+
     VkPipelineViewportStateCreateInfo viewport_state = {0};
     viewport_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewport_state.viewportCount = 1;
@@ -61,15 +89,10 @@ bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32
     dyn_state_create_info.dynamicStateCount = dynamic_state_count;
     dyn_state_create_info.pDynamicStates = dynamic_states;
 
-    VkVertexInputBindingDescription binding_description = {0};
-    binding_description.binding = 0;
-    binding_description.stride = sizeof(Vertex);
-    binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-
     VkPipelineVertexInputStateCreateInfo vertex_input_state = {0};
     vertex_input_state.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertex_input_state.vertexBindingDescriptionCount = 1;
-    vertex_input_state.pVertexBindingDescriptions = &binding_description;
+    vertex_input_state.vertexBindingDescriptionCount = binding_count;
+    vertex_input_state.pVertexBindingDescriptions = vertex_bindings;
     vertex_input_state.vertexAttributeDescriptionCount = attribute_count;
     vertex_input_state.pVertexAttributeDescriptions = vertex_attributes;
 
@@ -83,6 +106,8 @@ bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32
     pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
     pipeline_layout_create_info.setLayoutCount = descriptor_set_layout_count;
     pipeline_layout_create_info.pSetLayouts = descriptor_set_layouts;
+    pipeline_layout_create_info.pushConstantRangeCount = push_constant_range_count;
+    pipeline_layout_create_info.pPushConstantRanges = push_constant_ranges;
 
     VK_FN_CHECK(vkCreatePipelineLayout(backend->device.logical, &pipeline_layout_create_info,
                                        backend->allocator, &pipeline->layout));
@@ -105,12 +130,45 @@ bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32
     VK_FN_CHECK(vkCreateGraphicsPipelines(backend->device.logical, VK_NULL_HANDLE, 1,
                                           &pipeline_create_info, backend->allocator,
                                           &pipeline->pipeline));
+    pipeline->bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    return true;
+}
+
+bool vulkan_compute_pipeline_create(VulkanBackend* backend, u32 descriptor_set_layout_count,
+                                    VkDescriptorSetLayout* descriptor_set_layouts,
+                                    u32 push_constant_range_count,
+                                    VkPushConstantRange* push_constant_ranges,
+                                    VkPipelineShaderStageCreateInfo stage_info,
+                                    Pipeline* pipeline) {
+    if (!push_constant_ranges_valid(backend, push_constant_range_count, push_constant_ranges)) {
+        return false;
+    }
+
+    VkPipelineLayoutCreateInfo pipeline_layout_create_info = {0};
+    pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_create_info.setLayoutCount = descriptor_set_layout_count;
+    pipeline_layout_create_info.pSetLayouts = descriptor_set_layouts;
+    pipeline_layout_create_info.pushConstantRangeCount = push_constant_range_count;
+    pipeline_layout_create_info.pPushConstantRanges = push_constant_ranges;
+
+    VK_FN_CHECK(vkCreatePipelineLayout(backend->device.logical, &pipeline_layout_create_info,
+                                       backend->allocator, &pipeline->layout));
+
+    VkComputePipelineCreateInfo pipeline_create_info = {0};
+    pipeline_create_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipeline_create_info.stage = stage_info;
+    pipeline_create_info.layout = pipeline->layout;
 
+    VK_FN_CHECK(vkCreateComputePipelines(backend->device.logical, VK_NULL_HANDLE, 1,
+                                         &pipeline_create_info, backend->allocator,
+                                         &pipeline->pipeline));
+    pipeline->bind_point = VK_PIPELINE_BIND_POINT_COMPUTE;
     return true;
 }
 
 void vulkan_pipeline_bind(VulkanBackend* backend, CommandBuffer cmdbuf, Pipeline* pipeline) {
-    vkCmdBindPipeline(cmdbuf.handle, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->pipeline);
+    vkCmdBindPipeline(cmdbuf.handle, pipeline->bind_point, pipeline->pipeline);
 }
 
 void vulkan_pipeline_destroy(VulkanBackend* backend, Pipeline* pipeline) {
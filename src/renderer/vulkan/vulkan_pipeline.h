@@ -3,14 +3,25 @@
 
 #include "vulkan_types.h"
 
-bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32 attribute_count,
+bool vulkan_render_pipeline_create(VulkanBackend* backend, RenderPass* pass, u32 binding_count,
+                                   VkVertexInputBindingDescription* vertex_bindings,
+                                   u32 attribute_count,
                                    VkVertexInputAttributeDescription* vertex_attributes,
                                    u32 descriptor_set_layout_count,
-                                   VkDescriptorSetLayout* descriptor_set_layouts, u32 stage_count,
+                                   VkDescriptorSetLayout* descriptor_set_layouts,
+                                   u32 push_constant_range_count,
+                                   VkPushConstantRange* push_constant_ranges, u32 stage_count,
                                    VkPipelineShaderStageCreateInfo* create_infos,
                                    VkViewport viewport, VkRect2D scissor, bool wireframe,
                                    Pipeline* pipeline);
 
+bool vulkan_compute_pipeline_create(VulkanBackend* backend, u32 descriptor_set_layout_count,
+                                    VkDescriptorSetLayout* descriptor_set_layouts,
+                                    u32 push_constant_range_count,
+                                    VkPushConstantRange* push_constant_ranges,
+                                    VkPipelineShaderStageCreateInfo stage_info,
+                                    Pipeline* pipeline);
+
 void vulkan_pipeline_bind(VulkanBackend* backend, CommandBuffer cmdbuf, Pipeline* pipeline);
 
 void vulkan_pipeline_destroy(VulkanBackend* backend, Pipeline* pipeline);
@@ -2,7 +2,7 @@
 #include <vulkan/vulkan_core.h>
 
 void vulkan_renderpass_create(VulkanBackend* backend, Vec4 render_area, Vec4 clear, f32 depth,
-                              f32 stencil, RenderPass* pass) {
+                              f32 stencil, bool clear_attachments, RenderPass* pass) {
 
     pass->clear_color = clear;
     pass->depth = depth;
@@ -17,12 +17,15 @@ void vulkan_renderpass_create(VulkanBackend* backend, Vec4 render_area, Vec4 cle
     VkAttachmentDescription color_attachment = {0};
     color_attachment.format = backend->swapchain.format.format;
     color_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    color_attachment.loadOp =
+        clear_attachments ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
     color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // The scene target is blitted onto the swapchain image once the frame is rendered.
+    color_attachment.initialLayout =
+        clear_attachments ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    color_attachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 
     VkAttachmentReference color_attachment_ref = {0};
     color_attachment_ref.attachment = 0;
@@ -31,12 +34,16 @@ void vulkan_renderpass_create(VulkanBackend* backend, Vec4 render_area, Vec4 cle
     VkAttachmentDescription depth_attachment = {0};
     depth_attachment.format = backend->device.depth_format;
     depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
-    depth_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    // Depth is stored and left readable so the Hi-Z pyramid can be built from it.
+    depth_attachment.loadOp =
+        clear_attachments ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+    depth_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     depth_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     depth_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depth_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depth_attachment.initialLayout = clear_attachments
+                                         ? VK_IMAGE_LAYOUT_UNDEFINED
+                                         : VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+    depth_attachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 
     VkAttachmentReference depth_attachment_ref = {0};
     depth_attachment_ref.attachment = 1;
@@ -46,15 +53,45 @@ void vulkan_renderpass_create(VulkanBackend* backend, Vec4 render_area, Vec4 cle
     subpass.pColorAttachments = &color_attachment_ref;
     subpass.pDepthStencilAttachment = &depth_attachment_ref;
 
-    VkSubpassDependency subpass_dependency = {0};
-    subpass_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    subpass_dependency.dstSubpass = 0;
-    subpass_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpass_dependency.srcAccessMask = 0;
-    subpass_dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpass_dependency.dstAccessMask =
+    // Color writes must wait for the previous pass instance and for the blit of the previous
+    // frame, which reads the same scene target.
+    VkSubpassDependency subpass_dependencies[4] = {0};
+    subpass_dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    subpass_dependencies[0].dstSubpass = 0;
+    subpass_dependencies[0].srcStageMask =
+        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+    subpass_dependencies[0].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    subpass_dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    subpass_dependencies[0].dstAccessMask =
         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    // Depth writes must wait for the Hi-Z reduction of the previous pass to finish reading.
+    subpass_dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+    subpass_dependencies[1].dstSubpass = 0;
+    subpass_dependencies[1].srcStageMask =
+        VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    subpass_dependencies[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    subpass_dependencies[1].dstStageMask =
+        VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    subpass_dependencies[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+                                            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    // And the Hi-Z reduction must see the final depth values of this pass.
+    subpass_dependencies[2].srcSubpass = 0;
+    subpass_dependencies[2].dstSubpass = VK_SUBPASS_EXTERNAL;
+    subpass_dependencies[2].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    subpass_dependencies[2].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    subpass_dependencies[2].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    subpass_dependencies[2].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    // And the blit onto the swapchain image must see the final colors.
+    subpass_dependencies[3].srcSubpass = 0;
+    subpass_dependencies[3].dstSubpass = VK_SUBPASS_EXTERNAL;
+    subpass_dependencies[3].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    subpass_dependencies[3].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    subpass_dependencies[3].dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    subpass_dependencies[3].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
     // Maintain a list of attachments to be used by the render pass
     attachments[0] = color_attachment;
     attachments[1] = depth_attachment;
@@ -65,8 +102,8 @@ void vulkan_renderpass_create(VulkanBackend* backend, Vec4 render_area, Vec4 cle
     render_pass_info.pAttachments = attachments;
     render_pass_info.subpassCount = 1;
     render_pass_info.pSubpasses = &subpass;
-    render_pass_info.dependencyCount = 1;
-    render_pass_info.pDependencies = &subpass_dependency;
+    render_pass_info.dependencyCount = 4;
+    render_pass_info.pDependencies = subpass_dependencies;
 
     VK_FN_CHECK(vkCreateRenderPass(backend->device.logical, &render_pass_info, 0, &pass->handle));
 
@@ -3,8 +3,13 @@
 
 #include "vulkan_types.h"
 
+/**
+ * Creates the main render pass. When `clear` is false the pass loads the previous contents of
+ * its attachments instead, which lets a frame be split into several pass instances (e.g. the
+ * two Hi-Z culling phases) that share the same framebuffer.
+ */
 void vulkan_renderpass_create(VulkanBackend* backend, Vec4 render_area, Vec4 clear, f32 depth,
-                              f32 stencil, RenderPass* pass);
+                              f32 stencil, bool clear_attachments, RenderPass* pass);
 void vulkan_renderpass_begin(VulkanBackend* backend, RenderPass* pass,
                              CommandBuffer* command_buffer, VkFramebuffer framebuffer);
 void vulkan_renderpass_end(RenderPass* pass, CommandBuffer* command_buffer);
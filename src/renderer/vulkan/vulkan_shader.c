@@ -8,9 +8,11 @@
 #include <vulkan/vulkan_core.h>
 
 #define BUILTIN_SHADER_NAME "builtin.shader"
+#define BUILTIN_INSTANCED_SHADER_NAME "builtin_instanced.shader"
+#define SHADER_PUSH_CONSTANT_STAGES (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
 
-static bool create_shader_module(VulkanBackend* backend, const char* name, const char* type,
-                                 VkShaderStageFlagBits flag, u32 stage, Shader* shader) {
+bool vulkan_shader_module_create(VulkanBackend* backend, const char* name, const char* type,
+                                 VkShaderStageFlagBits flag, ShaderModule* module) {
     char file_name[256];
     str_format(file_name, 256, "bin/assets/shaders/%s.%s.spv", name, type);
 
@@ -33,8 +35,6 @@ static bool create_shader_module(VulkanBackend* backend, const char* name, const
     create_info.pCode = (u32*)shader_buffer;
     fs_close(&file);
 
-    ShaderModule* module = &shader->modules[stage];
-
     VK_FN_CHECK(vkCreateShaderModule(backend->device.logical, &create_info, backend->allocator,
                                      &module->handle));
 
@@ -51,39 +51,27 @@ static bool create_shader_module(VulkanBackend* backend, const char* name, const
         shader_buffer = 0;
     }
 
-    DEBUG("Loaded shader module: %s, bytes read: %d", file_name, bytes_read);
+    DEBUG("Loaded shader module: %s, bytes read: %llu", file_name, bytes_read);
     return true;
 }
 
-bool vulkan_shader_create(VulkanBackend* backend, Shader* shader) {
+bool vulkan_shader_load_modules(VulkanBackend* backend, Shader* shader) {
     VkShaderStageFlagBits shader_types[AVAILABLE_SHADER_STAGES] = {VK_SHADER_STAGE_VERTEX_BIT,
                                                                    VK_SHADER_STAGE_FRAGMENT_BIT};
     char* shader_type_names[] = {"vert", "frag"};
     for (u32 i = 0; i < AVAILABLE_SHADER_STAGES; i++) {
-        if (!create_shader_module(backend, BUILTIN_SHADER_NAME, shader_type_names[i],
-                                  shader_types[i], i, shader)) {
+        if (!vulkan_shader_module_create(backend, BUILTIN_SHADER_NAME, shader_type_names[i],
+                                         shader_types[i], &shader->modules[i])) {
             return false;
         }
     }
+    return vulkan_shader_module_create(backend, BUILTIN_INSTANCED_SHADER_NAME, "vert",
+                                       VK_SHADER_STAGE_VERTEX_BIT, &shader->instanced_vert_module);
+}
 
+bool vulkan_shader_create_pipelines(VulkanBackend* backend, Shader* shader) {
     vulkan_descriptor_set_layout_create(backend, 0, &shader->descriptor_layout);
 
-    // GlobalsUBO buffer
-
-    Buffer* buffers = mem_alloc(sizeof(Buffer) * backend->swapchain.max_frames_in_flight);
-
-    for (u32 i = 0; i < backend->swapchain.max_frames_in_flight; i++) {
-        vulkan_buffer_create(
-            backend, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            sizeof(GlobalsUBO), true, &buffers[i]);
-    }
-
-    shader->globals_buffer = buffers;
-
-    vulkan_descriptor_set_pool_create(backend, backend->swapchain.max_frames_in_flight,
-                                      &shader->descriptor_pool);
     const u32 descriptor_set_layout_count = 1;
     VkDescriptorSetLayout descriptor_set_layouts[1] = {shader->descriptor_layout};
 
@@ -99,15 +87,31 @@ bool vulkan_shader_create(VulkanBackend* backend, Shader* shader) {
     scissor.offset = (VkOffset2D){0, 0};
     scissor.extent = (VkExtent2D){backend->framebuffer_width, backend->framebuffer_height};
 
-    const u32 attribute_count = 1;
-    VkVertexInputAttributeDescription attribute_descriptions[attribute_count];
-    VkFormat formats[] = {VK_FORMAT_R32G32B32_SFLOAT};
-
-    u32 strides[] = {sizeof(Vertex)};
+    // Binding 0 holds Vertex, binding 1 InstanceData for the instanced pipeline only.
+    VkVertexInputBindingDescription bindings[2] = {0};
+    bindings[0].binding = 0;
+    bindings[0].stride = sizeof(Vertex);
+    bindings[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    bindings[1].binding = 1;
+    bindings[1].stride = sizeof(InstanceData);
+    bindings[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    const u32 attribute_count = 2;
+    const u32 instanced_attribute_count = 5;
+    VkVertexInputAttributeDescription attribute_descriptions[5];
+    VkFormat formats[] = {VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                          VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_R32_SFLOAT,
+                          VK_FORMAT_R32_UINT};
+    u32 attribute_bindings[] = {0, 0, 1, 1, 1};
+
+    u32 strides[] = {sizeof(Vec3), sizeof(Vec2), sizeof(Vec4), sizeof(f32), sizeof(u32)};
     u32 offset = 0;
-    for (u32 i = 0; i < attribute_count; i++) {
+    for (u32 i = 0; i < instanced_attribute_count; i++) {
+        if (i > 0 && attribute_bindings[i] != attribute_bindings[i - 1]) {
+            offset = 0;
+        }
         VkVertexInputAttributeDescription attribute_description = {0};
-        attribute_description.binding = 0;
+        attribute_description.binding = attribute_bindings[i];
         attribute_description.location = i;
         attribute_description.format = formats[i];
         attribute_descriptions[i] = attribute_description;
@@ -120,32 +124,94 @@ bool vulkan_shader_create(VulkanBackend* backend, Shader* shader) {
         stage_create_infos[i] = shader->modules[i].stage_info;
     }
 
-    vulkan_render_pipeline_create(
-        backend, &backend->main_pass, attribute_count, attribute_descriptions,
-        descriptor_set_layout_count, descriptor_set_layouts, AVAILABLE_SHADER_STAGES,
-        stage_create_infos, viewport, scissor, false, &backend->basic_shader.pipeline);
+    // Per-draw data (see DrawConstants) goes through push constants.
+    const u32 push_constant_range_count = 1;
+    VkPushConstantRange push_constant_ranges[1] = {0};
+    push_constant_ranges[0].stageFlags = SHADER_PUSH_CONSTANT_STAGES;
+    push_constant_ranges[0].offset = 0;
+    push_constant_ranges[0].size = sizeof(DrawConstants);
+
+    if (!vulkan_render_pipeline_create(
+            backend, &backend->main_pass, 1, bindings, attribute_count, attribute_descriptions,
+            descriptor_set_layout_count, descriptor_set_layouts, push_constant_range_count,
+            push_constant_ranges, AVAILABLE_SHADER_STAGES, stage_create_infos, viewport, scissor,
+            false, &shader->pipeline)) {
+        ERROR("Failed to create Vulkan Basic Pipeline");
+        return false;
+    }
+
+    stage_create_infos[0] = shader->instanced_vert_module.stage_info;
+    // The layouts are identical, so descriptor sets stay bound when switching pipelines.
+    if (!vulkan_render_pipeline_create(
+            backend, &backend->main_pass, 2, bindings, instanced_attribute_count,
+            attribute_descriptions, descriptor_set_layout_count, descriptor_set_layouts,
+            push_constant_range_count, push_constant_ranges, AVAILABLE_SHADER_STAGES,
+            stage_create_infos, viewport, scissor, false, &shader->instanced_pipeline)) {
+        ERROR("Failed to create Vulkan Instanced Pipeline");
+        return false;
+    }
+    DEBUG("Vulkan Basic Pipeline created.");
+    return true;
+}
+
+void vulkan_shader_create_resources(VulkanBackend* backend, Shader* shader) {
+    // GlobalsUBO buffer
+
+    Buffer* buffers = mem_alloc_tagged(sizeof(Buffer) * backend->swapchain.max_frames_in_flight,
+                                       MEM_TAG_RENDERER);
+
+    for (u32 i = 0; i < backend->swapchain.max_frames_in_flight; i++) {
+        vulkan_buffer_create(
+            backend, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            sizeof(GlobalsUBO), true, &buffers[i]);
+    }
+
+    shader->globals_buffer = buffers;
+
+    vulkan_descriptor_set_pool_create(backend, backend->swapchain.max_frames_in_flight,
+                                      &shader->descriptor_pool);
 
     shader->descriptor_sets = vulkan_descriptor_set_create(backend, shader->descriptor_pool,
                                                            backend->swapchain.max_frames_in_flight);
 
     vulkan_descriptor_set_update(backend, shader->descriptor_sets, shader->globals_buffer,
                                  backend->swapchain.max_frames_in_flight);
+}
 
-    DEBUG("Vulkan Basic Pipeline created.");
+bool vulkan_shader_create(VulkanBackend* backend, Shader* shader) {
+    if (!vulkan_shader_load_modules(backend, shader) ||
+        !vulkan_shader_create_pipelines(backend, shader)) {
+        return false;
+    }
+    vulkan_shader_create_resources(backend, shader);
     return true;
 }
+
 void vulkan_shader_bind(VulkanBackend* backend, Shader* shader) {
     u32 image_index = backend->image_index;
     vulkan_pipeline_bind(backend, backend->graphics_command_buffers[image_index],
                          &backend->basic_shader.pipeline);
 }
 
+void vulkan_shader_push_constants(VulkanBackend* backend, Shader* shader, u32 offset, u32 size,
+                                  const void* data) {
+    u32 image_index = backend->image_index;
+    vkCmdPushConstants(backend->graphics_command_buffers[image_index].handle,
+                       shader->pipeline.layout, SHADER_PUSH_CONSTANT_STAGES, offset, size, data);
+}
+
 void vulkan_shader_destroy(VulkanBackend* backend, Shader* shader) {
 
     vulkan_descriptor_set_destroy(backend, &shader->descriptor_layout, shader->globals_buffer,
                                   shader->descriptor_pool);
 
     vulkan_pipeline_destroy(backend, &backend->basic_shader.pipeline);
+    vulkan_pipeline_destroy(backend, &shader->instanced_pipeline);
+    vkDestroyShaderModule(backend->device.logical, shader->instanced_vert_module.handle,
+                          backend->allocator);
+    shader->instanced_vert_module.handle = 0;
     for (u32 i = 0; i < AVAILABLE_SHADER_STAGES; i++) {
         ShaderModule* module = &shader->modules[i];
         vkDestroyShaderModule(backend->device.logical, module->handle, backend->allocator);
@@ -3,8 +3,25 @@
 
 #include "vulkan_types.h"
 
+/**
+ * Loads `bin/assets/shaders/<name>.<type>.spv` and creates a shader module for the given stage.
+ */
+bool vulkan_shader_module_create(VulkanBackend* backend, const char* name, const char* type,
+                                 VkShaderStageFlagBits flag, ShaderModule* module);
+
+/**
+ * The shader is built in three steps so startup can overlap them with other work:
+ * loading the SPIR-V modules and compiling the pipelines only need the device and the main
+ * render pass, while the per-frame resources need the swapchain. `vulkan_shader_create` runs
+ * all three in order.
+ */
+bool vulkan_shader_load_modules(VulkanBackend* backend, Shader* shader);
+bool vulkan_shader_create_pipelines(VulkanBackend* backend, Shader* shader);
+void vulkan_shader_create_resources(VulkanBackend* backend, Shader* shader);
 bool vulkan_shader_create(VulkanBackend* backend, Shader* shader);
 void vulkan_shader_bind(VulkanBackend* backend, Shader* shader);
+void vulkan_shader_push_constants(VulkanBackend* backend, Shader* shader, u32 offset, u32 size,
+                                  const void* data);
 void vulkan_shader_destroy(VulkanBackend* backend, Shader* shader);
 
 #endif
\ No newline at end of file
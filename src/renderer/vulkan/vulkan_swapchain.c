@@ -42,34 +42,64 @@ void vulkan_swapchain_present(VulkanBackend* context, Swapchain* swapchain, VkQu
     context->current_frame = (context->current_frame + 1) % swapchain->max_frames_in_flight;
 }
 
-static void create(VulkanBackend* backend, u32 w, u32 h, Swapchain* out) {
-    bool preferred_image_format_found = false;
+static bool present_mode_supported(SwapchainSupport* support, VkPresentModeKHR mode) {
+    for (u32 i = 0; i < support->present_mode_count; i++) {
+        if (support->present_modes[i] == mode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static VkPresentModeKHR select_present_mode(SwapchainSupport* support, PresentMode requested) {
+    // Preferred mode first, then the closest alternative. FIFO is always supported.
+    VkPresentModeKHR candidates[2];
+    switch (requested) {
+    case PRESENT_MODE_FIFO_RELAXED:
+        candidates[0] = candidates[1] = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+        break;
+    case PRESENT_MODE_MAILBOX:
+        candidates[0] = VK_PRESENT_MODE_MAILBOX_KHR;
+        candidates[1] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        break;
+    case PRESENT_MODE_IMMEDIATE:
+        candidates[0] = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        candidates[1] = VK_PRESENT_MODE_MAILBOX_KHR;
+        break;
+    case PRESENT_MODE_FIFO:
+    default:
+        candidates[0] = candidates[1] = VK_PRESENT_MODE_FIFO_KHR;
+        break;
+    }
+    for (u32 i = 0; i < 2; i++) {
+        if (present_mode_supported(support, candidates[i])) {
+            return candidates[i];
+        }
+    }
+    WARN("Requested present mode is not supported, falling back to FIFO.");
+    return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+void vulkan_swapchain_select_format(VulkanBackend* backend, Swapchain* swapchain) {
     SwapchainSupport* support = &backend->device.swapchain_support;
     for (u32 i = 0; i < support->format_count; i++) {
         VkSurfaceFormatKHR format = support->formats[i];
         if (format.format == VK_FORMAT_B8G8R8A8_UNORM &&
             format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
-            out->format = format;
-            preferred_image_format_found = true;
-            break;
+            swapchain->format = format;
+            return;
         }
     }
+    swapchain->format = support->formats[0];
+}
 
-    if (!preferred_image_format_found) {
-        out->format = support->formats[0];
-    }
+static void create(VulkanBackend* backend, u32 w, u32 h, Swapchain* out) {
+    SwapchainSupport* support = &backend->device.swapchain_support;
+    vulkan_swapchain_select_format(backend, out);
 
-    VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR;
-    for (u32 i = 0; i < support->present_mode_count; i++) {
-        VkPresentModeKHR supported_mode = support->present_modes[i];
-        // Break if we found a better mode
-        if (supported_mode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            mode = supported_mode;
-            break;
-        }
-    }
     // Requery swapchain support
     vulkan_device_query_swapchain_support(backend->device.physical, backend->surface, support);
+    VkPresentModeKHR mode = select_present_mode(support, backend->present_mode);
 
     VkExtent2D swapchain_extent = {w, h};
 
@@ -102,7 +132,9 @@ static void create(VulkanBackend* backend, u32 w, u32 h, Swapchain* out) {
     swapchain_create_info.imageFormat = out->format.format;
     swapchain_create_info.imageColorSpace = out->format.colorSpace;
     swapchain_create_info.imageExtent = swapchain_extent;
-    swapchain_create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    // The scene is blitted onto the image instead of being rendered into it.
+    swapchain_create_info.imageUsage =
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
 
     // Setup the queue family indices
     if (backend->device.queue_family_indices.graphics_family !=
@@ -126,14 +158,15 @@ static void create(VulkanBackend* backend, u32 w, u32 h, Swapchain* out) {
     swapchain_create_info.oldSwapchain = 0;
     VK_FN_CHECK(vkCreateSwapchainKHR(backend->device.logical, &swapchain_create_info,
                                      backend->allocator, &out->handle));
+    out->extent = swapchain_extent;
     // Get images
     VK_FN_CHECK(
         vkGetSwapchainImagesKHR(backend->device.logical, out->handle, &out->image_count, 0));
     if (!out->images) {
-        out->images = mem_alloc(sizeof(VkImage) * out->image_count);
+        out->images = mem_alloc_tagged(sizeof(VkImage) * out->image_count, MEM_TAG_RENDERER);
     }
     if (!out->views) {
-        out->views = mem_alloc(sizeof(VkImageView) * out->image_count);
+        out->views = mem_alloc_tagged(sizeof(VkImageView) * out->image_count, MEM_TAG_RENDERER);
     }
 
     VK_FN_CHECK(vkGetSwapchainImagesKHR(backend->device.logical, out->handle, &out->image_count,
@@ -153,14 +186,27 @@ static void create(VulkanBackend* backend, u32 w, u32 h, Swapchain* out) {
                                       &out->views[i]));
     }
 
+    vulkan_image_create(backend, VK_IMAGE_TYPE_2D, swapchain_extent.width, swapchain_extent.height,
+                        1, 1, out->format.format, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VK_IMAGE_ASPECT_COLOR_BIT,
+                        &out->color_image);
+    VkFormatProperties format_properties;
+    vkGetPhysicalDeviceFormatProperties(backend->device.physical, out->format.format,
+                                        &format_properties);
+    VkFormatFeatureFlags linear = VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    out->blit_filter = (format_properties.optimalTilingFeatures & linear) ? VK_FILTER_LINEAR
+                                                                          : VK_FILTER_NEAREST;
+
     if (!vulkan_device_detect_depth_format(&backend->device)) {
         backend->device.depth_format = VK_FORMAT_UNDEFINED;
         ERROR("Failed to find a supported Depth format for the current device.");
     }
 
+    // The depth image is also sampled to build the Hi-Z pyramid.
     vulkan_image_create(backend, VK_IMAGE_TYPE_2D, swapchain_extent.width, swapchain_extent.height,
-                        backend->device.depth_format, VK_IMAGE_TILING_OPTIMAL,
-                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                        1, 1, backend->device.depth_format, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, VK_IMAGE_ASPECT_DEPTH_BIT,
                         &out->depth_image);
 }
@@ -184,12 +230,58 @@ bool vulkan_swapchain_acquire_next_image(VulkanBackend* backend, VkSemaphore sem
     return false;
 }
 
+void vulkan_swapchain_blit_scene(Swapchain* swapchain, CommandBuffer* command_buffer,
+                                 u32 image_index, u32 scene_width, u32 scene_height) {
+    VkCommandBuffer cmd = command_buffer->handle;
+
+    // The previous contents are discarded. The acquire semaphore is waited on at the transfer
+    // stage, which this barrier chains to.
+    VkImageMemoryBarrier to_transfer = {0};
+    to_transfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    to_transfer.srcAccessMask = 0;
+    to_transfer.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_transfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    to_transfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    to_transfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_transfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    to_transfer.image = swapchain->images[image_index];
+    to_transfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    to_transfer.subresourceRange.levelCount = 1;
+    to_transfer.subresourceRange.layerCount = 1;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, 0, 0, 0, 1, &to_transfer);
+
+    VkImageBlit region = {0};
+    region.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.srcSubresource.layerCount = 1;
+    region.srcOffsets[1].x = (i32)scene_width;
+    region.srcOffsets[1].y = (i32)scene_height;
+    region.srcOffsets[1].z = 1;
+    region.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.dstSubresource.layerCount = 1;
+    region.dstOffsets[1].x = (i32)swapchain->extent.width;
+    region.dstOffsets[1].y = (i32)swapchain->extent.height;
+    region.dstOffsets[1].z = 1;
+    vkCmdBlitImage(cmd, swapchain->color_image.handle, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   swapchain->images[image_index], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                   &region, swapchain->blit_filter);
+
+    VkImageMemoryBarrier to_present = to_transfer;
+    to_present.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    to_present.dstAccessMask = 0;
+    to_present.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    to_present.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, 0, 0, 0, 1, &to_present);
+}
+
 void vulkan_swapchain_destroy(VulkanBackend* context, Swapchain* swapchain) {
     destroy(context, swapchain);
 }
 
 static void destroy(VulkanBackend* backend, Swapchain* out) {
     vkDeviceWaitIdle(backend->device.logical);
+    vulkan_image_destroy(backend, &out->color_image);
     vulkan_image_destroy(backend, &out->depth_image);
     // The swapchain takes care of destroying the images.
     // however we need to destroy the image views.
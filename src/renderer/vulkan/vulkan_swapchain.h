@@ -4,6 +4,11 @@
 #include "vulkan_types.h"
 
 bool vulkan_swapchain_create(VulkanBackend* context, u32 width, u32 height, Swapchain* ptr);
+/**
+ * Picks the surface format the swapchain will use. It only depends on the surface, so render
+ * passes can be created from it before the swapchain exists.
+ */
+void vulkan_swapchain_select_format(VulkanBackend* backend, Swapchain* swapchain);
 void vulkan_swapchain_recreate(VulkanBackend* context, u32 width, u32 height, Swapchain* ptr);
 void vulkan_swapchain_present(
     VulkanBackend* context, Swapchain* swapchain, VkQueue graphics_queue, VkQueue present_queue,
@@ -13,6 +18,13 @@ bool vulkan_swapchain_acquire_next_image(
     VulkanBackend* backend, VkSemaphore semaphore, VkFence fence, Swapchain* swapchain, u64 timeout,
     u32* image_index
 );
+/**
+ * Records the upscale of the top-left `scene_width` x `scene_height` region of the scene target,
+ * which must be in TRANSFER_SRC_OPTIMAL, onto the swapchain image and leaves the image ready
+ * to present.
+ */
+void vulkan_swapchain_blit_scene(Swapchain* swapchain, CommandBuffer* command_buffer,
+                                 u32 image_index, u32 scene_width, u32 scene_height);
 void vulkan_swapchain_destroy(VulkanBackend* context, Swapchain* swapchain);
 
 #endif
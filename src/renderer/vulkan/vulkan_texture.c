@@ -0,0 +1,139 @@
+#include "vulkan_texture.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_deletion_queue.h"
+#include "vulkan_image.h"
+
+#define TEXTURE_FORMAT VK_FORMAT_R8G8B8A8_UNORM
+
+static void level_barrier(CommandBuffer* command_buffer, TextureArray* textures, u32 level,
+                          VkImageLayout old_layout, VkImageLayout new_layout,
+                          VkAccessFlags src_access, VkAccessFlags dst_access,
+                          VkPipelineStageFlags src_stage, VkPipelineStageFlags dst_stage) {
+    VkImageMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = src_access;
+    barrier.dstAccessMask = dst_access;
+    barrier.oldLayout = old_layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = textures->image.handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = level;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = textures->image.layer_count;
+    vkCmdPipelineBarrier(command_buffer->handle, src_stage, dst_stage, 0, 0, 0, 0, 0, 1, &barrier);
+}
+
+bool vulkan_texture_array_create(VulkanBackend* backend, const TextureArrayData* data,
+                                 TextureArray* textures) {
+    vulkan_image_create(backend, VK_IMAGE_TYPE_2D, data->size, data->size, data->mip_levels,
+                        data->layer_count, TEXTURE_FORMAT, VK_IMAGE_TILING_OPTIMAL,
+                        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false, VK_IMAGE_ASPECT_COLOR_BIT,
+                        &textures->image);
+    // Always an array view, even for a single layer, to match the sampler2DArray binding.
+    vulkan_image_create_view(backend, VK_IMAGE_VIEW_TYPE_2D_ARRAY, TEXTURE_FORMAT,
+                             VK_IMAGE_ASPECT_COLOR_BIT, &textures->image);
+
+    u64 staging_size = 0;
+    for (u32 level = 0; level < data->mip_levels; level++) {
+        textures->level_offsets[level] = data->level_offsets[level];
+        staging_size += data->level_sizes[level];
+    }
+    vulkan_buffer_create(backend, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         staging_size, true, &textures->staging);
+    vulkan_buffer_write(backend, &textures->staging, 0, staging_size, 0, data->pixels);
+
+    VkSamplerCreateInfo sampler_info = {0};
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.magFilter = VK_FILTER_NEAREST;
+    sampler_info.minFilter = VK_FILTER_LINEAR;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+    if (vkCreateSampler(backend->device.logical, &sampler_info, backend->allocator,
+                        &textures->sampler) != VK_SUCCESS) {
+        ERROR("Failed to create texture array sampler");
+        return false;
+    }
+
+    // The descriptor covers every level, so all of them must be in a sampled layout before
+    // the first draw. The shader never reads levels that are not resident yet.
+    CommandBuffer command_buffer;
+    vulkan_command_buffer_allocate_and_begin_single_use(
+        backend, backend->device.graphics_command_pool, &command_buffer);
+    VkImageMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = textures->image.handle;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = data->mip_levels;
+    barrier.subresourceRange.layerCount = data->layer_count;
+    vkCmdPipelineBarrier(command_buffer.handle, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, 0, 0, 0, 1, &barrier);
+    vulkan_command_buffer_end_single_use(backend, backend->device.graphics_command_pool,
+                                         &command_buffer, backend->device.graphics_queue);
+
+    textures->resident_mip = data->mip_levels;
+    return true;
+}
+
+void vulkan_texture_array_stream(VulkanBackend* backend, TextureArray* textures,
+                                 CommandBuffer* command_buffer) {
+    if (textures->resident_mip == 0) {
+        return;
+    }
+    u32 level = textures->resident_mip - 1;
+    u32 size = textures->image.width >> level;
+    if (size == 0) {
+        size = 1;
+    }
+
+    // The old contents of the level were never valid, so they can be discarded.
+    level_barrier(command_buffer, textures, level, VK_IMAGE_LAYOUT_UNDEFINED,
+                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
+    VkBufferImageCopy region = {0};
+    region.bufferOffset = textures->level_offsets[level];
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = level;
+    region.imageSubresource.layerCount = textures->image.layer_count;
+    region.imageExtent.width = size;
+    region.imageExtent.height = size;
+    region.imageExtent.depth = 1;
+    vkCmdCopyBufferToImage(command_buffer->handle, textures->staging.handle,
+                           textures->image.handle, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+                           &region);
+
+    level_barrier(command_buffer, textures, level, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                  VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+
+    textures->resident_mip = level;
+    if (level == 0) {
+        vulkan_deletion_queue_push_buffer(backend, &textures->staging);
+    }
+}
+
+void vulkan_texture_array_destroy(VulkanBackend* backend, TextureArray* textures) {
+    if (textures->staging.handle) {
+        vulkan_buffer_destroy(backend, &textures->staging);
+    }
+    if (textures->sampler) {
+        vkDestroySampler(backend->device.logical, textures->sampler, backend->allocator);
+        textures->sampler = 0;
+    }
+    vulkan_image_destroy(backend, &textures->image);
+    textures->resident_mip = 0;
+}
@@ -0,0 +1,23 @@
+#ifndef VULKAN_TEXTURE_H
+#define VULKAN_TEXTURE_H
+
+#include "vulkan_types.h"
+
+/**
+ * Creates a sampled 2D texture array for the layers in `data` and stages every mip level
+ * in host-visible memory. Nothing is copied to the image yet: call
+ * vulkan_texture_array_stream once per frame to upload the levels, coarsest first.
+ */
+bool vulkan_texture_array_create(VulkanBackend* backend, const TextureArrayData* data,
+                                 TextureArray* textures);
+
+/**
+ * Records the upload of the next pending mip level into the command buffer. Must be
+ * recorded outside of a render pass. Does nothing once every level is resident.
+ */
+void vulkan_texture_array_stream(VulkanBackend* backend, TextureArray* textures,
+                                 CommandBuffer* command_buffer);
+
+void vulkan_texture_array_destroy(VulkanBackend* backend, TextureArray* textures);
+
+#endif
@@ -0,0 +1,118 @@
+#include "vulkan_timeline.h"
+#include "core/log.h"
+#include "defines.h"
+
+bool vulkan_timeline_create(VulkanBackend* backend, VkQueue queue, Timeline* timeline) {
+    VkSemaphoreTypeCreateInfo type_info = {0};
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo create_info = {0};
+    create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    create_info.pNext = &type_info;
+
+    VkResult result = vkCreateSemaphore(backend->device.logical, &create_info, backend->allocator,
+                                        &timeline->semaphore);
+    if (result != VK_SUCCESS) {
+        ERROR("Failed to create timeline semaphore");
+        return false;
+    }
+    timeline->queue = queue;
+    timeline->value = 0;
+    return true;
+}
+
+void vulkan_timeline_destroy(VulkanBackend* backend, Timeline* timeline) {
+    if (timeline->semaphore) {
+        vkDestroySemaphore(backend->device.logical, timeline->semaphore, backend->allocator);
+    }
+    timeline->semaphore = VK_NULL_HANDLE;
+    timeline->queue = VK_NULL_HANDLE;
+    timeline->value = 0;
+}
+
+bool vulkan_timeline_submit(VulkanBackend* backend, Timeline* timeline, u32 command_buffer_count,
+                            const VkCommandBuffer* command_buffers, u32 wait_count,
+                            const TimelineWait* waits, VkSemaphore binary_signal, u64* value) {
+    UNUSED(backend);
+    // One extra slot keeps the arrays valid when there is nothing to wait on.
+    VkSemaphore wait_semaphores[wait_count + 1];
+    u64 wait_values[wait_count + 1];
+    VkPipelineStageFlags wait_stages[wait_count + 1];
+    for (u32 i = 0; i < wait_count; i++) {
+        wait_semaphores[i] = waits[i].semaphore;
+        wait_values[i] = waits[i].value;
+        wait_stages[i] = waits[i].stage;
+    }
+
+    u64 signal_value = timeline->value + 1;
+    VkSemaphore signal_semaphores[2] = {timeline->semaphore, binary_signal};
+    u64 signal_values[2] = {signal_value, 0};
+    u32 signal_count = binary_signal ? 2 : 1;
+
+    VkTimelineSemaphoreSubmitInfo timeline_info = {0};
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.waitSemaphoreValueCount = wait_count;
+    timeline_info.pWaitSemaphoreValues = wait_values;
+    timeline_info.signalSemaphoreValueCount = signal_count;
+    timeline_info.pSignalSemaphoreValues = signal_values;
+
+    VkSubmitInfo submit_info = {0};
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = &timeline_info;
+    submit_info.waitSemaphoreCount = wait_count;
+    submit_info.pWaitSemaphores = wait_semaphores;
+    submit_info.pWaitDstStageMask = wait_stages;
+    submit_info.commandBufferCount = command_buffer_count;
+    submit_info.pCommandBuffers = command_buffers;
+    submit_info.signalSemaphoreCount = signal_count;
+    submit_info.pSignalSemaphores = signal_semaphores;
+
+    VkResult result = vkQueueSubmit(timeline->queue, 1, &submit_info, VK_NULL_HANDLE);
+    if (result != VK_SUCCESS) {
+        ERROR("Failed to submit work.");
+        return false;
+    }
+    timeline->value = signal_value;
+    if (value) {
+        *value = signal_value;
+    }
+    return true;
+}
+
+u64 vulkan_timeline_completed(VulkanBackend* backend, const Timeline* timeline) {
+    u64 value = 0;
+    VK_FN_CHECK(vkGetSemaphoreCounterValue(backend->device.logical, timeline->semaphore, &value));
+    return value;
+}
+
+bool vulkan_timeline_wait(VulkanBackend* backend, const Timeline* timeline, u64 value,
+                          u64 timeout) {
+    if (value == 0) {
+        return true;
+    }
+    VkSemaphoreWaitInfo wait_info = {0};
+    wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    wait_info.semaphoreCount = 1;
+    wait_info.pSemaphores = &timeline->semaphore;
+    wait_info.pValues = &value;
+    VkResult result = vkWaitSemaphores(backend->device.logical, &wait_info, timeout);
+    if (result == VK_TIMEOUT) {
+        return false;
+    }
+    if (result != VK_SUCCESS) {
+        ERROR("Failed to wait for timeline value %llu", (unsigned long long)value);
+        return false;
+    }
+    return true;
+}
+
+TimelineWait vulkan_timeline_wait_for(const Timeline* timeline, u64 value,
+                                      VkPipelineStageFlags stage) {
+    TimelineWait wait = {0};
+    wait.semaphore = timeline->semaphore;
+    wait.value = value;
+    wait.stage = stage;
+    return wait;
+}
@@ -0,0 +1,35 @@
+#ifndef VULKAN_TIMELINE_H
+#define VULKAN_TIMELINE_H
+
+#include "vulkan_types.h"
+
+bool vulkan_timeline_create(VulkanBackend* backend, VkQueue queue, Timeline* timeline);
+void vulkan_timeline_destroy(VulkanBackend* backend, Timeline* timeline);
+
+/**
+ * Submits command buffers to the timeline's queue. The submit signals the next timeline value,
+ * written to `value`, plus `binary_signal` when it is not VK_NULL_HANDLE.
+ * Waits may mix timeline semaphores of other queues with binary semaphores.
+ */
+bool vulkan_timeline_submit(VulkanBackend* backend, Timeline* timeline, u32 command_buffer_count,
+                            const VkCommandBuffer* command_buffers, u32 wait_count,
+                            const TimelineWait* waits, VkSemaphore binary_signal, u64* value);
+
+/**
+ * Returns the highest value the GPU has reached on the timeline.
+ */
+u64 vulkan_timeline_completed(VulkanBackend* backend, const Timeline* timeline);
+
+/**
+ * Blocks until the timeline reaches `value`. Returns false on timeout or device loss.
+ */
+bool vulkan_timeline_wait(VulkanBackend* backend, const Timeline* timeline, u64 value,
+                          u64 timeout);
+
+/**
+ * Builds a wait on `value` of the timeline, for submits on another queue.
+ */
+TimelineWait vulkan_timeline_wait_for(const Timeline* timeline, u64 value,
+                                      VkPipelineStageFlags stage);
+
+#endif
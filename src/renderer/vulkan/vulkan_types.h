@@ -5,11 +5,13 @@
 #include "core/log.h"
 #include "math/lineal_types.h"
 #include "renderer/renderer_backend.h"
+#include "renderer/texture.h"
 #include "vulkan/vulkan.h"
 #include "vulkan_utils.h"
 
 typedef struct Vertex {
     Vec3 pos;
+    Vec2 uv;
 } Vertex;
 
 typedef struct Buffer {
@@ -56,6 +58,8 @@ typedef struct Image {
     VkDeviceMemory memory;
     u32 width;
     u32 height;
+    u32 mip_levels;
+    u32 layer_count;
 } Image;
 
 typedef struct ShaderModule {
@@ -66,6 +70,7 @@ typedef struct ShaderModule {
 typedef struct Pipeline {
     VkPipeline pipeline;
     VkPipelineLayout layout;
+    VkPipelineBindPoint bind_point;
 } Pipeline;
 
 #define AVAILABLE_SHADER_STAGES 2
@@ -79,11 +84,65 @@ typedef struct Shader {
     VkDescriptorSetLayout descriptor_layout;
     ShaderModule modules[AVAILABLE_SHADER_STAGES];
     Pipeline pipeline;
+    // Same layout and fragment stage, but the vertex stage also reads InstanceData.
+    ShaderModule instanced_vert_module;
+    Pipeline instanced_pipeline;
     GlobalsUBO globals;
     Buffer* globals_buffer;
 
 } Shader;
 
+// Enough levels for a 32768x32768 depth buffer.
+#define HIZ_MAX_MIP_LEVELS 16
+#define HIZ_MAX_CHUNKS 16384
+
+typedef enum HiZCullPhase {
+    // Draws whatever was visible last frame, no occlusion test.
+    HIZ_CULL_PHASE_EARLY,
+    // Tests every chunk against the pyramid built from the early pass depth and
+    // draws the ones that became visible.
+    HIZ_CULL_PHASE_LATE,
+} HiZCullPhase;
+
+typedef struct HiZ {
+    // R32_SFLOAT max-depth pyramid, level 0 is the depth buffer rounded down to a power of two.
+    Image pyramid;
+    VkImageView mip_views[HIZ_MAX_MIP_LEVELS];
+    VkSampler sampler;
+
+    VkDescriptorSetLayout reduce_layout;
+    VkDescriptorSetLayout cull_layout;
+    // Recreated together with the pyramid since it references the depth attachment.
+    VkDescriptorPool descriptor_pool;
+    VkDescriptorSet reduce_sets[HIZ_MAX_MIP_LEVELS];
+    VkDescriptorSet cull_set;
+
+    ShaderModule reduce_module;
+    ShaderModule cull_module;
+    Pipeline reduce_pipeline;
+    Pipeline cull_pipeline;
+
+    // ChunkDraw per chunk, written by the CPU.
+    Buffer chunk_buffer;
+    // VkDrawIndexedIndirectCommand per chunk, written by the culling shader.
+    Buffer indirect_buffer;
+    // 1 if the chunk was visible after the last late phase, 0 otherwise.
+    Buffer visibility_buffer;
+    u32 chunk_count;
+    // Set when the chunk set changed and the visibility buffer must be cleared.
+    bool visibility_dirty;
+} HiZ;
+
+typedef struct TextureArray {
+    Image image;
+    VkSampler sampler;
+    // Every mip level of every layer, see TextureArrayData. Released after the last upload.
+    Buffer staging;
+    u64 level_offsets[TEXTURE_MAX_MIP_LEVELS];
+    // Finest level holding valid data. Equals the mip level count until the first upload.
+    u32 resident_mip;
+} TextureArray;
+
 typedef struct Swapchain {
     VkSurfaceFormatKHR format;
     u8 max_frames_in_flight;
@@ -91,9 +150,41 @@ typedef struct Swapchain {
     VkImage* images;
     VkImageView* views;
     u32 image_count;
+    VkExtent2D extent;
+    // Offscreen target the scene is rendered into, at up to the swapchain extent. It is
+    // upscaled onto the presented image, so the scene resolution can change every frame.
+    Image color_image;
     Image depth_image;
+    // Filter used for that upscale; linear unless the format can't be linearly filtered.
+    VkFilter blit_filter;
 } Swapchain;
 
+typedef enum DeferredResourceType {
+    DEFERRED_RESOURCE_BUFFER,
+    DEFERRED_RESOURCE_IMAGE,
+    DEFERRED_RESOURCE_IMAGE_VIEW,
+    DEFERRED_RESOURCE_PIPELINE,
+    DEFERRED_RESOURCE_DESCRIPTOR_POOL,
+} DeferredResourceType;
+
+typedef struct DeferredDeletion {
+    DeferredResourceType type;
+    // Graphics timeline value of the last submit that may reference the resource.
+    u64 value;
+    union {
+        Buffer buffer;
+        Image image;
+        VkImageView view;
+        Pipeline pipeline;
+        VkDescriptorPool descriptor_pool;
+    } resource;
+} DeferredDeletion;
+
+typedef struct DeletionQueue {
+    // Ordered by value, since entries are always pushed for the submit being recorded.
+    Vector(DeferredDeletion) entries;
+} DeletionQueue;
+
 typedef struct SwapchainSupport {
     VkSurfaceCapabilitiesKHR capabilities;
     u32 format_count;
@@ -118,14 +209,93 @@ typedef struct Device {
     VkQueue graphics_queue;
     VkQueue present_queue;
     VkQueue transfer_queue;
+    VkQueue compute_queue;
 
     VkPhysicalDeviceProperties properties;
     VkPhysicalDeviceFeatures features;
     VkPhysicalDeviceMemoryProperties memory_properties;
     VkFormat depth_format;
     VkCommandPool graphics_command_pool;
+    VkCommandPool transfer_command_pool;
+    VkCommandPool compute_command_pool;
 } Device;
 
+typedef enum TimelineQueue {
+    TIMELINE_QUEUE_GRAPHICS,
+    TIMELINE_QUEUE_TRANSFER,
+    TIMELINE_QUEUE_COMPUTE,
+    TIMELINE_QUEUE_COUNT,
+} TimelineQueue;
+
+// A queue paired with a timeline semaphore. Every submit signals the next value.
+typedef struct Timeline {
+    VkSemaphore semaphore;
+    VkQueue queue;
+    // Value signaled by the most recent submit.
+    u64 value;
+} Timeline;
+
+// A semaphore a submit waits on. The value is ignored for binary semaphores.
+typedef struct TimelineWait {
+    VkSemaphore semaphore;
+    u64 value;
+    VkPipelineStageFlags stage;
+} TimelineWait;
+
+// Instances per frame in flight, 2MB of InstanceData each.
+#define INSTANCE_BUFFER_CAPACITY 65536
+
+// One instanced draw: `instance_count` instances of `mesh` starting at `first_instance`.
+typedef struct InstanceBatch {
+    MeshRange mesh;
+    u32 first_instance;
+    u32 instance_count;
+} InstanceBatch;
+
+// Per-frame instance data written straight into persistently mapped host-visible buffers.
+typedef struct Instancing {
+    // One buffer per frame in flight, so the CPU never writes one the GPU is reading.
+    Buffer* buffers;
+    InstanceData** mapped;
+    u32 buffer_count;
+    u32 frame;
+    u32 instance_count;
+    Vector(InstanceBatch) batches;
+} Instancing;
+
+// A pair of timestamps per command buffer, measuring how long the GPU spent on a frame.
+typedef struct GpuTimer {
+    // Null when the graphics queue can't write timestamps.
+    VkQueryPool pool;
+    u32 slot_count;
+    // Per slot, set while its timestamps are recorded but not read back yet.
+    bool* pending;
+    // Nanoseconds per timestamp tick.
+    f32 period;
+    // Most recent measurement, and whether it has been consumed.
+    f32 frame_ms;
+    bool has_sample;
+} GpuTimer;
+
+// Buffer copies recorded on the transfer queue. The next graphics submit waits for them, so
+// uploads never block the CPU on a queue going idle.
+typedef struct Uploads {
+    CommandBuffer command_buffer;
+    bool recording;
+    // Staging buffers read by the recorded copies.
+    Vector(Buffer) staging;
+    // Queue family ownership acquires the graphics queue records before the data is read.
+    // Empty when transfer and graphics share a family.
+    Vector(VkBufferMemoryBarrier) acquires;
+    // Transfer timeline value of the last submit; its command buffer is freed once reached.
+    u64 submitted_value;
+    // Transfer timeline value whose acquires the graphics queue hasn't recorded yet, or 0.
+    u64 pending_value;
+    // Transfer timeline value acquired by the graphics command buffer being recorded, which
+    // its submit has to wait on, or 0.
+    u64 acquired_value;
+} Uploads;
+
 typedef struct VulkanBackend {
     VkInstance instance;
     VkSurfaceKHR surface;
@@ -133,25 +303,41 @@ typedef struct VulkanBackend {
     Device device;
     Swapchain swapchain;
     RenderPass main_pass;
+    // Same attachments as the main pass but loads them; used after the Hi-Z late cull.
+    RenderPass main_pass_load;
 
     Vector(CommandBuffer) graphics_command_buffers;
-    Vector(VkFramebuffer) framebuffers;
+    // Scene color and depth; both are shared by every frame in flight.
+    VkFramebuffer framebuffer;
 
     Vector(VkSemaphore) image_available_semaphores;
     Vector(VkSemaphore) queue_complete_semaphores;
-    Vector(VkFence) in_flight_fences;
-    VkFence** images_in_flight;
+    Timeline timelines[TIMELINE_QUEUE_COUNT];
+    // Graphics timeline value of the submit that used each frame slot and swapchain image.
+    Vector(u64) in_flight_values;
+    u64* images_in_flight;
+    DeletionQueue deletion_queue;
     Shader basic_shader;
+    HiZ hiz;
+    TextureArray block_textures;
+    GpuTimer gpu_timer;
+    Instancing instancing;
+    Uploads uploads;
 
     Buffer vertex_buffer;
     Buffer index_buffer;
 
-    u32 in_flight_fence_count;
-
     u32 framebuffer_width;
     u32 framebuffer_height;
+    // Fraction of the framebuffer the scene is rendered at, per axis, and the resulting
+    // region of the scene target.
+    f32 render_scale;
+    u32 scene_width;
+    u32 scene_height;
     bool recreating_swapchain;
     bool swapchain_needs_resize;
+    // Requested presentation policy, applied when the swapchain is (re)created.
+    PresentMode present_mode;
 
 #ifdef _DEBUG
     VkDebugUtilsMessengerEXT debugger;
@@ -0,0 +1,144 @@
+#include "vulkan_upload.h"
+#include "vulkan_buffer.h"
+#include "vulkan_command_buffer.h"
+#include "vulkan_timeline.h"
+
+// Uploaded data is only read as vertex input, so that is the stage the graphics queue waits at.
+#define UPLOAD_DST_STAGE VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+#define UPLOAD_DST_ACCESS (VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT)
+
+void vulkan_upload_create(Uploads* uploads) {
+    uploads->command_buffer.handle = VK_NULL_HANDLE;
+    uploads->recording = false;
+    uploads->staging = vector_new(Buffer);
+    uploads->acquires = vector_new(VkBufferMemoryBarrier);
+    uploads->submitted_value = 0;
+    uploads->pending_value = 0;
+    uploads->acquired_value = 0;
+}
+
+static void release_batch(VulkanBackend* backend, Uploads* uploads) {
+    vulkan_command_buffer_free(backend, backend->device.transfer_command_pool,
+                               &uploads->command_buffer);
+    for (u32 i = 0; i < vector_length(uploads->staging); i++) {
+        vulkan_buffer_destroy(backend, &uploads->staging[i]);
+    }
+    vector_clear(uploads->staging);
+    uploads->submitted_value = 0;
+}
+
+void vulkan_upload_buffer(VulkanBackend* backend, Uploads* uploads, Buffer* dst, u64 offset,
+                          u64 size, const void* data) {
+    if (!uploads->recording) {
+        // Only one batch is in flight at a time. Uploads are rare enough that waiting for the
+        // previous one is simpler than tracking several.
+        if (uploads->submitted_value != 0) {
+            vulkan_timeline_wait(backend, &backend->timelines[TIMELINE_QUEUE_TRANSFER],
+                                 uploads->submitted_value, UINT64_MAX);
+            release_batch(backend, uploads);
+        }
+        vulkan_command_buffer_allocate_and_begin_single_use(
+            backend, backend->device.transfer_command_pool, &uploads->command_buffer);
+        uploads->recording = true;
+    }
+
+    Buffer staging;
+    vulkan_buffer_create(backend, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         size, true, &staging);
+    vulkan_buffer_write(backend, &staging, 0, size, 0, (void*)data);
+    vector_push(uploads->staging, staging);
+
+    VkBufferCopy copy = {0};
+    copy.srcOffset = 0;
+    copy.dstOffset = offset;
+    copy.size = size;
+    vkCmdCopyBuffer(uploads->command_buffer.handle, staging.handle, dst->handle, 1, &copy);
+
+    // Within one family the timeline semaphore alone makes the copy visible to the graphics
+    // queue. Across families the exclusive buffer is released here and acquired there.
+    u32 transfer_family = backend->device.queue_family_indices.transfer_family;
+    u32 graphics_family = backend->device.queue_family_indices.graphics_family;
+    if (transfer_family == graphics_family) {
+        return;
+    }
+    VkBufferMemoryBarrier barrier = {0};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = transfer_family;
+    barrier.dstQueueFamilyIndex = graphics_family;
+    barrier.buffer = dst->handle;
+    barrier.offset = offset;
+    barrier.size = size;
+    vkCmdPipelineBarrier(uploads->command_buffer.handle, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, 0, 1, &barrier, 0, 0);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = UPLOAD_DST_ACCESS;
+    vector_push(uploads->acquires, barrier);
+}
+
+bool vulkan_upload_submit(VulkanBackend* backend, Uploads* uploads) {
+    if (!uploads->recording) {
+        return true;
+    }
+    vulkan_command_buffer_end(&uploads->command_buffer);
+    u64 value = 0;
+    if (!vulkan_timeline_submit(backend, &backend->timelines[TIMELINE_QUEUE_TRANSFER], 1,
+                                &uploads->command_buffer.handle, 0, 0, VK_NULL_HANDLE, &value)) {
+        return false;
+    }
+    vulkan_command_buffer_set_submitted(&uploads->command_buffer);
+    uploads->recording = false;
+    uploads->submitted_value = value;
+    uploads->pending_value = value;
+    return true;
+}
+
+void vulkan_upload_collect(VulkanBackend* backend, Uploads* uploads) {
+    if (uploads->submitted_value == 0) {
+        return;
+    }
+    Timeline* transfer = &backend->timelines[TIMELINE_QUEUE_TRANSFER];
+    if (vulkan_timeline_completed(backend, transfer) >= uploads->submitted_value) {
+        release_batch(backend, uploads);
+    }
+}
+
+void vulkan_upload_acquire(VulkanBackend* backend, Uploads* uploads,
+                           CommandBuffer* command_buffer) {
+    if (uploads->pending_value == 0) {
+        return;
+    }
+    u32 count = vector_length(uploads->acquires);
+    if (count > 0) {
+        // The source stage matches the semaphore wait stage, which chains the two.
+        vkCmdPipelineBarrier(command_buffer->handle, UPLOAD_DST_STAGE, UPLOAD_DST_STAGE, 0, 0, 0,
+                             count, uploads->acquires, 0, 0);
+        vector_clear(uploads->acquires);
+    }
+    uploads->acquired_value = uploads->pending_value;
+    uploads->pending_value = 0;
+}
+
+bool vulkan_upload_wait(VulkanBackend* backend, Uploads* uploads, TimelineWait* wait) {
+    if (uploads->acquired_value == 0) {
+        return false;
+    }
+    *wait = vulkan_timeline_wait_for(&backend->timelines[TIMELINE_QUEUE_TRANSFER],
+                                     uploads->acquired_value, UPLOAD_DST_STAGE);
+    uploads->acquired_value = 0;
+    return true;
+}
+
+void vulkan_upload_destroy(VulkanBackend* backend, Uploads* uploads) {
+    if (uploads->command_buffer.handle) {
+        release_batch(backend, uploads);
+    }
+    vector_free(uploads->staging);
+    vector_free(uploads->acquires);
+    uploads->recording = false;
+    uploads->pending_value = 0;
+    uploads->acquired_value = 0;
+}
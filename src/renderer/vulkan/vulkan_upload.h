@@ -0,0 +1,43 @@
+#ifndef VULKAN_UPLOAD_H
+#define VULKAN_UPLOAD_H
+
+#include "vulkan_types.h"
+
+void vulkan_upload_create(Uploads* uploads);
+
+/**
+ * Records a copy of `data` into `dst` on the transfer queue. Copies are batched until
+ * `vulkan_upload_submit`. The destination must be a vertex or index buffer, since that is the
+ * access the graphics queue acquires it for.
+ */
+void vulkan_upload_buffer(VulkanBackend* backend, Uploads* uploads, Buffer* dst, u64 offset,
+                          u64 size, const void* data);
+
+/**
+ * Submits the recorded copies to the transfer timeline without waiting for them.
+ */
+bool vulkan_upload_submit(VulkanBackend* backend, Uploads* uploads);
+
+/**
+ * Frees the last batch once the transfer timeline has reached it.
+ */
+void vulkan_upload_collect(VulkanBackend* backend, Uploads* uploads);
+
+/**
+ * Records the queue family ownership acquires of the submitted uploads at the start of a
+ * graphics command buffer. Its submit must then wait on `vulkan_upload_wait`.
+ */
+void vulkan_upload_acquire(VulkanBackend* backend, Uploads* uploads,
+                           CommandBuffer* command_buffer);
+
+/**
+ * Returns true and fills `wait` when the graphics submit has to wait for uploads it acquired.
+ */
+bool vulkan_upload_wait(VulkanBackend* backend, Uploads* uploads, TimelineWait* wait);
+
+/**
+ * The device must be idle.
+ */
+void vulkan_upload_destroy(VulkanBackend* backend, Uploads* uploads);
+
+#endif
@@ -2,6 +2,7 @@
 #include "core/event.h"
 #include "core/input.h"
 #include "core/log.h"
+#include "core/profiler.h"
 #include "defines.h"
 
 static void key_callback(Window* window, int key, int scancode, int action, int mods);
@@ -96,7 +97,10 @@ static void window_close_callback(Window* window) {
 }
 
 bool window_should_close(Window* window) { return glfwWindowShouldClose(window); }
-void window_poll_events(void) { glfwPollEvents(); }
+void window_poll_events(void) {
+    PROFILE_SCOPE("window_poll_events");
+    glfwPollEvents();
+}
 
 void window_destroy(Window* window) {
     glfwDestroyWindow(window);
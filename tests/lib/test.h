@@ -17,13 +17,15 @@ typedef enum TestResult {
 
 #define EXPECT_EQ(left, right)                                                                     \
     if (left != right) {                                                                           \
-        ERROR("assertion `left == right` failed.\n left: %d\nright: %d", left, right);             \
+        ERROR("assertion `left == right` failed.\n left: %lld\nright: %lld", (long long)(left),    \
+              (long long)(right));                                                                 \
         return FAIL;                                                                               \
     }
 
 #define EXPECT_NEQ(left, right)                                                                    \
     if (left == right) {                                                                           \
-        ERROR("assertion `left != right` failed.\n \"left\": %d\n\"right\": %d", left, right);     \
+        ERROR("assertion `left != right` failed.\n \"left\": %lld\n\"right\": %lld",              \
+              (long long)(left), (long long)(right));                                              \
         return FAIL;                                                                               \
     }
 #define EXPECT_FLOAT_EQ(left, right)                                                               \
@@ -0,0 +1,205 @@
+#include <collections/hashmap.h>
+#include <collections/hashmap_bench.h>
+#include <core/mem.h>
+#include <platform/platform.h>
+#include <string.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define BENCH_KEY_COUNT (1 << 20)
+
+/**
+ * Separate chaining with a node allocation per entry, the usual first hash table. Used as the
+ * baseline the open addressing map is measured against.
+ */
+typedef struct ChainedNode {
+    u64 key;
+    u64 value;
+    struct ChainedNode* next;
+} ChainedNode;
+
+typedef struct ChainedMap {
+    ChainedNode** buckets;
+    u64 bucket_count;
+    u64 length;
+} ChainedMap;
+
+static void chained_create(ChainedMap* map) {
+    map->bucket_count = 16;
+    map->length = 0;
+    map->buckets = mem_alloc(sizeof(ChainedNode*) * map->bucket_count);
+    memset(map->buckets, 0, sizeof(ChainedNode*) * map->bucket_count);
+}
+
+static void chained_grow(ChainedMap* map) {
+    u64 bucket_count = map->bucket_count * 2;
+    ChainedNode** buckets = mem_alloc(sizeof(ChainedNode*) * bucket_count);
+    memset(buckets, 0, sizeof(ChainedNode*) * bucket_count);
+    for (u64 i = 0; i < map->bucket_count; i++) {
+        ChainedNode* node = map->buckets[i];
+        while (node) {
+            ChainedNode* next = node->next;
+            u64 bucket = hash_bytes(&node->key, sizeof(u64)) & (bucket_count - 1);
+            node->next = buckets[bucket];
+            buckets[bucket] = node;
+            node = next;
+        }
+    }
+    mem_free(map->buckets);
+    map->buckets = buckets;
+    map->bucket_count = bucket_count;
+}
+
+static void chained_insert(ChainedMap* map, u64 key, u64 value) {
+    ChainedNode** bucket = &map->buckets[hash_bytes(&key, sizeof(u64)) & (map->bucket_count - 1)];
+    for (ChainedNode* node = *bucket; node; node = node->next) {
+        if (node->key == key) {
+            node->value = value;
+            return;
+        }
+    }
+    ChainedNode* node = mem_alloc(sizeof(ChainedNode));
+    node->key = key;
+    node->value = value;
+    node->next = *bucket;
+    *bucket = node;
+    if (++map->length > map->bucket_count) {
+        chained_grow(map);
+    }
+}
+
+static u64* chained_get(const ChainedMap* map, u64 key) {
+    ChainedNode* node = map->buckets[hash_bytes(&key, sizeof(u64)) & (map->bucket_count - 1)];
+    for (; node; node = node->next) {
+        if (node->key == key) {
+            return &node->value;
+        }
+    }
+    return 0;
+}
+
+static bool chained_remove(ChainedMap* map, u64 key) {
+    ChainedNode** link = &map->buckets[hash_bytes(&key, sizeof(u64)) & (map->bucket_count - 1)];
+    for (; *link; link = &(*link)->next) {
+        if ((*link)->key == key) {
+            ChainedNode* node = *link;
+            *link = node->next;
+            mem_free(node);
+            map->length--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void chained_destroy(ChainedMap* map) {
+    for (u64 i = 0; i < map->bucket_count; i++) {
+        ChainedNode* node = map->buckets[i];
+        while (node) {
+            ChainedNode* next = node->next;
+            mem_free(node);
+            node = next;
+        }
+    }
+    mem_free(map->buckets);
+}
+
+// Spread out keys, so neither table benefits from sequential ones.
+static u64 bench_key(u64 i) {
+    return (i + 1) * 0x9E3779B97F4A7C15ull;
+}
+
+// Lookups and erases visit the keys in a different order than they were inserted in, or the
+// chained nodes would be read back in allocation order. An odd multiplier permutes the range.
+static u64 shuffled(u64 i) {
+    return (i * 0x2545F491ull) & (BENCH_KEY_COUNT - 1);
+}
+
+static f64 million_per_second(f64 seconds) {
+    return seconds > 0.0 ? (f64)BENCH_KEY_COUNT / seconds / 1e6 : 0.0;
+}
+
+typedef struct BenchTimes {
+    f64 insert;
+    f64 hit;
+    f64 miss;
+    f64 erase;
+} BenchTimes;
+
+static void log_times(const char* name, const BenchTimes* times) {
+    INFO("%-8s %d keys: insert %6.1f M/s, hit %6.1f M/s, miss %6.1f M/s, erase %6.1f M/s", name,
+         BENCH_KEY_COUNT, million_per_second(times->insert), million_per_second(times->hit),
+         million_per_second(times->miss), million_per_second(times->erase));
+}
+
+Test hashmap_bench(void) {
+    BenchTimes swiss = {0};
+    BenchTimes chained = {0};
+    u64 found = 0;
+
+    HashMap map;
+    if (!hashmap_create_typed(u64, u64, 0, &map)) {
+        return FAIL;
+    }
+    f64 start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        u64 key = bench_key(i);
+        hashmap_insert(&map, &key, &i);
+    }
+    swiss.insert = platform_system_time() - start;
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        u64 key = bench_key(shuffled(i));
+        found += hashmap_get(&map, &key) != 0;
+    }
+    swiss.hit = platform_system_time() - start;
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        u64 key = bench_key(shuffled(i) + BENCH_KEY_COUNT);
+        found += hashmap_get(&map, &key) != 0;
+    }
+    swiss.miss = platform_system_time() - start;
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        u64 key = bench_key(shuffled(i));
+        hashmap_remove(&map, &key, 0);
+    }
+    swiss.erase = platform_system_time() - start;
+    EXPECT_EQ(map.length, 0);
+    hashmap_destroy(&map);
+
+    ChainedMap baseline;
+    chained_create(&baseline);
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        chained_insert(&baseline, bench_key(i), i);
+    }
+    chained.insert = platform_system_time() - start;
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        found += chained_get(&baseline, bench_key(shuffled(i))) != 0;
+    }
+    chained.hit = platform_system_time() - start;
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        found += chained_get(&baseline, bench_key(shuffled(i) + BENCH_KEY_COUNT)) != 0;
+    }
+    chained.miss = platform_system_time() - start;
+    start = platform_system_time();
+    for (u64 i = 0; i < BENCH_KEY_COUNT; i++) {
+        chained_remove(&baseline, bench_key(shuffled(i)));
+    }
+    chained.erase = platform_system_time() - start;
+    EXPECT_EQ(baseline.length, 0);
+    chained_destroy(&baseline);
+
+    log_times("hashmap", &swiss);
+    log_times("chained", &chained);
+    // Every hit was found by both tables and no miss was.
+    EXPECT_EQ(found, 2 * BENCH_KEY_COUNT);
+    return OK;
+}
+
+void register_hashmap_benchmarks(void) {
+    test_runner_register(hashmap_bench, "Benchmark: hash map against separate chaining");
+}
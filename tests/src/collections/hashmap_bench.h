@@ -0,0 +1,6 @@
+#ifndef HASHMAP_BENCH_H
+#define HASHMAP_BENCH_H
+
+void register_hashmap_benchmarks(void);
+
+#endif
@@ -0,0 +1,175 @@
+#include <collections/hashmap.h>
+#include <collections/hashmap_tests.h>
+#include <core/arena.h>
+#include <test.h>
+#include <test_runner.h>
+
+typedef struct ChunkCoord {
+    i32 x;
+    i32 y;
+    i32 z;
+} ChunkCoord;
+
+// Sends every key to the same group, so lookups depend entirely on the key comparison.
+static u64 colliding_hash(const void* key, u64 key_size) {
+    (void)key;
+    (void)key_size;
+    return 0;
+}
+
+Test hashmap_insert_get_test(void) {
+    HashMap map;
+    if (!hashmap_create_typed(u64, u32, 0, &map)) {
+        return FAIL;
+    }
+    u64 key = 42;
+    u32 value = 7;
+    hashmap_insert(&map, &key, &value);
+    EXPECT_EQ(map.length, 1);
+    EXPECT_EQ(*hashmap_get_typed(&map, u32, &key), 7);
+
+    // Inserting an existing key replaces its value.
+    value = 9;
+    hashmap_insert(&map, &key, &value);
+    EXPECT_EQ(map.length, 1);
+    EXPECT_EQ(*hashmap_get_typed(&map, u32, &key), 9);
+
+    u64 missing = 43;
+    EXPECT_EQ(hashmap_get(&map, &missing), 0);
+    hashmap_destroy(&map);
+    return OK;
+}
+
+Test hashmap_growth_test(void) {
+    HashMap map;
+    if (!hashmap_create(sizeof(ChunkCoord), sizeof(u64), 0, 0, 0, &map)) {
+        return FAIL;
+    }
+    for (i32 i = 0; i < 20000; i++) {
+        ChunkCoord coord = {i, -i, i * 3};
+        u64 value = (u64)i;
+        hashmap_insert(&map, &coord, &value);
+    }
+    EXPECT_EQ(map.length, 20000);
+    EXPECT_EQ((map.length <= map.capacity / 8 * HASHMAP_MAX_LOAD_EIGHTHS), true);
+    for (i32 i = 0; i < 20000; i++) {
+        ChunkCoord coord = {i, -i, i * 3};
+        u64* value = hashmap_get_typed(&map, u64, &coord);
+        EXPECT_NEQ(value, 0);
+        EXPECT_EQ(*value, (u64)i);
+    }
+    ChunkCoord missing = {1, 1, 1};
+    EXPECT_EQ(hashmap_get(&map, &missing), 0);
+    hashmap_destroy(&map);
+    return OK;
+}
+
+Test hashmap_remove_test(void) {
+    HashMap map;
+    if (!hashmap_create_typed(u32, u32, 64, &map)) {
+        return FAIL;
+    }
+    u64 capacity = map.capacity;
+    // Churning through many more keys than fit leaves tombstones that must be reclaimed
+    // without growing the table.
+    for (u32 round = 0; round < 100; round++) {
+        for (u32 i = 0; i < 32; i++) {
+            u32 key = round * 32 + i;
+            hashmap_insert(&map, &key, &i);
+        }
+        for (u32 i = 0; i < 32; i++) {
+            u32 key = round * 32 + i;
+            u32 value;
+            EXPECT_EQ(hashmap_remove(&map, &key, &value), true);
+            EXPECT_EQ(value, i);
+            EXPECT_EQ(hashmap_remove(&map, &key, 0), false);
+        }
+    }
+    EXPECT_EQ(map.length, 0);
+    EXPECT_EQ(map.capacity, capacity);
+    hashmap_destroy(&map);
+    return OK;
+}
+
+Test hashmap_collision_test(void) {
+    HashMap map;
+    if (!hashmap_create(sizeof(u32), sizeof(u32), 0, colliding_hash, 0, &map)) {
+        return FAIL;
+    }
+    for (u32 i = 0; i < 100; i++) {
+        u32 value = i * 2;
+        hashmap_insert(&map, &i, &value);
+    }
+    u32 removed = 50;
+    hashmap_remove(&map, &removed, 0);
+    for (u32 i = 0; i < 100; i++) {
+        u32* value = hashmap_get_typed(&map, u32, &i);
+        if (i == removed) {
+            EXPECT_EQ(value, 0);
+        } else {
+            EXPECT_NEQ(value, 0);
+            EXPECT_EQ(*value, i * 2);
+        }
+    }
+    hashmap_destroy(&map);
+    return OK;
+}
+
+Test hashmap_iteration_test(void) {
+    HashMap map;
+    if (!hashmap_create_typed(u64, u64, 0, &map)) {
+        return FAIL;
+    }
+    u64 expected = 0;
+    for (u64 i = 1; i <= 100; i++) {
+        hashmap_insert(&map, &i, &i);
+        expected += i;
+    }
+    u64 cursor = 0;
+    u64 sum = 0;
+    u64 count = 0;
+    void* key;
+    void* value;
+    while (hashmap_next(&map, &cursor, &key, &value)) {
+        EXPECT_EQ(*(u64*)key, *(u64*)value);
+        sum += *(u64*)value;
+        count++;
+    }
+    EXPECT_EQ(count, 100);
+    EXPECT_EQ(sum, expected);
+    hashmap_clear(&map);
+    cursor = 0;
+    EXPECT_EQ(hashmap_next(&map, &cursor, &key, &value), false);
+    hashmap_destroy(&map);
+    return OK;
+}
+
+Test hashmap_arena_test(void) {
+    Arena arena;
+    if (!arena_create(4 * 1024 * 1024, &arena)) {
+        return FAIL;
+    }
+    Allocator allocator = arena_allocator(&arena);
+    HashMap map;
+    if (!hashmap_create(sizeof(u64), sizeof(u64), 0, 0, &allocator, &map)) {
+        return FAIL;
+    }
+    for (u64 i = 0; i < 1000; i++) {
+        hashmap_insert(&map, &i, 0);
+    }
+    u64 key = 999;
+    EXPECT_EQ(*hashmap_get_typed(&map, u64, &key), 0);
+    EXPECT_EQ((map.slots >= arena.base && map.slots < arena.base + arena.offset), true);
+    hashmap_destroy(&map);
+    arena_destroy(&arena);
+    return OK;
+}
+
+void register_hashmap_tests(void) {
+    test_runner_register(hashmap_insert_get_test, "Hash map inserts and replaces values");
+    test_runner_register(hashmap_growth_test, "Hash map grows and keeps every entry");
+    test_runner_register(hashmap_remove_test, "Hash map reclaims removed slots");
+    test_runner_register(hashmap_collision_test, "Hash map handles full collisions");
+    test_runner_register(hashmap_iteration_test, "Hash map iterates over every entry");
+    test_runner_register(hashmap_arena_test, "Hash map allocates from an arena");
+}
@@ -0,0 +1,6 @@
+#ifndef HASHMAP_TESTS_H
+#define HASHMAP_TESTS_H
+
+void register_hashmap_tests(void);
+
+#endif
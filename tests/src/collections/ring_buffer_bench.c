@@ -0,0 +1,112 @@
+#include <collections/ring_buffer.h>
+#include <collections/ring_buffer_bench.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define BENCH_RING_COUNT (1 << 21)
+#define BENCH_RING_CAPACITY 1024
+#define BENCH_MPMC_THREADS 2
+
+typedef struct RingBench {
+    SpscRing* spsc;
+    MpmcRing* mpmc;
+    u64 count;
+    u64 checksum;
+} RingBench;
+
+static void spsc_bench_producer(void* arg) {
+    RingBench* bench = arg;
+    for (u64 i = 0; i < bench->count; i++) {
+        while (!spsc_ring_push(bench->spsc, &i)) {
+            platform_thread_yield();
+        }
+    }
+}
+
+static void mpmc_bench_producer(void* arg) {
+    RingBench* bench = arg;
+    for (u64 i = 0; i < bench->count; i++) {
+        while (!mpmc_ring_push(bench->mpmc, &i)) {
+            platform_thread_yield();
+        }
+    }
+}
+
+static void mpmc_bench_consumer(void* arg) {
+    RingBench* bench = arg;
+    for (u64 i = 0; i < bench->count; i++) {
+        u64 value;
+        while (!mpmc_ring_pop(bench->mpmc, &value)) {
+            platform_thread_yield();
+        }
+        bench->checksum += value;
+    }
+}
+
+Test spsc_ring_bench(void) {
+    SpscRing ring;
+    if (!spsc_ring_create_typed(u64, BENCH_RING_CAPACITY, &ring)) {
+        return FAIL;
+    }
+    RingBench bench = {0};
+    bench.spsc = &ring;
+    bench.count = BENCH_RING_COUNT;
+    f64 start = platform_system_time();
+    Thread producer;
+    if (!platform_thread_create(spsc_bench_producer, &bench, &producer)) {
+        return FAIL;
+    }
+    u64 checksum = 0;
+    for (u64 i = 0; i < BENCH_RING_COUNT; i++) {
+        u64 value;
+        while (!spsc_ring_pop(&ring, &value)) {
+            platform_thread_yield();
+        }
+        checksum += value;
+    }
+    platform_thread_join(&producer);
+    f64 seconds = platform_system_time() - start;
+    INFO("SPSC ring, 1 producer 1 consumer: %.1f M values/s",
+         (f64)BENCH_RING_COUNT / seconds / 1e6);
+    EXPECT_EQ(checksum, (u64)BENCH_RING_COUNT * (BENCH_RING_COUNT - 1) / 2);
+    spsc_ring_destroy(&ring);
+    return OK;
+}
+
+Test mpmc_ring_bench(void) {
+    MpmcRing ring;
+    if (!mpmc_ring_create_typed(u64, BENCH_RING_CAPACITY, &ring)) {
+        return FAIL;
+    }
+    RingBench benches[BENCH_MPMC_THREADS * 2] = {0};
+    Thread threads[BENCH_MPMC_THREADS * 2];
+    f64 start = platform_system_time();
+    for (u32 i = 0; i < BENCH_MPMC_THREADS * 2; i++) {
+        benches[i].mpmc = &ring;
+        benches[i].count = BENCH_RING_COUNT / BENCH_MPMC_THREADS;
+        ThreadFn fn = i < BENCH_MPMC_THREADS ? mpmc_bench_producer : mpmc_bench_consumer;
+        if (!platform_thread_create(fn, &benches[i], &threads[i])) {
+            return FAIL;
+        }
+    }
+    for (u32 i = 0; i < BENCH_MPMC_THREADS * 2; i++) {
+        platform_thread_join(&threads[i]);
+    }
+    f64 seconds = platform_system_time() - start;
+    INFO("MPMC ring, %d producers %d consumers: %.1f M values/s", BENCH_MPMC_THREADS,
+         BENCH_MPMC_THREADS, (f64)BENCH_RING_COUNT / seconds / 1e6);
+    u64 per_producer = BENCH_RING_COUNT / BENCH_MPMC_THREADS;
+    u64 checksum = 0;
+    for (u32 i = BENCH_MPMC_THREADS; i < BENCH_MPMC_THREADS * 2; i++) {
+        checksum += benches[i].checksum;
+    }
+    EXPECT_EQ(checksum, BENCH_MPMC_THREADS * (per_producer * (per_producer - 1) / 2));
+    mpmc_ring_destroy(&ring);
+    return OK;
+}
+
+void register_ring_buffer_benchmarks(void) {
+    test_runner_register(spsc_ring_bench, "Benchmark: SPSC ring throughput");
+    test_runner_register(mpmc_ring_bench, "Benchmark: MPMC ring throughput");
+}
@@ -0,0 +1,6 @@
+#ifndef RING_BUFFER_BENCH_H
+#define RING_BUFFER_BENCH_H
+
+void register_ring_buffer_benchmarks(void);
+
+#endif
@@ -0,0 +1,181 @@
+#include <collections/ring_buffer.h>
+#include <collections/ring_buffer_tests.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define RING_STRESS_COUNT 200000
+#define RING_STRESS_THREADS 4
+
+typedef struct RingStress {
+    SpscRing* spsc;
+    MpmcRing* mpmc;
+    u64 first;
+    u64 count;
+    // Filled in by consumers.
+    u64 sum;
+    u64 received;
+    _Atomic(u32)* done;
+} RingStress;
+
+Test spsc_ring_fifo_test(void) {
+    SpscRing ring;
+    if (!spsc_ring_create_typed(u32, 3, &ring)) {
+        return FAIL;
+    }
+    // The capacity is rounded up to four slots.
+    for (u32 i = 0; i < 4; i++) {
+        EXPECT_EQ(spsc_ring_push(&ring, &i), true);
+    }
+    u32 value = 99;
+    EXPECT_EQ(spsc_ring_push(&ring, &value), false);
+    for (u32 round = 0; round < 10; round++) {
+        EXPECT_EQ(spsc_ring_pop(&ring, &value), true);
+        EXPECT_EQ(value, round);
+        u32 next = round + 4;
+        EXPECT_EQ(spsc_ring_push(&ring, &next), true);
+    }
+    for (u32 i = 0; i < 4; i++) {
+        EXPECT_EQ(spsc_ring_pop(&ring, &value), true);
+    }
+    EXPECT_EQ(spsc_ring_pop(&ring, &value), false);
+    spsc_ring_destroy(&ring);
+    return OK;
+}
+
+static void spsc_producer(void* arg) {
+    RingStress* stress = arg;
+    for (u64 i = 0; i < stress->count; i++) {
+        while (!spsc_ring_push(stress->spsc, &i)) {
+            platform_thread_yield();
+        }
+    }
+}
+
+Test spsc_ring_stress_test(void) {
+    SpscRing ring;
+    if (!spsc_ring_create_typed(u64, 256, &ring)) {
+        return FAIL;
+    }
+    RingStress stress = {0};
+    stress.spsc = &ring;
+    stress.count = RING_STRESS_COUNT;
+    Thread producer;
+    if (!platform_thread_create(spsc_producer, &stress, &producer)) {
+        return FAIL;
+    }
+    // Values must arrive exactly once and in order.
+    u64 expected = 0;
+    bool ordered = true;
+    while (expected < RING_STRESS_COUNT) {
+        u64 value;
+        if (spsc_ring_pop(&ring, &value)) {
+            ordered = ordered && value == expected;
+            expected++;
+        } else {
+            platform_thread_yield();
+        }
+    }
+    platform_thread_join(&producer);
+    EXPECT_EQ(ordered, true);
+    u64 value;
+    EXPECT_EQ(spsc_ring_pop(&ring, &value), false);
+    spsc_ring_destroy(&ring);
+    return OK;
+}
+
+Test mpmc_ring_fifo_test(void) {
+    MpmcRing ring;
+    if (!mpmc_ring_create_typed(u64, 8, &ring)) {
+        return FAIL;
+    }
+    for (u64 i = 0; i < 8; i++) {
+        EXPECT_EQ(mpmc_ring_push(&ring, &i), true);
+    }
+    u64 value = 99;
+    EXPECT_EQ(mpmc_ring_push(&ring, &value), false);
+    for (u64 i = 0; i < 8; i++) {
+        EXPECT_EQ(mpmc_ring_pop(&ring, &value), true);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(mpmc_ring_pop(&ring, &value), false);
+    mpmc_ring_destroy(&ring);
+    return OK;
+}
+
+static void mpmc_producer(void* arg) {
+    RingStress* stress = arg;
+    for (u64 i = stress->first; i < stress->first + stress->count; i++) {
+        while (!mpmc_ring_push(stress->mpmc, &i)) {
+            platform_thread_yield();
+        }
+    }
+    atomic_fetch_add(stress->done, 1);
+}
+
+static void mpmc_consumer(void* arg) {
+    RingStress* stress = arg;
+    for (;;) {
+        u64 value;
+        if (mpmc_ring_pop(stress->mpmc, &value)) {
+            stress->sum += value;
+            stress->received++;
+        } else if (atomic_load(stress->done) == RING_STRESS_THREADS) {
+            // Producers are finished, so an empty ring stays empty. One more pop catches
+            // a value pushed between the failed pop and the check.
+            if (!mpmc_ring_pop(stress->mpmc, &value)) {
+                return;
+            }
+            stress->sum += value;
+            stress->received++;
+        } else {
+            platform_thread_yield();
+        }
+    }
+}
+
+Test mpmc_ring_stress_test(void) {
+    MpmcRing ring;
+    if (!mpmc_ring_create_typed(u64, 64, &ring)) {
+        return FAIL;
+    }
+    _Atomic(u32) done = 0;
+    RingStress producers[RING_STRESS_THREADS] = {0};
+    RingStress consumers[RING_STRESS_THREADS] = {0};
+    Thread threads[RING_STRESS_THREADS * 2];
+    for (u32 i = 0; i < RING_STRESS_THREADS; i++) {
+        producers[i].mpmc = &ring;
+        producers[i].first = (u64)i * RING_STRESS_COUNT;
+        producers[i].count = RING_STRESS_COUNT;
+        producers[i].done = &done;
+        consumers[i].mpmc = &ring;
+        consumers[i].done = &done;
+        if (!platform_thread_create(mpmc_consumer, &consumers[i], &threads[i]) ||
+            !platform_thread_create(mpmc_producer, &producers[i],
+                                    &threads[RING_STRESS_THREADS + i])) {
+            return FAIL;
+        }
+    }
+    for (u32 i = 0; i < RING_STRESS_THREADS * 2; i++) {
+        platform_thread_join(&threads[i]);
+    }
+    // Every value was received exactly once: the count and the sum of 0..n-1 both match.
+    u64 total = (u64)RING_STRESS_THREADS * RING_STRESS_COUNT;
+    u64 received = 0;
+    u64 sum = 0;
+    for (u32 i = 0; i < RING_STRESS_THREADS; i++) {
+        received += consumers[i].received;
+        sum += consumers[i].sum;
+    }
+    EXPECT_EQ(received, total);
+    EXPECT_EQ(sum, total * (total - 1) / 2);
+    mpmc_ring_destroy(&ring);
+    return OK;
+}
+
+void register_ring_buffer_tests(void) {
+    test_runner_register(spsc_ring_fifo_test, "SPSC ring is FIFO and bounded");
+    test_runner_register(spsc_ring_stress_test, "SPSC ring delivers in order across threads");
+    test_runner_register(mpmc_ring_fifo_test, "MPMC ring is FIFO and bounded");
+    test_runner_register(mpmc_ring_stress_test, "MPMC ring delivers every value once");
+}
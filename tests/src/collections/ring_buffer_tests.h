@@ -0,0 +1,6 @@
+#ifndef RING_BUFFER_TESTS_H
+#define RING_BUFFER_TESTS_H
+
+void register_ring_buffer_tests(void);
+
+#endif
@@ -0,0 +1,144 @@
+#include <collections/slot_map.h>
+#include <collections/slot_map_tests.h>
+#include <core/arena.h>
+#include <test.h>
+#include <test_runner.h>
+
+typedef struct SlotMapTestObject {
+    u32 id;
+    f32 position[3];
+} SlotMapTestObject;
+
+Test slot_map_insert_get_test(void) {
+    SlotMap map;
+    if (!slot_map_create_typed(SlotMapTestObject, 0, &map)) {
+        return FAIL;
+    }
+    Handle handles[100];
+    for (u32 i = 0; i < 100; i++) {
+        SlotMapTestObject object = {i, {0}};
+        handles[i] = slot_map_insert(&map, &object);
+    }
+    EXPECT_EQ(slot_map_length(&map), 100);
+    for (u32 i = 0; i < 100; i++) {
+        SlotMapTestObject* object = slot_map_get_typed(&map, SlotMapTestObject, handles[i]);
+        EXPECT_NEQ(object, 0);
+        EXPECT_EQ(object->id, i);
+    }
+    Handle zero = {0};
+    EXPECT_EQ(slot_map_contains(&map, zero), false);
+    slot_map_destroy(&map);
+    return OK;
+}
+
+Test slot_map_stale_handle_test(void) {
+    SlotMap map;
+    if (!slot_map_create_typed(u32, 0, &map)) {
+        return FAIL;
+    }
+    u32 value = 1;
+    Handle first = slot_map_insert(&map, &value);
+    EXPECT_EQ(slot_map_remove(&map, first, 0), true);
+    EXPECT_EQ(slot_map_remove(&map, first, 0), false);
+
+    // The slot is reused, but the old handle must not see the new value.
+    value = 2;
+    Handle second = slot_map_insert(&map, &value);
+    EXPECT_EQ(second.index, first.index);
+    EXPECT_NEQ(second.generation, first.generation);
+    EXPECT_EQ(slot_map_get(&map, first), 0);
+    EXPECT_EQ(*slot_map_get_typed(&map, u32, second), 2);
+    slot_map_destroy(&map);
+    return OK;
+}
+
+Test slot_map_dense_test(void) {
+    SlotMap map;
+    if (!slot_map_create_typed(u32, 4, &map)) {
+        return FAIL;
+    }
+    Handle handles[8];
+    for (u32 i = 0; i < 8; i++) {
+        handles[i] = slot_map_insert(&map, &i);
+    }
+    u32 removed;
+    EXPECT_EQ(slot_map_remove(&map, handles[2], &removed), true);
+    EXPECT_EQ(removed, 2);
+    EXPECT_EQ(slot_map_remove(&map, handles[5], 0), true);
+
+    // The remaining values stay packed and every handle still finds its own value.
+    u32* values = map.values;
+    u32 sum = 0;
+    for (u32 i = 0; i < slot_map_length(&map); i++) {
+        sum += values[i];
+        Handle handle = slot_map_handle_at(&map, i);
+        EXPECT_EQ(*slot_map_get_typed(&map, u32, handle), values[i]);
+    }
+    EXPECT_EQ(slot_map_length(&map), 6);
+    EXPECT_EQ(sum, 28 - 2 - 5);
+    for (u32 i = 0; i < 8; i++) {
+        if (i != 2 && i != 5) {
+            EXPECT_EQ(*slot_map_get_typed(&map, u32, handles[i]), i);
+        }
+    }
+    slot_map_destroy(&map);
+    return OK;
+}
+
+Test slot_map_clear_test(void) {
+    SlotMap map;
+    if (!slot_map_create_typed(u64, 0, &map)) {
+        return FAIL;
+    }
+    Handle handle = slot_map_insert(&map, 0);
+    EXPECT_EQ(*slot_map_get_typed(&map, u64, handle), 0);
+    slot_map_clear(&map);
+    EXPECT_EQ(slot_map_length(&map), 0);
+    EXPECT_EQ(slot_map_contains(&map, handle), false);
+    Handle reused = slot_map_insert(&map, 0);
+    EXPECT_EQ(reused.index, handle.index);
+    EXPECT_EQ(slot_map_contains(&map, reused), true);
+    slot_map_destroy(&map);
+    return OK;
+}
+
+Test slot_map_out_of_memory_test(void) {
+    Arena arena;
+    if (!arena_create(64 * 1024, &arena)) {
+        return FAIL;
+    }
+    Allocator allocator = arena_allocator(&arena);
+    SlotMap map;
+    if (!slot_map_create(sizeof(u64), 0, &allocator, &map)) {
+        arena_destroy(&arena);
+        return FAIL;
+    }
+    // The arena never frees, so growing fails well before this many values.
+    u64 inserted = 0;
+    Handle first = slot_map_insert(&map, &inserted);
+    for (u64 i = 1; i < 100000; i++) {
+        Handle handle = slot_map_insert(&map, &i);
+        if (handle.generation == 0) {
+            break;
+        }
+        inserted++;
+    }
+    EXPECT_EQ((inserted < 100000 - 1), true);
+    EXPECT_EQ(slot_map_length(&map), inserted + 1);
+    EXPECT_EQ(vector_length(map.dense_slots), inserted + 1);
+    EXPECT_EQ(vector_length(map.slots), inserted + 1);
+    EXPECT_EQ(*slot_map_get_typed(&map, u64, first), 0);
+    EXPECT_EQ(*slot_map_get_typed(&map, u64, slot_map_handle_at(&map, (u32)inserted)), inserted);
+    slot_map_destroy(&map);
+    arena_destroy(&arena);
+    return OK;
+}
+
+void register_slot_map_tests(void) {
+    test_runner_register(slot_map_insert_get_test, "Slot map handles find their values");
+    test_runner_register(slot_map_stale_handle_test, "Slot map rejects stale handles");
+    test_runner_register(slot_map_dense_test, "Slot map keeps values packed on removal");
+    test_runner_register(slot_map_clear_test, "Slot map clear invalidates handles");
+    test_runner_register(slot_map_out_of_memory_test,
+                         "Slot map insert leaves the map intact when out of memory");
+}
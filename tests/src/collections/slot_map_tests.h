@@ -0,0 +1,6 @@
+#ifndef SLOT_MAP_TESTS_H
+#define SLOT_MAP_TESTS_H
+
+void register_slot_map_tests(void);
+
+#endif
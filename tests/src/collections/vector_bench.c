@@ -0,0 +1,80 @@
+#include <collections/vector.h>
+#include <collections/vector_bench.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define BENCH_PUSH_COUNT (1 << 20)
+#define BENCH_REMOVE_COUNT (1 << 14)
+
+static f64 million_per_second(u64 count, f64 seconds) {
+    return seconds > 0.0 ? (f64)count / seconds / 1e6 : 0.0;
+}
+
+Test vector_push_bench(void) {
+    // Starting from a single element is how vector_new used to behave.
+    f64 start = platform_system_time();
+    Vector(u32) grown = vector_with_capacity(u32, 1);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; i++) {
+        vector_push(grown, i);
+    }
+    f64 grown_time = platform_system_time() - start;
+
+    start = platform_system_time();
+    Vector(u32) reserved = vector_new(u32);
+    vector_reserve(reserved, BENCH_PUSH_COUNT);
+    for (u32 i = 0; i < BENCH_PUSH_COUNT; i++) {
+        vector_push(reserved, i);
+    }
+    f64 reserved_time = platform_system_time() - start;
+
+    start = platform_system_time();
+    Vector(u32) appended = vector_new(u32);
+    vector_append_n(appended, grown, BENCH_PUSH_COUNT);
+    f64 appended_time = platform_system_time() - start;
+
+    INFO("push %d u32: grown %.1f M/s, reserved %.1f M/s, append_n %.1f M/s",
+         BENCH_PUSH_COUNT, million_per_second(BENCH_PUSH_COUNT, grown_time),
+         million_per_second(BENCH_PUSH_COUNT, reserved_time),
+         million_per_second(BENCH_PUSH_COUNT, appended_time));
+    EXPECT_EQ(vector_length(reserved), BENCH_PUSH_COUNT);
+    EXPECT_EQ(appended[BENCH_PUSH_COUNT - 1], grown[BENCH_PUSH_COUNT - 1]);
+    vector_free(grown);
+    vector_free(reserved);
+    vector_free(appended);
+    return OK;
+}
+
+Test vector_remove_bench(void) {
+    Vector(u64) ordered = vector_with_capacity(u64, BENCH_REMOVE_COUNT);
+    Vector(u64) swapped = vector_with_capacity(u64, BENCH_REMOVE_COUNT);
+    for (u64 i = 0; i < BENCH_REMOVE_COUNT; i++) {
+        vector_push(ordered, i);
+        vector_push(swapped, i);
+    }
+
+    // Removing from the front is the worst case for the ordered remove.
+    f64 start = platform_system_time();
+    while (vector_length(ordered) > 0) {
+        vector_remove(ordered, 0, 0);
+    }
+    f64 ordered_time = platform_system_time() - start;
+
+    start = platform_system_time();
+    while (vector_length(swapped) > 0) {
+        vector_swap_remove(swapped, 0, 0);
+    }
+    f64 swapped_time = platform_system_time() - start;
+
+    INFO("remove %d u64 from the front: remove %.2f M/s, swap_remove %.2f M/s",
+         BENCH_REMOVE_COUNT, million_per_second(BENCH_REMOVE_COUNT, ordered_time),
+         million_per_second(BENCH_REMOVE_COUNT, swapped_time));
+    vector_free(ordered);
+    vector_free(swapped);
+    return OK;
+}
+
+void register_vector_benchmarks(void) {
+    test_runner_register(vector_push_bench, "Benchmark: vector push throughput");
+    test_runner_register(vector_remove_bench, "Benchmark: vector remove throughput");
+}
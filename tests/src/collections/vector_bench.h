@@ -0,0 +1,6 @@
+#ifndef VECTOR_BENCH_H
+#define VECTOR_BENCH_H
+
+void register_vector_benchmarks(void);
+
+#endif
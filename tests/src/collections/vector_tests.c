@@ -1,5 +1,7 @@
 #include <collections/vector.h>
 #include <collections/vector_tests.h>
+#include <core/arena.h>
+#include <core/pool.h>
 #include <core/str.h>
 #include <test.h>
 #include <test_runner.h>
@@ -68,6 +70,167 @@ Test vec_remove_test(void) {
     EXPECT_EQ(first, 0);
     EXPECT_EQ(second, 1);
     EXPECT_EQ(third, 2);
+    vector_free(vec);
+    return OK;
+}
+
+Test vector_reserved_growth_test(void) {
+    Vector(u64) vec = vector_reserved(u64, 1 << 20);
+    EXPECT_NEQ(vec, 0);
+    vector_push(vec, (u64)0);
+    u64* first = &vec[0];
+    for (u64 i = 1; i < 100000; i++) {
+        vector_push(vec, i);
+    }
+    // Growth commits pages in place instead of moving the elements.
+    EXPECT_EQ(&vec[0], first);
+    EXPECT_EQ(vector_length(vec), 100000);
+    EXPECT_EQ(vec[99999], 99999);
+    EXPECT_EQ((vector_capacity(vec) >= 100000), true);
+    vector_free(vec);
+    EXPECT_EQ(vec, 0);
+    return OK;
+}
+
+Test vector_reserved_full_test(void) {
+    Vector(u64) vec = vector_reserved(u64, 4);
+    // The reservation is rounded up to whole pages.
+    u64 capacity = vector_capacity(vec);
+    for (u64 i = 0; i < capacity; i++) {
+        vector_push(vec, i);
+    }
+    u64* data = vec;
+    vector_push(vec, (u64)42);
+    EXPECT_EQ(vec, data);
+    EXPECT_EQ(vector_length(vec), capacity);
+    vector_free(vec);
+    return OK;
+}
+
+Test vec_remove_order_test(void) {
+    Vector(i32) vec = vector_new(i32);
+    for (i32 i = 0; i < 5; i++) {
+        vector_push(vec, i);
+    }
+    vector_remove(vec, 1, 0);
+    EXPECT_EQ(vector_length(vec), 4);
+    EXPECT_EQ(vec[0], 0);
+    EXPECT_EQ(vec[1], 2);
+    EXPECT_EQ(vec[3], 4);
+    vector_free(vec);
+    return OK;
+}
+
+Test vec_swap_remove_test(void) {
+    Vector(i32) vec = vector_new(i32);
+    for (i32 i = 0; i < 4; i++) {
+        vector_push(vec, i);
+    }
+    i32 removed;
+    vector_swap_remove(vec, 0, &removed);
+    EXPECT_EQ(removed, 0);
+    EXPECT_EQ(vector_length(vec), 3);
+    // The last element takes the removed one's place.
+    EXPECT_EQ(vec[0], 3);
+    EXPECT_EQ(vec[2], 2);
+    vector_swap_remove(vec, 2, &removed);
+    EXPECT_EQ(removed, 2);
+    EXPECT_EQ(vector_length(vec), 2);
+    vector_free(vec);
+    return OK;
+}
+
+Test vector_reserve_test(void) {
+    Vector(u32) vec = vector_new(u32);
+    vector_push(vec, 7u);
+    vector_reserve(vec, 1000);
+    EXPECT_EQ((vector_capacity(vec) >= 1000), true);
+    EXPECT_EQ(vec[0], 7);
+    u32* data = vec;
+    for (u32 i = 1; i < 1000; i++) {
+        vector_push(vec, i);
+    }
+    EXPECT_EQ(vec, data);
+    // Reserving less than the capacity does nothing.
+    vector_reserve(vec, 10);
+    EXPECT_EQ(vec, data);
+    vector_free(vec);
+    return OK;
+}
+
+Test vector_shrink_to_fit_test(void) {
+    Vector(u32) vec = vector_with_capacity(u32, 256);
+    vector_push(vec, 1u);
+    vector_push(vec, 2u);
+    vector_shrink_to_fit(vec);
+    EXPECT_EQ(vector_capacity(vec), 2);
+    EXPECT_EQ(vec[1], 2);
+
+    Vector(u64) reserved = vector_reserved(u64, 1 << 16);
+    vector_reserve(reserved, 10000);
+    u64* data = reserved;
+    vector_push(reserved, (u64)3);
+    vector_shrink_to_fit(reserved);
+    EXPECT_EQ(reserved, data);
+    EXPECT_EQ((vector_capacity(reserved) < 10000), true);
+    EXPECT_EQ(reserved[0], 3);
+    vector_free(reserved);
+    vector_free(vec);
+    return OK;
+}
+
+Test vector_append_n_test(void) {
+    u16 values[100];
+    for (u16 i = 0; i < 100; i++) {
+        values[i] = i;
+    }
+    Vector(u16) vec = vector_new(u16);
+    vector_push(vec, (u16)500);
+    vector_append_n(vec, values, 100);
+    EXPECT_EQ(vector_length(vec), 101);
+    EXPECT_EQ(vec[0], 500);
+    EXPECT_EQ(vec[100], 99);
+    vector_free(vec);
+    return OK;
+}
+
+Test vector_arena_test(void) {
+    Arena arena;
+    if (!arena_create(1024 * 1024, &arena)) {
+        return FAIL;
+    }
+    Allocator allocator = arena_allocator(&arena);
+    Vector(u32) vec = vector_with_allocator(u32, 4, &allocator);
+    for (u32 i = 0; i < 100; i++) {
+        vector_push(vec, i);
+    }
+    EXPECT_EQ(vector_length(vec), 100);
+    EXPECT_EQ(vec[99], 99);
+    EXPECT_EQ(((u8*)vec > arena.base && (u8*)vec < arena.base + arena.offset), true);
+    EXPECT_EQ((u64)vec % 16, 0);
+    vector_free(vec);
+    arena_destroy(&arena);
+    return OK;
+}
+
+Test vector_pool_test(void) {
+    Pool pool;
+    if (!pool_create(256, 16, 8, MEM_TAG_VECTOR, POOL_FLAG_NONE, &pool)) {
+        return FAIL;
+    }
+    Allocator allocator = pool_allocator(&pool);
+    Vector(u64) vec = vector_with_allocator(u64, 4, &allocator);
+    EXPECT_NEQ(vec, 0);
+    EXPECT_EQ(pool.live_count, 1);
+    for (u64 i = 0; i < 8; i++) {
+        vector_push(vec, i);
+    }
+    // Growing swaps one pool object for another.
+    EXPECT_EQ(pool.live_count, 1);
+    EXPECT_EQ(vec[7], 7);
+    vector_free(vec);
+    EXPECT_EQ(pool.live_count, 0);
+    pool_destroy(&pool);
     return OK;
 }
 
@@ -77,4 +240,13 @@ void register_vec_tests(void) {
     test_runner_register(vector_push_test, "Element gets pushed back");
     test_runner_register(vec_pop_test, "Last element gets popped");
     test_runner_register(vec_remove_test, "Element at index N is removed.");
+    test_runner_register(vector_reserved_growth_test, "Reserved vector grows in place");
+    test_runner_register(vector_reserved_full_test, "Full reserved vector rejects pushes");
+    test_runner_register(vec_remove_order_test, "Removing keeps the order of the rest");
+    test_runner_register(vec_swap_remove_test, "Swap remove moves the last element in");
+    test_runner_register(vector_reserve_test, "Reserve grows the capacity once");
+    test_runner_register(vector_shrink_to_fit_test, "Shrink to fit releases spare capacity");
+    test_runner_register(vector_append_n_test, "Elements get appended in bulk");
+    test_runner_register(vector_arena_test, "Vector allocates from an arena");
+    test_runner_register(vector_pool_test, "Vector allocates from a pool");
 }
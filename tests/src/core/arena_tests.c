@@ -0,0 +1,98 @@
+#include <core/arena.h>
+#include <core/arena_tests.h>
+#include <test.h>
+#include <test_runner.h>
+
+Test arena_alignment_test(void) {
+    Arena arena;
+    if (!arena_create(1024 * 1024, &arena)) {
+        return FAIL;
+    }
+    u8* a = arena_alloc(&arena, 3, 1);
+    u64* b = arena_push(&arena, u64, 4);
+    u8* c = arena_alloc(&arena, 16, 64);
+    EXPECT_EQ((u64)b % _Alignof(u64), 0);
+    EXPECT_EQ((u64)c % 64, 0);
+    EXPECT_EQ((b > (u64*)a), true);
+    b[3] = 42;
+    c[15] = 7;
+    EXPECT_EQ(b[3], 42);
+    arena_destroy(&arena);
+    return OK;
+}
+
+Test arena_commits_on_demand_test(void) {
+    Arena arena;
+    if (!arena_create(16 * ARENA_COMMIT_GRANULARITY, &arena)) {
+        return FAIL;
+    }
+    EXPECT_EQ(arena.committed, 0);
+    // Spans several commit steps; every byte must be writable.
+    u64 size = 3 * ARENA_COMMIT_GRANULARITY + 100;
+    u8* block = arena_alloc(&arena, size, 16);
+    for (u64 i = 0; i < size; i++) {
+        block[i] = (u8)i;
+    }
+    EXPECT_EQ((arena.committed >= size), true);
+    EXPECT_EQ(block[size - 1], (u8)(size - 1));
+    arena_destroy(&arena);
+    return OK;
+}
+
+Test arena_reset_and_rewind_test(void) {
+    Arena arena;
+    if (!arena_create(1024 * 1024, &arena)) {
+        return FAIL;
+    }
+    void* first = arena_alloc(&arena, 128, 16);
+    u64 mark = arena_mark(&arena);
+    void* temp = arena_alloc(&arena, 256, 16);
+    arena_rewind(&arena, mark);
+    EXPECT_EQ(arena_alloc(&arena, 256, 16), temp);
+    arena_reset(&arena);
+    EXPECT_EQ(arena_alloc(&arena, 128, 16), first);
+    EXPECT_EQ(arena.peak, 128 + 256);
+    arena_destroy(&arena);
+    return OK;
+}
+
+Test arena_exhaustion_test(void) {
+    Arena arena;
+    if (!arena_create(ARENA_COMMIT_GRANULARITY, &arena)) {
+        return FAIL;
+    }
+    EXPECT_EQ((arena_alloc(&arena, arena.reserved, 1) != 0), true);
+    EXPECT_EQ(arena_alloc(&arena, 1, 1), 0);
+    arena_destroy(&arena);
+    return OK;
+}
+
+Test frame_arena_double_buffer_test(void) {
+    FrameArena frame;
+    if (!frame_arena_create(1024 * 1024, &frame)) {
+        return FAIL;
+    }
+    frame_arena_begin(&frame);
+    u32* previous = arena_push(frame_arena_current(&frame), u32, 1);
+    *previous = 1234;
+    frame_arena_begin(&frame);
+    u32* current = arena_push(frame_arena_current(&frame), u32, 1);
+    *current = 5678;
+    // Last frame's data survives the switch.
+    EXPECT_EQ(*previous, 1234);
+    frame_arena_begin(&frame);
+    // Two frames later the first arena is handed out again from the start.
+    EXPECT_EQ(arena_push(frame_arena_current(&frame), u32, 1), previous);
+    EXPECT_EQ(*current, 5678);
+    frame_arena_destroy(&frame);
+    return OK;
+}
+
+void register_arena_tests(void) {
+    test_runner_register(arena_alignment_test, "Arena allocations are aligned");
+    test_runner_register(arena_commits_on_demand_test, "Arena commits pages on demand");
+    test_runner_register(arena_reset_and_rewind_test, "Arena reset and rewind reuse memory");
+    test_runner_register(arena_exhaustion_test, "Arena returns null when exhausted");
+    test_runner_register(frame_arena_double_buffer_test,
+                         "Frame arena keeps the previous frame alive");
+}
@@ -0,0 +1,8 @@
+#ifndef ARENA_TESTS_H
+#define ARENA_TESTS_H
+
+#include <core/arena.h>
+
+void register_arena_tests(void);
+
+#endif
@@ -0,0 +1,97 @@
+#include <core/fiber.h>
+#include <core/fiber_tests.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define FIBER_TEST_STACK (64 * 1024)
+#define FIBER_TEST_ROUNDS 1000
+
+typedef struct PingPong {
+    Fiber* caller;
+    Fiber* self;
+    u32 steps;
+    // Touches the stack between switches, so corrupted callee-saved state shows up.
+    f64 accumulator;
+} PingPong;
+
+typedef struct Migration {
+    Fiber thread_fiber;
+    Fiber* fiber;
+    Fiber* caller;
+} Migration;
+
+static void ping_pong(void* arg) {
+    PingPong* state = arg;
+    f64 local = 0.5;
+    for (;;) {
+        state->steps++;
+        local += 1.0;
+        state->accumulator = local;
+        fiber_switch(state->self, state->caller);
+    }
+}
+
+Test fiber_switch_test(void) {
+    Fiber main_fiber, fiber;
+    if (!fiber_from_thread(&main_fiber)) {
+        return FAIL;
+    }
+    PingPong state = {&main_fiber, &fiber, 0, 0};
+    if (!fiber_create(ping_pong, &state, FIBER_TEST_STACK, &fiber)) {
+        return FAIL;
+    }
+    u64 expected = 0;
+    for (u32 i = 0; i < FIBER_TEST_ROUNDS; i++) {
+        expected += i;
+        fiber_switch(&main_fiber, &fiber);
+    }
+    EXPECT_EQ(state.steps, FIBER_TEST_ROUNDS);
+    EXPECT_EQ(state.accumulator, FIBER_TEST_ROUNDS + 0.5);
+    // The main thread's registers survived as well.
+    EXPECT_EQ(expected, (u64)FIBER_TEST_ROUNDS * (FIBER_TEST_ROUNDS - 1) / 2);
+    fiber_destroy(&fiber);
+    fiber_destroy(&main_fiber);
+    return OK;
+}
+
+static void resume_elsewhere(void* arg) {
+    Migration* migration = arg;
+    if (!fiber_from_thread(&migration->thread_fiber)) {
+        return;
+    }
+    fiber_switch(&migration->thread_fiber, migration->fiber);
+    fiber_destroy(&migration->thread_fiber);
+}
+
+Test fiber_migration_test(void) {
+    Fiber main_fiber, fiber;
+    if (!fiber_from_thread(&main_fiber)) {
+        return FAIL;
+    }
+    Migration migration = {0};
+    PingPong state = {&main_fiber, &fiber, 0, 0};
+    if (!fiber_create(ping_pong, &state, FIBER_TEST_STACK, &fiber)) {
+        return FAIL;
+    }
+    fiber_switch(&main_fiber, &fiber);
+    EXPECT_EQ(state.steps, 1);
+    // The second half of the fiber runs on another thread, which it then returns to.
+    migration.fiber = &fiber;
+    state.caller = &migration.thread_fiber;
+    Thread thread;
+    if (!platform_thread_create(resume_elsewhere, &migration, &thread)) {
+        return FAIL;
+    }
+    platform_thread_join(&thread);
+    EXPECT_EQ(state.steps, 2);
+    EXPECT_EQ(state.accumulator, 2.5);
+    fiber_destroy(&fiber);
+    fiber_destroy(&main_fiber);
+    return OK;
+}
+
+void register_fiber_tests(void) {
+    test_runner_register(fiber_switch_test, "Fibers switch back and forth keeping state");
+    test_runner_register(fiber_migration_test, "Fibers can be resumed on another thread");
+}
@@ -0,0 +1,6 @@
+#ifndef FIBER_TESTS_H
+#define FIBER_TESTS_H
+
+void register_fiber_tests(void);
+
+#endif
@@ -0,0 +1,73 @@
+#include <core/frame_limiter.h>
+#include <core/frame_limiter_tests.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+Test frame_limiter_caps_rate_test(void) {
+    FrameLimiter limiter;
+    frame_limiter_create(200.0f, &limiter);
+    f64 start = platform_system_time();
+    // Deadlines advance by a fixed step, so single frames may be shorter after a late one,
+    // but the total can never be.
+    for (u32 i = 0; i < 5; i++) {
+        frame_limiter_wait(&limiter);
+    }
+    f64 total = platform_system_time() - start;
+    if (total < 0.0249) {
+        ERROR("5 frames at 200 fps took %.4fs", total);
+        return FAIL;
+    }
+    return OK;
+}
+
+Test frame_limiter_uncapped_test(void) {
+    FrameLimiter limiter;
+    frame_limiter_create(0.0f, &limiter);
+    f64 start = platform_system_time();
+    for (u32 i = 0; i < 100; i++) {
+        frame_limiter_wait(&limiter);
+    }
+    if (platform_system_time() - start > 0.01) {
+        ERROR("An uncapped limiter should not wait");
+        return FAIL;
+    }
+    return OK;
+}
+
+Test frame_limiter_recovers_from_stall_test(void) {
+    FrameLimiter limiter;
+    frame_limiter_create(100.0f, &limiter);
+    frame_limiter_wait(&limiter);
+    // A stall longer than several frames must not cause a burst of unpaced frames.
+    platform_sleep(0.05);
+    frame_limiter_wait(&limiter);
+    f64 dt = frame_limiter_wait(&limiter);
+    if (dt < 0.0095) {
+        ERROR("frame after a stall took %.4fs, expected at least 0.01s", dt);
+        return FAIL;
+    }
+    return OK;
+}
+
+Test frame_limiter_bounds_spin_test(void) {
+    FrameLimiter limiter;
+    frame_limiter_create(144.0f, &limiter);
+    // As if the OS once overslept by more than a frame.
+    limiter.spin_margin = 0.008;
+    frame_limiter_wait(&limiter);
+    if (limiter.spin_margin > 0.25 / 144.0) {
+        ERROR("spin margin stayed at %.4fs after a long oversleep", limiter.spin_margin);
+        return FAIL;
+    }
+    return OK;
+}
+
+void register_frame_limiter_tests(void) {
+    test_runner_register(frame_limiter_caps_rate_test, "Frame limiter holds the target rate");
+    test_runner_register(frame_limiter_uncapped_test, "Uncapped frame limiter does not wait");
+    test_runner_register(frame_limiter_recovers_from_stall_test,
+                         "Frame limiter does not catch up after a stall");
+    test_runner_register(frame_limiter_bounds_spin_test,
+                         "Frame limiter keeps sleeping after a long oversleep");
+}
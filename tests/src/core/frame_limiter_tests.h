@@ -0,0 +1,8 @@
+#ifndef FRAME_LIMITER_TESTS_H
+#define FRAME_LIMITER_TESTS_H
+
+#include <core/frame_limiter.h>
+
+void register_frame_limiter_tests(void);
+
+#endif
@@ -0,0 +1,156 @@
+#include <core/job.h>
+#include <core/job_tests.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define JOB_TEST_WORKERS 3
+#define JOB_TEST_COUNT 1000
+#define JOB_TEST_RANGE 100000
+// More than there are threads, fewer than there are fibers.
+#define JOB_TEST_SUSPENDED 48
+
+typedef struct Dependency {
+    _Atomic(u32)* value;
+    // The value the inner jobs must have produced before the outer one reads it.
+    u32 seen;
+} Dependency;
+
+static void increment(void* arg) {
+    atomic_fetch_add((_Atomic(u32)*)arg, 1);
+}
+
+static void mark_range(u32 start, u32 end, void* arg) {
+    _Atomic(u8)* visits = arg;
+    for (u32 i = start; i < end; i++) {
+        atomic_fetch_add(&visits[i], 1);
+    }
+}
+
+static void wait_on_children(void* arg) {
+    Dependency* dependency = arg;
+    JobCounter children = {0};
+    for (u32 i = 0; i < 16; i++) {
+        job_run(increment, dependency->value, &children);
+    }
+    job_wait(&children);
+    dependency->seen = atomic_load(dependency->value);
+}
+
+typedef struct Gate {
+    JobCounter open;
+    _Atomic(u32) started;
+    _Atomic(u32) finished;
+} Gate;
+
+static void wait_at_gate(void* arg) {
+    Gate* gate = arg;
+    atomic_fetch_add(&gate->started, 1);
+    job_wait(&gate->open);
+    atomic_fetch_add(&gate->finished, 1);
+}
+
+Test job_run_counter_test(void) {
+    if (!job_system_create(JOB_TEST_WORKERS)) {
+        return FAIL;
+    }
+    EXPECT_EQ(job_system_thread_count(), JOB_TEST_WORKERS + 1);
+    EXPECT_EQ(job_thread_index(), 0);
+    _Atomic(u32) value = 0;
+    JobCounter counter = {0};
+    for (u32 i = 0; i < JOB_TEST_COUNT; i++) {
+        job_run(increment, &value, &counter);
+    }
+    job_wait(&counter);
+    EXPECT_EQ(atomic_load(&value), JOB_TEST_COUNT);
+    EXPECT_EQ(atomic_load(&counter.value), 0);
+    job_system_destroy();
+    return OK;
+}
+
+Test job_parallel_for_test(void) {
+    static _Atomic(u8) visits[JOB_TEST_RANGE];
+    for (u32 i = 0; i < JOB_TEST_RANGE; i++) {
+        atomic_init(&visits[i], 0);
+    }
+    if (!job_system_create(JOB_TEST_WORKERS)) {
+        return FAIL;
+    }
+    parallel_for(JOB_TEST_RANGE, 64, mark_range, visits);
+    // Odd sizes and ranges smaller than the grain.
+    parallel_for(7, 64, mark_range, visits);
+    job_system_destroy();
+    bool once = true;
+    for (u32 i = 0; i < JOB_TEST_RANGE; i++) {
+        once = once && atomic_load(&visits[i]) == (i < 7 ? 2 : 1);
+    }
+    EXPECT_EQ(once, true);
+    return OK;
+}
+
+Test job_dependency_test(void) {
+    if (!job_system_create(JOB_TEST_WORKERS)) {
+        return FAIL;
+    }
+    _Atomic(u32) values[4] = {0};
+    Dependency dependencies[4];
+    JobDecl decls[4];
+    for (u32 i = 0; i < 4; i++) {
+        dependencies[i] = (Dependency){&values[i], 0};
+        decls[i] = (JobDecl){wait_on_children, &dependencies[i]};
+    }
+    JobCounter counter = {0};
+    job_run_batch(decls, 4, &counter);
+    job_wait(&counter);
+    for (u32 i = 0; i < 4; i++) {
+        EXPECT_EQ(dependencies[i].seen, 16);
+    }
+    job_system_destroy();
+    return OK;
+}
+
+Test job_wait_suspends_test(void) {
+    if (!job_system_create(JOB_TEST_WORKERS)) {
+        return FAIL;
+    }
+    Gate gate = {0};
+    atomic_init(&gate.open.value, 1);
+    JobCounter counter = {0};
+    for (u32 i = 0; i < JOB_TEST_SUSPENDED; i++) {
+        job_run(wait_at_gate, &gate, &counter);
+    }
+    // The workers get to start every job although each one blocks on the gate: waiting jobs
+    // are set aside and their threads move on.
+    while (atomic_load(&gate.started) < JOB_TEST_SUSPENDED) {
+        platform_thread_yield();
+    }
+    EXPECT_EQ(atomic_load(&gate.finished), 0);
+    atomic_store(&gate.open.value, 0);
+    job_wait(&counter);
+    EXPECT_EQ(atomic_load(&gate.finished), JOB_TEST_SUSPENDED);
+    job_system_destroy();
+    return OK;
+}
+
+Test job_inline_without_system_test(void) {
+    EXPECT_EQ(job_system_thread_count(), 1);
+    _Atomic(u32) value = 0;
+    JobCounter counter = {0};
+    job_run(increment, &value, &counter);
+    // Ran before job_run returned, so there is nothing to wait for.
+    EXPECT_EQ(atomic_load(&value), 1);
+    EXPECT_EQ(atomic_load(&counter.value), 0);
+    job_wait(&counter);
+    static _Atomic(u8) visits[10];
+    parallel_for(10, 1, mark_range, visits);
+    EXPECT_EQ(atomic_load(&visits[9]), 1);
+    return OK;
+}
+
+void register_job_tests(void) {
+    test_runner_register(job_run_counter_test, "Job counters track every queued job");
+    test_runner_register(job_parallel_for_test, "parallel_for visits every index once");
+    test_runner_register(job_dependency_test, "Jobs can wait on jobs they spawn");
+    test_runner_register(job_wait_suspends_test, "Waiting jobs are suspended, not blocking");
+    test_runner_register(job_inline_without_system_test, "Jobs run inline without a job system");
+}
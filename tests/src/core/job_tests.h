@@ -0,0 +1,6 @@
+#ifndef JOB_TESTS_H
+#define JOB_TESTS_H
+
+void register_job_tests(void);
+
+#endif
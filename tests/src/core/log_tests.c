@@ -0,0 +1,275 @@
+#include <core/log.h>
+#include <core/log_format.h>
+#include <core/log_tests.h>
+#include <core/mem.h>
+#include <platform/fs.h>
+#include <platform/platform.h>
+#include <string.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define LOG_TEST_THREADS 4
+#define LOG_TEST_LINES 16
+#define LOG_TEST_LONG 600
+#define LOG_TEST_BINARY_LINES 8
+
+static void log_lines(void* arg) {
+    u32 thread = (u32)(u64)arg;
+    for (u32 i = 0; i < LOG_TEST_LINES; i++) {
+        DEBUG("log test thread %d line %d", thread, i);
+    }
+}
+
+Test logger_threads_test(void) {
+    if (!logger_create()) {
+        return FAIL;
+    }
+    Thread threads[LOG_TEST_THREADS];
+    for (u32 i = 0; i < LOG_TEST_THREADS; i++) {
+        if (!platform_thread_create(log_lines, (void*)(u64)i, &threads[i])) {
+            return FAIL;
+        }
+    }
+    for (u32 i = 0; i < LOG_TEST_THREADS; i++) {
+        platform_thread_join(&threads[i]);
+    }
+    // Longer than a queued record holds inline.
+    char long_message[LOG_TEST_LONG + 1];
+    memset(long_message, 'x', LOG_TEST_LONG);
+    long_message[LOG_TEST_LONG] = 0;
+    DEBUG("%s", long_message);
+    logger_destroy();
+
+    File file;
+    if (!fs_open("latest.log", OPEN_FILE_MODE_READ_BINARY, &file)) {
+        return FAIL;
+    }
+    u64 size = 0;
+    char* text = (char*)fs_read_all(&file, &size);
+    fs_close(&file);
+    // The file contents aren't null terminated.
+    const char* marker = "log test thread";
+    u64 marker_length = strlen(marker);
+    u32 lines = 0, test_lines = 0;
+    u64 longest = 0, line_start = 0;
+    for (u64 i = 0; i < size; i++) {
+        if (text[i] == '\n') {
+            lines++;
+            longest = i - line_start > longest ? i - line_start : longest;
+            line_start = i + 1;
+        } else if (i + marker_length <= size && memcmp(text + i, marker, marker_length) == 0) {
+            test_lines++;
+        }
+    }
+    mem_free(text);
+    // "Logger initialized", every thread's lines and the long message, each complete.
+    EXPECT_EQ(lines, LOG_TEST_THREADS * LOG_TEST_LINES + 2);
+    EXPECT_EQ(test_lines, LOG_TEST_THREADS * LOG_TEST_LINES);
+    EXPECT_EQ((longest > LOG_TEST_LONG), true);
+    return OK;
+}
+
+// Returns the offset of `needle` in the first `size` bytes of `text`, or `size` if it isn't there.
+static u64 find_text(const char* text, u64 size, const char* needle) {
+    u64 length = strlen(needle);
+    for (u64 i = 0; i + length <= size; i++) {
+        if (memcmp(text + i, needle, length) == 0) {
+            return i;
+        }
+    }
+    return size;
+}
+
+Test logger_order_test(void) {
+    if (!logger_create()) {
+        return FAIL;
+    }
+    // Too long to capture, so the second message is formatted on this thread.
+    char long_message[LOG_TEST_LONG + 1];
+    memset(long_message, 'x', LOG_TEST_LONG);
+    long_message[LOG_TEST_LONG] = 0;
+    DEBUG("order test %d", 1);
+    DEBUG("order test %d %s", 2, long_message);
+    DEBUG("order test %d", 3);
+    logger_log(LOG_LEVEL_DEBUG, __FILE__, __LINE__, "order test %d", 4);
+    logger_destroy();
+
+    File file;
+    if (!fs_open("latest.log", OPEN_FILE_MODE_READ_BINARY, &file)) {
+        return FAIL;
+    }
+    u64 size = 0;
+    char* text = (char*)fs_read_all(&file, &size);
+    fs_close(&file);
+    u64 first = find_text(text, size, "order test 1");
+    u64 second = find_text(text, size, "order test 2");
+    u64 third = find_text(text, size, "order test 3");
+    u64 fourth = find_text(text, size, "order test 4");
+    mem_free(text);
+    EXPECT_EQ((first < second), true);
+    EXPECT_EQ((second < third), true);
+    EXPECT_EQ((third < fourth), true);
+    EXPECT_EQ((fourth < size), true);
+    return OK;
+}
+
+Test log_format_signature_test(void) {
+    u8 types[LOG_FORMAT_MAX_ARGS];
+    u32 count = 0;
+    EXPECT_EQ(log_format_signature("%d%% %-*.*f %-*s %zu %p %Lf", types, &count), true);
+    EXPECT_EQ(count, 9);
+    EXPECT_EQ(types[0], LOG_ARG_INT);
+    EXPECT_EQ(types[1], LOG_ARG_INT);
+    EXPECT_EQ(types[2], LOG_ARG_INT);
+    EXPECT_EQ(types[3], LOG_ARG_DOUBLE);
+    EXPECT_EQ(types[4], LOG_ARG_INT);
+    EXPECT_EQ(types[5], LOG_ARG_STRING);
+    EXPECT_EQ(types[6], LOG_ARG_SIZE);
+    EXPECT_EQ(types[7], LOG_ARG_POINTER);
+    EXPECT_EQ(types[8], LOG_ARG_LDOUBLE);
+    EXPECT_EQ(log_format_signature("no arguments", types, &count), true);
+    EXPECT_EQ(count, 0);
+    // Writes through a pointer, so it can't run on another thread later.
+    EXPECT_EQ(log_format_signature("%d%n", types, &count), false);
+    EXPECT_EQ(log_format_signature("%ls", types, &count), false);
+    // The string may stop at the precision instead of a terminator.
+    EXPECT_EQ(log_format_signature("%.5s", types, &count), false);
+    EXPECT_EQ(log_format_signature("%.*s", types, &count), false);
+    return OK;
+}
+
+Test log_format_captured_test(void) {
+    u8 args[64];
+    u64 size = 0;
+    i32 number = -42;
+    i32 width = 6;
+    u16 length = 3;
+    f64 value = 1.5;
+    i64 big = 1ll << 40;
+    memcpy(args + size, &number, sizeof(number));
+    size += sizeof(number);
+    memcpy(args + size, &width, sizeof(width));
+    size += sizeof(width);
+    memcpy(args + size, &length, sizeof(length));
+    size += sizeof(length);
+    memcpy(args + size, "abc", length);
+    size += length;
+    memcpy(args + size, &value, sizeof(value));
+    size += sizeof(value);
+    memcpy(args + size, &big, sizeof(big));
+    size += sizeof(big);
+
+    char out[128];
+    const char* format = "%d: [%*s] %.2f%% %lld";
+    EXPECT_EQ(log_format_captured(out, sizeof(out), format, args, size), strlen(out));
+    EXPECT_EQ(strcmp(out, "-42: [   abc] 1.50% 1099511627776"), 0);
+    // Truncated output stays terminated.
+    EXPECT_EQ(log_format_captured(out, 8, format, args, size), 7);
+    EXPECT_EQ(strcmp(out, "-42: [ "), 0);
+    // Fewer captured bytes than the format reads.
+    EXPECT_EQ(log_format_captured(out, sizeof(out), format, args, size - 1), 0);
+    return OK;
+}
+
+Test logger_binary_test(void) {
+    if (!logger_create()) {
+        return FAIL;
+    }
+    logger_set_binary(true);
+    for (u32 i = 0; i < LOG_TEST_BINARY_LINES; i++) {
+        DEBUG("binary line %d of %s", i, "log test");
+    }
+    logger_destroy();
+    logger_set_binary(false);
+
+    File file;
+    if (!fs_open("latest.binlog", OPEN_FILE_MODE_READ_BINARY, &file)) {
+        return FAIL;
+    }
+    u64 size = 0;
+    u8* data = (u8*)fs_read_all(&file, &size);
+    fs_close(&file);
+    EXPECT_EQ((size > LOG_BINARY_MAGIC_SIZE), true);
+    EXPECT_EQ(memcmp(data, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_SIZE), 0);
+    u32 sites = 0, events = 0;
+    u64 offset = LOG_BINARY_MAGIC_SIZE;
+    bool ok = true;
+    char message[64] = {0};
+    while (ok && offset < size) {
+        u8 kind = data[offset++];
+        u16 length;
+        if (kind == LOG_BINARY_SITE) {
+            // id, level and line, then the file and format strings.
+            offset += sizeof(u32) + sizeof(u8) + sizeof(u32);
+            for (u32 i = 0; i < 2; i++) {
+                memcpy(&length, data + offset, sizeof(length));
+                offset += sizeof(length) + length;
+            }
+            sites++;
+        } else if (kind == LOG_BINARY_EVENT) {
+            offset += sizeof(u32) + sizeof(f64);
+            memcpy(&length, data + offset, sizeof(length));
+            offset += sizeof(length);
+            log_format_captured(message, sizeof(message), "binary line %d of %s", data + offset,
+                                length);
+            offset += length;
+            events++;
+        } else {
+            ok = false;
+        }
+    }
+    mem_free(data);
+    EXPECT_EQ(ok, true);
+    EXPECT_EQ(offset, size);
+    // Every site registered so far is defined, even ones that only logged as text.
+    EXPECT_EQ((sites >= 2), true);
+    EXPECT_EQ(events, LOG_TEST_BINARY_LINES + 1);
+    EXPECT_EQ(strcmp(message, "binary line 7 of log test"), 0);
+    return OK;
+}
+
+static u32 count_call(u32* count) {
+    return ++*count;
+}
+
+Test logger_level_test(void) {
+    u32 count = 0;
+    logger_set_level("tests/src/core/log_tests", LOG_LEVEL_INFO);
+    for (u32 i = 0; i < 3; i++) {
+        DEBUG("filtered %u", count_call(&count));
+    }
+    EXPECT_EQ(count, 0);
+    INFO("logged %u", count_call(&count));
+    EXPECT_EQ(count, 1);
+    // The longer prefix still applies.
+    logger_set_level("tests/src/core/", LOG_LEVEL_ERROR);
+    INFO("logged %u", count_call(&count));
+    EXPECT_EQ(count, 2);
+    logger_set_level("tests/src/core/log_tests", LOG_LEVEL_TRACE);
+    DEBUG("logged %u", count_call(&count));
+    EXPECT_EQ(count, 3);
+    logger_set_level("tests/src/core/", LOG_LEVEL_TRACE);
+    return OK;
+}
+
+// The test below builds as if LOG_MIN_LEVEL were INFO, like a release build.
+#undef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+
+Test logger_min_level_test(void) {
+    u32 count = 0;
+    DEBUG("compiled out %u", count_call(&count));
+    TRACE("compiled out %u", count_call(&count));
+    EXPECT_EQ(count, 0);
+    return OK;
+}
+
+void register_log_tests(void) {
+    test_runner_register(logger_threads_test, "Logger writes every line from every thread");
+    test_runner_register(logger_order_test, "Logger keeps each thread's messages in order");
+    test_runner_register(log_format_signature_test, "Log format signatures list argument types");
+    test_runner_register(log_format_captured_test, "Log formatting from captured arguments");
+    test_runner_register(logger_binary_test, "Binary logging defers formatting to a decoder");
+    test_runner_register(logger_level_test, "Module log levels skip filtered statements");
+    test_runner_register(logger_min_level_test, "LOG_MIN_LEVEL compiles statements out");
+}
@@ -0,0 +1,6 @@
+#ifndef LOG_TESTS_H
+#define LOG_TESTS_H
+
+void register_log_tests(void);
+
+#endif
@@ -0,0 +1,92 @@
+#include <core/mem.h>
+#include <core/mem_tests.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define MEM_TEST_THREADS 4
+#define MEM_TEST_ITERATIONS 10000
+
+Test mem_tagged_accounting_test(void) {
+    MemStats before;
+    MemStats after;
+    mem_stats(MEM_TAG_CHUNK, &before);
+    u8* a = mem_alloc_tagged(100, MEM_TAG_CHUNK);
+    u8* b = mem_alloc_tagged(28, MEM_TAG_CHUNK);
+    mem_stats(MEM_TAG_CHUNK, &after);
+    EXPECT_EQ(after.live_bytes - before.live_bytes, 128);
+    EXPECT_EQ(after.allocations - before.allocations, 2);
+
+    mem_free(a);
+    mem_free(b);
+    mem_stats(MEM_TAG_CHUNK, &after);
+    EXPECT_EQ(after.live_bytes, before.live_bytes);
+    EXPECT_EQ(after.frees - before.frees, 2);
+    return OK;
+}
+
+Test mem_peak_test(void) {
+    MemStats before;
+    MemStats after;
+    mem_stats(MEM_TAG_CHUNK, &before);
+    u64 size = before.peak_bytes - before.live_bytes + 4096;
+    void* block = mem_alloc_tagged(size, MEM_TAG_CHUNK);
+    mem_free(block);
+    mem_stats(MEM_TAG_CHUNK, &after);
+    // The peak outlives the block that set it.
+    EXPECT_EQ(after.peak_bytes, before.live_bytes + size);
+    EXPECT_EQ(after.live_bytes, before.live_bytes);
+    return OK;
+}
+
+Test mem_untagged_counts_as_unknown_test(void) {
+    MemStats before;
+    MemStats after;
+    MemStats total_before;
+    MemStats total_after;
+    mem_stats(MEM_TAG_UNKNOWN, &before);
+    mem_stats_total(&total_before);
+    void* block = mem_alloc(64);
+    mem_stats(MEM_TAG_UNKNOWN, &after);
+    mem_stats_total(&total_after);
+    mem_free(block);
+    EXPECT_EQ(after.live_bytes - before.live_bytes, 64);
+    EXPECT_EQ(total_after.live_bytes - total_before.live_bytes, 64);
+    return OK;
+}
+
+static void churn(void* arg) {
+    (void)arg;
+    for (u32 i = 0; i < MEM_TEST_ITERATIONS; i++) {
+        void* block = mem_alloc_tagged(16 + i % 64, MEM_TAG_CHUNK);
+        mem_free(block);
+    }
+}
+
+Test mem_concurrent_counters_test(void) {
+    MemStats before;
+    MemStats after;
+    mem_stats(MEM_TAG_CHUNK, &before);
+    Thread threads[MEM_TEST_THREADS];
+    for (u32 i = 0; i < MEM_TEST_THREADS; i++) {
+        if (!platform_thread_create(churn, 0, &threads[i])) {
+            return FAIL;
+        }
+    }
+    for (u32 i = 0; i < MEM_TEST_THREADS; i++) {
+        platform_thread_join(&threads[i]);
+    }
+    mem_stats(MEM_TAG_CHUNK, &after);
+    EXPECT_EQ(after.live_bytes, before.live_bytes);
+    EXPECT_EQ(after.allocations - before.allocations, MEM_TEST_THREADS * MEM_TEST_ITERATIONS);
+    EXPECT_EQ(after.frees - before.frees, MEM_TEST_THREADS * MEM_TEST_ITERATIONS);
+    return OK;
+}
+
+void register_mem_tests(void) {
+    test_runner_register(mem_tagged_accounting_test, "Tagged allocations are accounted");
+    test_runner_register(mem_peak_test, "Memory peak survives frees");
+    test_runner_register(mem_untagged_counts_as_unknown_test,
+                         "Untagged allocations count as unknown");
+    test_runner_register(mem_concurrent_counters_test, "Memory counters are thread safe");
+}
@@ -0,0 +1,8 @@
+#ifndef MEM_TESTS_H
+#define MEM_TESTS_H
+
+#include <core/mem.h>
+
+void register_mem_tests(void);
+
+#endif
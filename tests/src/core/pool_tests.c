@@ -0,0 +1,167 @@
+#include <core/pool.h>
+#include <core/pool_tests.h>
+#include <platform/platform.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define POOL_TEST_THREADS 4
+#define POOL_TEST_ITERATIONS 20000
+
+typedef struct PoolTestObject {
+    u64 id;
+    f32 values[5];
+} PoolTestObject;
+
+Test pool_reuses_freed_objects_test(void) {
+    Pool pool;
+    if (!pool_create_typed(PoolTestObject, 8, MEM_TAG_CHUNK, POOL_FLAG_NONE, &pool)) {
+        return FAIL;
+    }
+    PoolTestObject* a = pool_new(&pool, PoolTestObject);
+    PoolTestObject* b = pool_new(&pool, PoolTestObject);
+    EXPECT_EQ(((u8*)b - (u8*)a), (i64)sizeof(PoolTestObject));
+    pool_free(&pool, a);
+    EXPECT_EQ(pool_new(&pool, PoolTestObject), a);
+    EXPECT_EQ(pool.live_count, 2);
+    pool_free(&pool, a);
+    pool_free(&pool, b);
+    EXPECT_EQ(pool.live_count, 0);
+    pool_destroy(&pool);
+    return OK;
+}
+
+Test pool_grows_slabs_test(void) {
+    Pool pool;
+    if (!pool_create(24, 64, 4, MEM_TAG_CHUNK, POOL_FLAG_NONE, &pool)) {
+        return FAIL;
+    }
+    void* objects[10];
+    for (u32 i = 0; i < 10; i++) {
+        objects[i] = pool_alloc(&pool);
+        EXPECT_EQ((u64)objects[i] % 64, 0);
+    }
+    EXPECT_EQ(pool.slab_count, 3);
+    EXPECT_EQ(pool_capacity(&pool), 12);
+    for (u32 i = 0; i < 10; i++) {
+        pool_free(&pool, objects[i]);
+    }
+    pool_destroy(&pool);
+    return OK;
+}
+
+Test pool_poison_test(void) {
+    Pool pool;
+    if (!pool_create_typed(PoolTestObject, 4, MEM_TAG_CHUNK, POOL_FLAG_POISON, &pool)) {
+        return FAIL;
+    }
+    PoolTestObject* a = pool_new(&pool, PoolTestObject);
+    PoolTestObject* b = pool_new(&pool, PoolTestObject);
+    a->id = 1;
+    pool_free(&pool, a);
+    EXPECT_EQ((a->values[4] != 0.0f), true);
+    // The second free is reported and ignored, so the count stays right.
+    pool_free(&pool, a);
+    EXPECT_EQ(pool.live_count, 1);
+    pool_free(&pool, b);
+    pool_destroy(&pool);
+    return OK;
+}
+
+Test pool_cache_poison_test(void) {
+    MemStats before;
+    MemStats after;
+    Pool pool;
+    if (!pool_create_typed(PoolTestObject, 4, MEM_TAG_CHUNK, POOL_FLAG_POISON, &pool)) {
+        return FAIL;
+    }
+    mem_stats(MEM_TAG_CHUNK, &before);
+    PoolCache cache;
+    pool_cache_create(&pool, &cache);
+    PoolTestObject* a = pool_cache_alloc(&cache);
+    a->id = 1;
+    pool_cache_free(&cache, a);
+    // Ignored, so the object is cached once and handed out once.
+    pool_cache_free(&cache, a);
+    PoolTestObject* first = pool_cache_alloc(&cache);
+    PoolTestObject* second = pool_cache_alloc(&cache);
+    EXPECT_NEQ(first, second);
+    pool_cache_free(&cache, first);
+    pool_cache_free(&cache, second);
+    pool_cache_flush(&cache);
+    // Freed twice through the pool itself after the cache returned it.
+    pool_free(&pool, a);
+    mem_stats(MEM_TAG_CHUNK, &after);
+    EXPECT_EQ(after.pooled_bytes, before.pooled_bytes);
+    EXPECT_EQ(pool.live_count, 0);
+    pool_destroy(&pool);
+    return OK;
+}
+
+Test pool_tracks_pooled_bytes_test(void) {
+    MemStats before;
+    MemStats after;
+    Pool pool;
+    if (!pool_create_typed(PoolTestObject, 16, MEM_TAG_CHUNK, POOL_FLAG_NONE, &pool)) {
+        return FAIL;
+    }
+    mem_stats(MEM_TAG_CHUNK, &before);
+    void* a = pool_alloc(&pool);
+    void* b = pool_alloc(&pool);
+    mem_stats(MEM_TAG_CHUNK, &after);
+    EXPECT_EQ(after.pooled_bytes - before.pooled_bytes, 2 * pool.object_size);
+    // The whole slab is live, only two objects of it are in use.
+    EXPECT_EQ((after.live_bytes - before.live_bytes >= 16 * pool.object_size), true);
+    pool_free(&pool, a);
+    pool_free(&pool, b);
+    pool_destroy(&pool);
+    mem_stats(MEM_TAG_CHUNK, &after);
+    EXPECT_EQ(after.pooled_bytes, before.pooled_bytes);
+    EXPECT_EQ(after.live_bytes, before.live_bytes);
+    return OK;
+}
+
+static void cache_churn(void* arg) {
+    PoolCache cache;
+    pool_cache_create(arg, &cache);
+    u64* held[8] = {0};
+    for (u32 i = 0; i < POOL_TEST_ITERATIONS; i++) {
+        u32 slot = i % 8;
+        if (held[slot]) {
+            pool_cache_free(&cache, held[slot]);
+        }
+        held[slot] = pool_cache_alloc(&cache);
+        *held[slot] = i;
+    }
+    for (u32 i = 0; i < 8; i++) {
+        pool_cache_free(&cache, held[i]);
+    }
+    pool_cache_flush(&cache);
+}
+
+Test pool_thread_caches_test(void) {
+    Pool pool;
+    if (!pool_create_typed(u64, 64, MEM_TAG_CHUNK, POOL_FLAG_NONE, &pool)) {
+        return FAIL;
+    }
+    Thread threads[POOL_TEST_THREADS];
+    for (u32 i = 0; i < POOL_TEST_THREADS; i++) {
+        if (!platform_thread_create(cache_churn, &pool, &threads[i])) {
+            return FAIL;
+        }
+    }
+    for (u32 i = 0; i < POOL_TEST_THREADS; i++) {
+        platform_thread_join(&threads[i]);
+    }
+    EXPECT_EQ(pool.live_count, 0);
+    pool_destroy(&pool);
+    return OK;
+}
+
+void register_pool_tests(void) {
+    test_runner_register(pool_reuses_freed_objects_test, "Pool reuses freed objects");
+    test_runner_register(pool_grows_slabs_test, "Pool grows aligned slabs on demand");
+    test_runner_register(pool_poison_test, "Pool poison catches double frees");
+    test_runner_register(pool_cache_poison_test, "Pool caches catch double frees");
+    test_runner_register(pool_tracks_pooled_bytes_test, "Pool reports pooled bytes by tag");
+    test_runner_register(pool_thread_caches_test, "Pool caches share a pool across threads");
+}
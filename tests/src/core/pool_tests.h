@@ -0,0 +1,8 @@
+#ifndef POOL_TESTS_H
+#define POOL_TESTS_H
+
+#include <core/pool.h>
+
+void register_pool_tests(void);
+
+#endif
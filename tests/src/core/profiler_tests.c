@@ -0,0 +1,134 @@
+#include <core/mem.h>
+#include <core/profiler.h>
+#include <core/profiler_tests.h>
+#include <platform/fs.h>
+#include <platform/platform.h>
+#include <stdio.h>
+#include <string.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define PROFILER_TEST_PATH "profile_test.json"
+#define PROFILER_TEST_ITERATIONS 100
+
+static void inner_work(void) {
+    PROFILE_SCOPE("profiler test inner");
+    platform_cpu_relax();
+}
+
+static void profiled_thread(void* arg) {
+    UNUSED(arg);
+    profiler_set_thread_name("profiler test thread");
+    for (u32 i = 0; i < PROFILER_TEST_ITERATIONS; i++) {
+        PROFILE_SCOPE("profiler test outer");
+        inner_work();
+    }
+}
+
+typedef struct ProfilerExport {
+    char* data;
+    u64 size;
+} ProfilerExport;
+
+// Reads the exported file back and deletes it.
+static ProfilerExport read_export(void) {
+    ProfilerExport export = {0};
+    File file;
+    if (fs_open(PROFILER_TEST_PATH, OPEN_FILE_MODE_READ_BINARY, &file)) {
+        export.data = (char*)fs_read_all(&file, &export.size);
+        fs_close(&file);
+    }
+    remove(PROFILER_TEST_PATH);
+    return export;
+}
+
+// Occurrences of `text` in the export, which isn't null terminated.
+static u32 count_in_export(const ProfilerExport* export, const char* text) {
+    u64 length = strlen(text);
+    u32 count = 0;
+    for (u64 i = 0; export->data && i + length <= export->size; i++) {
+        count += memcmp(export->data + i, text, length) == 0;
+    }
+    return count;
+}
+
+Test profiler_export_test(void) {
+#if !PROFILE_ENABLED
+    return IGNORE;
+#endif
+    if (!profiler_create()) {
+        return FAIL;
+    }
+    profiler_frame_mark();
+    Thread thread;
+    if (!platform_thread_create(profiled_thread, 0, &thread)) {
+        profiler_destroy();
+        return FAIL;
+    }
+    platform_thread_join(&thread);
+    inner_work();
+    bool exported = profiler_export(PROFILER_TEST_PATH, 10);
+    profiler_destroy();
+    ProfilerExport export = read_export();
+    u32 headers = count_in_export(&export, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    u32 outer = count_in_export(&export, "\"name\":\"profiler test outer\"");
+    u32 inner = count_in_export(&export, "\"name\":\"profiler test inner\"");
+    u32 frames = count_in_export(&export, "\"name\":\"Frame\"");
+    u32 thread_names = count_in_export(&export, "\"name\":\"profiler test thread\"");
+    u32 main_names = count_in_export(&export, "\"name\":\"main\"");
+    u32 footers = count_in_export(&export, "\n]}\n");
+    mem_free(export.data);
+
+    EXPECT_EQ(exported, true);
+    EXPECT_EQ(headers, 1);
+    EXPECT_EQ(outer, PROFILER_TEST_ITERATIONS);
+    EXPECT_EQ(inner, PROFILER_TEST_ITERATIONS + 1);
+    // The first frame, ended by the mark above.
+    EXPECT_EQ(frames, 1);
+    EXPECT_EQ(thread_names, 1);
+    EXPECT_EQ(main_names, 1);
+    EXPECT_EQ(footers, 1);
+    return OK;
+}
+
+Test profiler_window_test(void) {
+#if !PROFILE_ENABLED
+    return IGNORE;
+#endif
+    if (!profiler_create()) {
+        return FAIL;
+    }
+    {
+        PROFILE_SCOPE("profiler test old frame");
+    }
+    profiler_frame_mark();
+    profiler_frame_mark();
+    {
+        PROFILE_SCOPE("profiler test new frame");
+    }
+    // Only the frame in progress.
+    bool exported_last = profiler_export(PROFILER_TEST_PATH, 1);
+    ProfilerExport last = read_export();
+    u32 last_new = count_in_export(&last, "\"name\":\"profiler test new frame\"");
+    u32 last_old = count_in_export(&last, "\"name\":\"profiler test old frame\"");
+    mem_free(last.data);
+    bool exported_all = profiler_export(PROFILER_TEST_PATH, 3);
+    profiler_destroy();
+    ProfilerExport all = read_export();
+    u32 all_old = count_in_export(&all, "\"name\":\"profiler test old frame\"");
+    u32 all_frames = count_in_export(&all, "\"name\":\"Frame\"");
+    mem_free(all.data);
+
+    EXPECT_EQ(exported_last, true);
+    EXPECT_EQ(last_new, 1);
+    EXPECT_EQ(last_old, 0);
+    EXPECT_EQ(exported_all, true);
+    EXPECT_EQ(all_old, 1);
+    EXPECT_EQ(all_frames, 2);
+    return OK;
+}
+
+void register_profiler_tests(void) {
+    test_runner_register(profiler_export_test, "Profiler exports scopes from every thread");
+    test_runner_register(profiler_window_test, "Profiler exports only the requested frames");
+}
@@ -0,0 +1,6 @@
+#ifndef PROFILER_TESTS_H
+#define PROFILER_TESTS_H
+
+void register_profiler_tests(void);
+
+#endif
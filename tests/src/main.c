@@ -1,11 +1,47 @@
+#include "collections/hashmap_bench.h"
+#include "collections/hashmap_tests.h"
+#include "collections/ring_buffer_bench.h"
+#include "collections/ring_buffer_tests.h"
+#include "collections/slot_map_tests.h"
+#include "collections/vector_bench.h"
 #include "collections/vector_tests.h"
+#include "core/arena_tests.h"
+#include "core/fiber_tests.h"
+#include "core/frame_limiter_tests.h"
+#include "core/job_tests.h"
+#include "core/log_tests.h"
+#include "core/mem_tests.h"
+#include "core/pool_tests.h"
+#include "core/profiler_tests.h"
 #include "math/lineal_tests.h"
+#include "platform/sync_tests.h"
+#include "renderer/draw_queue_tests.h"
+#include "renderer/resolution_scaler_tests.h"
+#include "renderer/texture_tests.h"
 #include "test_runner.h"
 
 int main(void) {
 
     test_runner_init();
     register_vec_tests();
+    register_hashmap_tests();
+    register_slot_map_tests();
+    register_ring_buffer_tests();
     register_lineal_math_tests();
+    register_frame_limiter_tests();
+    register_texture_tests();
+    register_resolution_scaler_tests();
+    register_draw_queue_tests();
+    register_mem_tests();
+    register_arena_tests();
+    register_pool_tests();
+    register_fiber_tests();
+    register_job_tests();
+    register_sync_tests();
+    register_log_tests();
+    register_profiler_tests();
+    register_vector_benchmarks();
+    register_hashmap_benchmarks();
+    register_ring_buffer_benchmarks();
     test_runner_run_all_tests();
 }
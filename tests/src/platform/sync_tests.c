@@ -0,0 +1,163 @@
+#include <platform/platform.h>
+#include <platform/sync.h>
+#include <platform/sync_tests.h>
+#include <test.h>
+#include <test_runner.h>
+
+#define SYNC_TEST_THREADS 4
+#define SYNC_TEST_INCREMENTS 20000
+#define SYNC_TEST_ITEMS 1000
+
+typedef struct Shared {
+    Mutex mutex;
+    CondVar cond;
+    Semaphore semaphore;
+    Event event;
+    // Protected by the mutex.
+    u64 counter;
+    u32 queued;
+    u32 consumed;
+    _Atomic(u32) released;
+} Shared;
+
+static void increment_locked(void* arg) {
+    Shared* shared = arg;
+    for (u32 i = 0; i < SYNC_TEST_INCREMENTS; i++) {
+        mutex_lock(&shared->mutex);
+        shared->counter++;
+        mutex_unlock(&shared->mutex);
+    }
+}
+
+static void consume(void* arg) {
+    Shared* shared = arg;
+    mutex_lock(&shared->mutex);
+    while (shared->consumed < SYNC_TEST_ITEMS) {
+        while (shared->queued == 0) {
+            cond_var_wait(&shared->cond, &shared->mutex);
+        }
+        shared->queued--;
+        shared->consumed++;
+    }
+    mutex_unlock(&shared->mutex);
+}
+
+static void take_semaphore(void* arg) {
+    Shared* shared = arg;
+    semaphore_wait(&shared->semaphore);
+    atomic_fetch_add(&shared->released, 1);
+}
+
+static void wait_event(void* arg) {
+    Shared* shared = arg;
+    event_wait(&shared->event);
+    atomic_fetch_add(&shared->released, 1);
+}
+
+static bool run_threads(ThreadFn fn, Shared* shared, Thread* threads) {
+    for (u32 i = 0; i < SYNC_TEST_THREADS; i++) {
+        if (!platform_thread_create(fn, shared, &threads[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void join_threads(Thread* threads) {
+    for (u32 i = 0; i < SYNC_TEST_THREADS; i++) {
+        platform_thread_join(&threads[i]);
+    }
+}
+
+Test mutex_exclusion_test(void) {
+    Shared shared = {0};
+    Thread threads[SYNC_TEST_THREADS];
+    if (!run_threads(increment_locked, &shared, threads)) {
+        return FAIL;
+    }
+    join_threads(threads);
+    EXPECT_EQ(shared.counter, (u64)SYNC_TEST_THREADS * SYNC_TEST_INCREMENTS);
+    EXPECT_EQ(mutex_try_lock(&shared.mutex), true);
+    EXPECT_EQ(mutex_try_lock(&shared.mutex), false);
+    mutex_unlock(&shared.mutex);
+    return OK;
+}
+
+Test cond_var_queue_test(void) {
+    Shared shared = {0};
+    Thread consumer;
+    if (!platform_thread_create(consume, &shared, &consumer)) {
+        return FAIL;
+    }
+    for (u32 i = 0; i < SYNC_TEST_ITEMS; i++) {
+        mutex_lock(&shared.mutex);
+        shared.queued++;
+        mutex_unlock(&shared.mutex);
+        cond_var_signal(&shared.cond);
+    }
+    platform_thread_join(&consumer);
+    EXPECT_EQ(shared.consumed, SYNC_TEST_ITEMS);
+    // Nobody signals, so the wait runs into its timeout.
+    mutex_lock(&shared.mutex);
+    EXPECT_EQ(cond_var_wait_timeout(&shared.cond, &shared.mutex, 0.01), false);
+    mutex_unlock(&shared.mutex);
+    return OK;
+}
+
+Test semaphore_release_test(void) {
+    Shared shared = {0};
+    semaphore_init(&shared.semaphore, 1);
+    Thread threads[SYNC_TEST_THREADS];
+    if (!run_threads(take_semaphore, &shared, threads)) {
+        return FAIL;
+    }
+    // One thread passes on the initial count, the rest need a post each.
+    while (atomic_load(&shared.released) < 1) {
+        platform_thread_yield();
+    }
+    semaphore_post(&shared.semaphore, SYNC_TEST_THREADS - 1);
+    join_threads(threads);
+    EXPECT_EQ(atomic_load(&shared.released), SYNC_TEST_THREADS);
+    EXPECT_EQ(semaphore_try_wait(&shared.semaphore), false);
+    return OK;
+}
+
+Test event_release_test(void) {
+    Shared shared = {0};
+    EXPECT_EQ(event_wait_timeout(&shared.event, 0.01), false);
+    Thread threads[SYNC_TEST_THREADS];
+    if (!run_threads(wait_event, &shared, threads)) {
+        return FAIL;
+    }
+    event_set(&shared.event);
+    join_threads(threads);
+    EXPECT_EQ(atomic_load(&shared.released), SYNC_TEST_THREADS);
+    EXPECT_EQ(event_is_set(&shared.event), true);
+    event_reset(&shared.event);
+    EXPECT_EQ(event_is_set(&shared.event), false);
+    return OK;
+}
+
+Test cpu_topology_test(void) {
+    CpuTopology topology;
+    platform_cpu_topology(&topology);
+    EXPECT_EQ(topology.logical_count, platform_processor_count());
+    EXPECT_EQ((topology.core_count >= 1 && topology.core_count <= topology.logical_count), true);
+    // Hybrid processors have cores with and without SMT, so this is only a bound.
+    EXPECT_EQ((topology.smt_width >= 1 && topology.smt_width <= topology.logical_count), true);
+    bool cores_valid = true;
+    for (u32 i = 0; i < topology.logical_count; i++) {
+        cores_valid = cores_valid && topology.core_of[i] < topology.core_count;
+    }
+    EXPECT_EQ(cores_valid, true);
+    EXPECT_NEQ(platform_thread_id(), 0);
+    return OK;
+}
+
+void register_sync_tests(void) {
+    test_runner_register(mutex_exclusion_test, "Mutex keeps increments exclusive");
+    test_runner_register(cond_var_queue_test, "Condition variable hands over queued items");
+    test_runner_register(semaphore_release_test, "Semaphore releases one waiter per post");
+    test_runner_register(event_release_test, "Event releases every waiter until reset");
+    test_runner_register(cpu_topology_test, "CPU topology is consistent");
+}
@@ -0,0 +1,6 @@
+#ifndef SYNC_TESTS_H
+#define SYNC_TESTS_H
+
+void register_sync_tests(void);
+
+#endif
@@ -0,0 +1,109 @@
+#include <renderer/draw_queue.h>
+#include <renderer/draw_queue_tests.h>
+#include <test.h>
+#include <test_runner.h>
+
+static void push_key(DrawQueue* queue, u64 key, u32 id) {
+    DrawPacket packet = {0};
+    packet.constants.pad_0 = id;
+    draw_queue_push(queue, key, &packet);
+}
+
+static u32 packet_id(DrawQueue* queue, u64 index) {
+    return queue->packets[queue->items[index].packet].constants.pad_0;
+}
+
+Test draw_queue_key_order_test(void) {
+    // Each field outranks every field after it.
+    u64 opaque = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE + 1, 0xFFFF, 1.0f);
+    u64 transparent = draw_queue_key(DRAW_PASS_TRANSPARENT, RENDER_PIPELINE_OPAQUE, 0, 0.0f);
+    EXPECT_EQ((opaque < transparent), true);
+
+    u64 low_pipeline = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, 0xFFFF, 1.0f);
+    u64 high_pipeline = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE + 1, 0, 0.0f);
+    EXPECT_EQ((low_pipeline < high_pipeline), true);
+    EXPECT_EQ(draw_queue_key_pipeline(high_pipeline), RENDER_PIPELINE_OPAQUE + 1);
+
+    u64 near = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, 3, 0.1f);
+    u64 far = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, 3, 0.9f);
+    EXPECT_EQ((near < far), true);
+    // Out of range depths are clamped instead of spilling into the material bits.
+    u64 beyond = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, 3, 5.0f);
+    EXPECT_EQ(beyond >> DRAW_KEY_MATERIAL_SHIFT, far >> DRAW_KEY_MATERIAL_SHIFT);
+    return OK;
+}
+
+Test draw_queue_transparent_back_to_front_test(void) {
+    u64 near = draw_queue_key(DRAW_PASS_TRANSPARENT, RENDER_PIPELINE_OPAQUE, 0, 0.1f);
+    u64 far = draw_queue_key(DRAW_PASS_TRANSPARENT, RENDER_PIPELINE_OPAQUE, 0, 0.9f);
+    EXPECT_EQ((far < near), true);
+    return OK;
+}
+
+Test draw_queue_sort_test(void) {
+    DrawQueue queue;
+    draw_queue_create(&queue);
+    // Enough items to exercise every byte of the key.
+    u64 state = 0x9E3779B97F4A7C15ull;
+    for (u32 i = 0; i < 1000; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        push_key(&queue, state, i);
+    }
+    draw_queue_sort(&queue);
+    EXPECT_EQ(vector_length(queue.items), 1000);
+    for (u64 i = 1; i < vector_length(queue.items); i++) {
+        if (queue.items[i - 1].key > queue.items[i].key) {
+            ERROR("Items %llu and %llu are out of order", i - 1, i);
+            draw_queue_destroy(&queue);
+            return FAIL;
+        }
+    }
+    draw_queue_destroy(&queue);
+    return OK;
+}
+
+Test draw_queue_stable_test(void) {
+    DrawQueue queue;
+    draw_queue_create(&queue);
+    u64 a = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, 2, 0.5f);
+    u64 b = draw_queue_key(DRAW_PASS_OPAQUE, RENDER_PIPELINE_OPAQUE, 1, 0.5f);
+    push_key(&queue, a, 0);
+    push_key(&queue, b, 1);
+    push_key(&queue, a, 2);
+    push_key(&queue, b, 3);
+    draw_queue_sort(&queue);
+    EXPECT_EQ(packet_id(&queue, 0), 1);
+    EXPECT_EQ(packet_id(&queue, 1), 3);
+    EXPECT_EQ(packet_id(&queue, 2), 0);
+    EXPECT_EQ(packet_id(&queue, 3), 2);
+    draw_queue_destroy(&queue);
+    return OK;
+}
+
+Test draw_queue_clear_test(void) {
+    DrawQueue queue;
+    draw_queue_create(&queue);
+    push_key(&queue, 2, 0);
+    push_key(&queue, 1, 1);
+    draw_queue_sort(&queue);
+    draw_queue_clear(&queue);
+    EXPECT_EQ(vector_length(queue.items), 0);
+    EXPECT_EQ(vector_length(queue.packets), 0);
+    // Packet indices restart with the next frame.
+    push_key(&queue, 7, 5);
+    EXPECT_EQ(queue.items[0].packet, 0);
+    EXPECT_EQ(packet_id(&queue, 0), 5);
+    draw_queue_destroy(&queue);
+    return OK;
+}
+
+void register_draw_queue_tests(void) {
+    test_runner_register(draw_queue_key_order_test, "Draw keys order pass, pipeline, material");
+    test_runner_register(draw_queue_transparent_back_to_front_test,
+                         "Transparent draw keys sort back to front");
+    test_runner_register(draw_queue_sort_test, "Draw queue radix sort orders random keys");
+    test_runner_register(draw_queue_stable_test, "Draw queue sort keeps submission order");
+    test_runner_register(draw_queue_clear_test, "Draw queue clear starts a new frame");
+}
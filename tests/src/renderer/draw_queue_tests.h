@@ -0,0 +1,8 @@
+#ifndef DRAW_QUEUE_TESTS_H
+#define DRAW_QUEUE_TESTS_H
+
+#include <renderer/draw_queue.h>
+
+void register_draw_queue_tests(void);
+
+#endif
@@ -0,0 +1,89 @@
+#include <math.h>
+#include <renderer/resolution_scaler.h>
+#include <renderer/resolution_scaler_tests.h>
+#include <test.h>
+#include <test_runner.h>
+
+// GPU cost proportional to the number of shaded pixels.
+static f32 simulated_gpu_ms(f32 full_resolution_ms, f32 scale) {
+    return full_resolution_ms * scale * scale;
+}
+
+static void run_frames(ResolutionScaler* scaler, f32 full_resolution_ms, u32 frames) {
+    for (u32 i = 0; i < frames; i++) {
+        resolution_scaler_update(scaler, simulated_gpu_ms(full_resolution_ms, scaler->scale));
+    }
+}
+
+Test resolution_scaler_under_budget_test(void) {
+    ResolutionScaler scaler;
+    resolution_scaler_create(10.0f, &scaler);
+    for (u32 i = 0; i < 100; i++) {
+        if (resolution_scaler_update(&scaler, 5.0f)) {
+            ERROR("Scale changed to %.3f while under budget", scaler.scale);
+            return FAIL;
+        }
+    }
+    EXPECT_FLOAT_EQ(scaler.scale, RESOLUTION_SCALE_MAX);
+    return OK;
+}
+
+Test resolution_scaler_interval_test(void) {
+    ResolutionScaler scaler;
+    resolution_scaler_create(10.0f, &scaler);
+    for (u32 i = 0; i < RESOLUTION_SCALER_INTERVAL - 1; i++) {
+        EXPECT_EQ(resolution_scaler_update(&scaler, 30.0f), false);
+    }
+    EXPECT_EQ(resolution_scaler_update(&scaler, 30.0f), true);
+    if (scaler.scale >= RESOLUTION_SCALE_MAX) {
+        ERROR("Scale should drop when over budget");
+        return FAIL;
+    }
+    return OK;
+}
+
+Test resolution_scaler_converges_test(void) {
+    ResolutionScaler scaler;
+    resolution_scaler_create(10.0f, &scaler);
+    // Twice the budget at full resolution, so the scene fits at half the pixels.
+    run_frames(&scaler, 20.0f, 400);
+    f32 gpu_ms = simulated_gpu_ms(20.0f, scaler.scale);
+    if (gpu_ms < 9.0f || gpu_ms > 11.0f) {
+        ERROR("Settled at scale %.3f (%.2fms), expected about 10ms", scaler.scale, gpu_ms);
+        return FAIL;
+    }
+    return OK;
+}
+
+Test resolution_scaler_recovers_test(void) {
+    ResolutionScaler scaler;
+    resolution_scaler_create(10.0f, &scaler);
+    // A load the minimum scale can't absorb pins the output without winding up the integral,
+    run_frames(&scaler, 100.0f, 400);
+    EXPECT_FLOAT_EQ(scaler.scale, RESOLUTION_SCALE_MIN);
+    // so full resolution comes back soon after the load is gone.
+    run_frames(&scaler, 5.0f, RESOLUTION_SCALER_INTERVAL * 20);
+    EXPECT_FLOAT_EQ(scaler.scale, RESOLUTION_SCALE_MAX);
+    return OK;
+}
+
+Test resolution_scaler_disabled_test(void) {
+    ResolutionScaler scaler;
+    resolution_scaler_create(0.0f, &scaler);
+    run_frames(&scaler, 100.0f, 100);
+    EXPECT_FLOAT_EQ(scaler.scale, RESOLUTION_SCALE_MAX);
+    return OK;
+}
+
+void register_resolution_scaler_tests(void) {
+    test_runner_register(resolution_scaler_under_budget_test,
+                         "Resolution scaler keeps full resolution under budget");
+    test_runner_register(resolution_scaler_interval_test,
+                         "Resolution scaler adjusts once per interval");
+    test_runner_register(resolution_scaler_converges_test,
+                         "Resolution scaler settles at the frame time target");
+    test_runner_register(resolution_scaler_recovers_test,
+                         "Resolution scaler recovers after a long overload");
+    test_runner_register(resolution_scaler_disabled_test,
+                         "Resolution scaler without a target keeps full resolution");
+}
@@ -0,0 +1,8 @@
+#ifndef RESOLUTION_SCALER_TESTS_H
+#define RESOLUTION_SCALER_TESTS_H
+
+#include <renderer/resolution_scaler.h>
+
+void register_resolution_scaler_tests(void);
+
+#endif
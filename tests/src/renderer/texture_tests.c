@@ -0,0 +1,106 @@
+#include <core/mem.h>
+#include <platform/fs.h>
+#include <renderer/texture.h>
+#include <renderer/texture_tests.h>
+#include <stdio.h>
+#include <test.h>
+#include <test_runner.h>
+
+Test texture_mip_count_test(void) {
+    EXPECT_EQ(texture_mip_count(1), 1);
+    EXPECT_EQ(texture_mip_count(2), 2);
+    EXPECT_EQ(texture_mip_count(16), 5);
+    EXPECT_EQ(texture_mip_count(4096), 13);
+    return OK;
+}
+
+Test texture_downsample_box_test(void) {
+    // 10x2 image: two passes of the vector path, two pixels each, then a scalar tail pixel.
+    const u32 width = 10;
+    u8 src[10 * 2 * 4];
+    for (u32 i = 0; i < width * 2 * 4; i++) {
+        src[i] = (u8)(i * 3);
+    }
+    u8 dst[5 * 4];
+    texture_downsample(src, width, 2, dst);
+    for (u32 x = 0; x < 5; x++) {
+        for (u32 c = 0; c < 4; c++) {
+            u32 a = src[(x * 2) * 4 + c];
+            u32 b = src[(x * 2 + 1) * 4 + c];
+            u32 d = src[(width + x * 2) * 4 + c];
+            u32 e = src[(width + x * 2 + 1) * 4 + c];
+            EXPECT_EQ(dst[x * 4 + c], (a + b + d + e + 2) / 4);
+        }
+    }
+    return OK;
+}
+
+Test texture_downsample_single_row_test(void) {
+    u8 src[] = {0, 10, 20, 255, 100, 110, 120, 255};
+    u8 dst[4];
+    texture_downsample(src, 2, 1, dst);
+    EXPECT_EQ(dst[0], 50);
+    EXPECT_EQ(dst[1], 60);
+    EXPECT_EQ(dst[2], 70);
+    EXPECT_EQ(dst[3], 255);
+    return OK;
+}
+
+Test texture_load_ppm_test(void) {
+    const char* path = "texture_test.ppm";
+    const char ppm[] = "P6\n# comment\n2 1\n255\n\x01\x02\x03\x04\x05\x06";
+    File file;
+    EXPECT_EQ(fs_open(path, OPEN_FILE_MODE_WRITE_BINARY, &file), true);
+    u64 written = 0;
+    fs_write(&file, sizeof(ppm) - 1, ppm, &written);
+    fs_close(&file);
+
+    TextureImage image = {0};
+    bool loaded = texture_load_ppm(path, &image);
+    remove(path);
+    EXPECT_EQ(loaded, true);
+    EXPECT_EQ(image.width, 2);
+    EXPECT_EQ(image.height, 1);
+    EXPECT_EQ(image.pixels[0], 1);
+    EXPECT_EQ(image.pixels[3], 255);
+    EXPECT_EQ(image.pixels[4], 4);
+    EXPECT_EQ(image.pixels[6], 6);
+    texture_image_free(&image);
+    return OK;
+}
+
+Test texture_array_build_test(void) {
+    const char* names[] = {"missing_a", "missing_b", "missing_c"};
+    TextureArrayData data = {0};
+    EXPECT_EQ(texture_array_build(names, 3, 16, &data), true);
+    EXPECT_EQ(data.layer_count, 3);
+    EXPECT_EQ(data.mip_levels, 5);
+    EXPECT_EQ(data.level_sizes[0], 16 * 16 * 4 * 3);
+    EXPECT_EQ(data.level_offsets[1], data.level_sizes[0]);
+    EXPECT_EQ(data.level_sizes[4], 4 * 3);
+    // Missing files fall back to a checkerboard, whose 1x1 mip is the average of both colors.
+    u8* last = data.pixels + data.level_offsets[4];
+    EXPECT_EQ(last[0], 128);
+    EXPECT_EQ(last[1], 0);
+    EXPECT_EQ(last[3], 255);
+    texture_array_free(&data);
+    EXPECT_EQ(data.pixels, 0);
+    return OK;
+}
+
+Test texture_array_rejects_bad_size_test(void) {
+    const char* names[] = {"missing"};
+    TextureArrayData data = {0};
+    EXPECT_EQ(texture_array_build(names, 1, 12, &data), false);
+    return OK;
+}
+
+void register_texture_tests(void) {
+    test_runner_register(texture_mip_count_test, "Mip count covers the full chain");
+    test_runner_register(texture_downsample_box_test, "Downsample averages 2x2 blocks");
+    test_runner_register(texture_downsample_single_row_test, "Downsample handles a single row");
+    test_runner_register(texture_load_ppm_test, "Binary PPM is loaded as RGBA");
+    test_runner_register(texture_array_build_test, "Texture array packs layers level-major");
+    test_runner_register(texture_array_rejects_bad_size_test,
+                         "Texture array rejects non power of two sizes");
+}
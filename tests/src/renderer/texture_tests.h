@@ -0,0 +1,8 @@
+#ifndef TEXTURE_TESTS_H
+#define TEXTURE_TESTS_H
+
+#include <renderer/texture.h>
+
+void register_texture_tests(void);
+
+#endif
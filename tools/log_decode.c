@@ -0,0 +1,156 @@
+#include "core/log_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Prints a latest.binlog written by the logger in binary mode, one line per message in the
+ * format of latest.log, prefixed with the time the message was logged.
+ *
+ * usage: log_decode [path]
+ */
+
+#define MESSAGE_SIZE 4096
+
+typedef struct Site {
+    char* file;
+    char* format;
+    u32 line;
+    u8 level;
+} Site;
+
+typedef struct Reader {
+    const u8* data;
+    u64 size;
+    u64 offset;
+} Reader;
+
+static const char* LOG_LEVELS[5] = {"ERROR", "WARN", "INFO", "DEBUG", "TRACE"};
+
+static bool read_bytes(Reader* reader, void* value, u64 bytes) {
+    if (reader->offset + bytes > reader->size) {
+        return false;
+    }
+    memcpy(value, reader->data + reader->offset, bytes);
+    reader->offset += bytes;
+    return true;
+}
+
+static char* read_string(Reader* reader) {
+    u16 length;
+    if (!read_bytes(reader, &length, sizeof(length)) || reader->offset + length > reader->size) {
+        return 0;
+    }
+    char* string = malloc((u64)length + 1);
+    if (string) {
+        memcpy(string, reader->data + reader->offset, length);
+        string[length] = 0;
+    }
+    reader->offset += length;
+    return string;
+}
+
+static u8* read_file(const char* path, u64* size) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    u8* data = length > 0 ? malloc((u64)length) : 0;
+    if (data && fread(data, 1, (u64)length, file) != (u64)length) {
+        free(data);
+        data = 0;
+    }
+    fclose(file);
+    *size = data ? (u64)length : 0;
+    return data;
+}
+
+static bool read_site(Reader* reader, Site** sites, u32* site_count) {
+    u32 id;
+    Site site;
+    if (!read_bytes(reader, &id, sizeof(id)) || !read_bytes(reader, &site.level, 1) ||
+        !read_bytes(reader, &site.line, sizeof(site.line)) || id == 0 || site.level > 4) {
+        return false;
+    }
+    site.file = read_string(reader);
+    site.format = read_string(reader);
+    if (!site.file || !site.format) {
+        free(site.file);
+        free(site.format);
+        return false;
+    }
+    if (id > *site_count) {
+        Site* grown = realloc(*sites, id * sizeof(Site));
+        if (!grown) {
+            return false;
+        }
+        memset(grown + *site_count, 0, (id - *site_count) * sizeof(Site));
+        *sites = grown;
+        *site_count = id;
+    }
+    (*sites)[id - 1] = site;
+    return true;
+}
+
+static bool read_event(Reader* reader, const Site* sites, u32 site_count) {
+    u32 id;
+    f64 time;
+    u16 size;
+    if (!read_bytes(reader, &id, sizeof(id)) || !read_bytes(reader, &time, sizeof(time)) ||
+        !read_bytes(reader, &size, sizeof(size)) || reader->offset + size > reader->size ||
+        id == 0 || id > site_count || !sites[id - 1].format) {
+        return false;
+    }
+    const Site* site = &sites[id - 1];
+    char message[MESSAGE_SIZE];
+    if (!log_format_captured(message, sizeof(message), site->format,
+                             reader->data + reader->offset, size) &&
+        site->format[0]) {
+        snprintf(message, sizeof(message), "<arguments don't match \"%s\">", site->format);
+    }
+    reader->offset += size;
+    printf("[%.6f] [%s %s:%u]: %s\n", time, LOG_LEVELS[site->level], site->file, site->line,
+           message);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "latest.binlog";
+    u64 size;
+    u8* data = read_file(path, &size);
+    if (!data || size < LOG_BINARY_MAGIC_SIZE ||
+        memcmp(data, LOG_BINARY_MAGIC, LOG_BINARY_MAGIC_SIZE) != 0) {
+        fprintf(stderr, "%s is not a binary log\n", path);
+        free(data);
+        return 1;
+    }
+    Reader reader = {data, size, LOG_BINARY_MAGIC_SIZE};
+    Site* sites = 0;
+    u32 site_count = 0;
+    bool ok = true;
+    u8 kind;
+    while (ok && read_bytes(&reader, &kind, sizeof(kind))) {
+        if (kind == LOG_BINARY_SITE) {
+            ok = read_site(&reader, &sites, &site_count);
+        } else if (kind == LOG_BINARY_EVENT) {
+            ok = read_event(&reader, sites, site_count);
+        } else {
+            ok = false;
+        }
+    }
+    if (!ok) {
+        // Expected when the process died in the middle of a write.
+        fprintf(stderr, "%s is corrupt or truncated at byte %llu\n", path,
+                (unsigned long long)reader.offset);
+    }
+    for (u32 i = 0; i < site_count; i++) {
+        free(sites[i].file);
+        free(sites[i].format);
+    }
+    free(sites);
+    free(data);
+    return ok ? 0 : 1;
+}